@@ -0,0 +1,95 @@
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <fstream>
+#include <iostream>
+#include <memory> // make_shared
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#include <fgl/bench.hpp>
+#include <fgl/debug/output.hpp>
+
+// Measures the cost to the sending thread of each way of sending output.
+// Output is written to a stream which discards it. Results are written as
+// JSON to the file given as the first argument, or standard output, and as
+// CSV to standard output.
+
+/// A stream buffer which discards everything written to it
+class null_buffer final : public std::streambuf
+{
+	protected:
+	int_type overflow(const int_type c) override
+	{ return traits_type::not_eof(c); }
+
+	std::streamsize xsputn(const char*, const std::streamsize n) override
+	{ return n; }
+};
+
+struct bench_channel final
+: public fgl::debug::simple_output_channel
+	<
+		true,
+		fgl::debug::priority::info,
+		"bench",
+		bench_channel
+	>
+{
+	static std::string format(const int& i)
+	{ return "iteration " + std::to_string(i); }
+};
+
+void bench_senders(fgl::bench::harness& harness, const std::string& mode)
+{
+	using fgl::debug::output;
+	int i{};
+	harness.run("output::custom (" + mode + ")", [&i]()
+	{ output::custom<int, bench_channel, bench_channel>(++i); });
+	harness.run("output::deferred (" + mode + ")", [&i]()
+	{ output::deferred<bench_channel, "iteration {}">(++i); });
+	output::stream.flush();
+}
+
+int main(const int argc, const char* const argv[])
+{
+	using fgl::debug::output;
+	null_buffer discard;
+	std::ostream null_stream(&discard);
+	output::stream = null_stream;
+
+	fgl::bench::harness harness;
+	bench_senders(harness, "synchronous");
+	// each line is formatted once and written to every sink which accepts it
+	using fgl::debug::priority;
+	output::sinks.add(std::make_shared<fgl::debug::stream_sink>(
+		null_stream,
+		priority::warning
+	));
+	output::sinks.add(std::make_shared<fgl::debug::stream_sink>(
+		null_stream,
+		priority::minimum,
+		fgl::debug::sink_policy{ 1 << 16, priority::error }
+	));
+	output::sinks.add(std::make_shared<fgl::debug::memory_ring_sink>(1024));
+	bench_senders(harness, "three sinks");
+	output::sinks.clear();
+	// blocking includes the writer thread's work whenever the queue is full,
+	// while dropping measures only the cost to the sending thread
+	output.async.enable(1 << 16, fgl::debug::backpressure::block);
+	bench_senders(harness, "asynchronous block");
+	output.async.enable(1 << 16, fgl::debug::backpressure::drop);
+	bench_senders(harness, "asynchronous drop");
+	output.async.disable();
+	output::stream = std::cout;
+
+	if (argc > 1)
+	{
+		std::ofstream file(argv[1]);
+		fgl::bench::write_json(file, harness.results());
+		if (!file)
+			return EXIT_FAILURE;
+	}
+	else
+		fgl::bench::write_json(std::cout, harness.results());
+	fgl::bench::write_csv(std::cout, harness.results());
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+/// long term TODO: periodically check if this is still needed
+// gcc's problem: std::nth_element trips -Wstrict-overflow=5 when optimizing
+#pragma GCC diagnostic ignored "-Wstrict-overflow"
+
+#include <cstddef> // size_t
+#include <cstdint> // int64_t
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <algorithm> // max
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator> // back_inserter
+#include <string>
+#include <thread> // hardware_concurrency
+#include <vector>
+
+#include <fgl/bench.hpp>
+#include <fgl/debug/stopwatch.hpp>
+#include <fgl/debug/stopwatch/parallel_statistics.hpp>
+#include <fgl/utility/tsc_clock.hpp>
+
+// Measures the cost of reading clocks, of recording a lap into each of the
+// stopwatch's lap records, and of calculating statistics. Results are written
+// as JSON to the file given as the first argument, or standard output, and as
+// CSV to standard output.
+
+template <typename T_stopwatch>
+void bench_lap(fgl::bench::harness& harness, const char* const name)
+{
+	T_stopwatch sw(name, 1'000'000);
+	sw.start();
+	harness.run(name, [&sw]()
+	{
+		if (sw.number_of_laps() >= 1'000'000)
+		{
+			sw.reset(); // keeps retaining records from growing unboundedly
+			sw.start();
+		}
+		sw.lap();
+		fgl::bench::clobber();
+	});
+}
+
+int main(const int argc, const char* const argv[])
+{
+	fgl::bench::harness harness;
+
+	harness.run("steady_clock::now", []()
+	{
+		const auto t{ std::chrono::steady_clock::now() };
+		fgl::bench::do_not_optimize(t);
+	});
+	harness.run("tsc_clock::now", []()
+	{
+		const auto t{ fgl::tsc_clock::now() };
+		fgl::bench::do_not_optimize(t);
+	});
+
+	bench_lap<fgl::debug::stopwatch>(harness, "stopwatch::lap");
+	bench_lap<fgl::debug::streaming_stopwatch>(
+		harness,
+		"streaming_stopwatch::lap"
+	);
+	bench_lap<fgl::debug::histogram_stopwatch>(
+		harness,
+		"histogram_stopwatch::lap"
+	);
+	bench_lap<fgl::debug::ring_stopwatch>(harness, "ring_stopwatch::lap");
+	bench_lap<fgl::debug::compressed_stopwatch>(
+		harness,
+		"compressed_stopwatch::lap"
+	);
+	bench_lap<fgl::debug::sampled_stopwatch>(
+		harness,
+		"sampled_stopwatch::lap"
+	);
+	bench_lap<fgl::debug::reservoir_stopwatch>(
+		harness,
+		"reservoir_stopwatch::lap"
+	);
+
+	{
+		// the cost of reporting: statistics of 100k laps, reusing a buffer
+		fgl::debug::stopwatch sw("statistics", 100'000);
+		fgl::debug::stopwatch::time_point_t now{};
+		sw.start(now);
+		for (int i{ 1 }; i <= 100'000; ++i)
+		{
+			now += std::chrono::nanoseconds{ 1 + (i * 7919) % 1'009 };
+			sw.lap(now);
+		}
+		sw.stop_without_record();
+		std::vector<fgl::debug::stopwatch::duration_t> scratch;
+		constexpr std::array percentiles{ 50.0, 99.0, 99.9 };
+		harness.run(
+			"stopwatch::calculate_statistics (100k laps)",
+			[&]()
+			{
+				const auto s{ sw.calculate_statistics(percentiles, scratch) };
+				fgl::bench::do_not_optimize(s.median);
+			}
+		);
+
+		// the cost of formatting every lap: streams versus to_chars
+		harness.run(
+			"to_string_full (100k laps)",
+			[&sw]()
+			{
+				const std::string s{ fgl::debug::to_string_full(sw) };
+				fgl::bench::do_not_optimize(s.data());
+			}
+		);
+		std::string out;
+		harness.run(
+			"format_full (100k laps)",
+			[&sw, &out]()
+			{
+				out.clear();
+				fgl::debug::format_full(std::back_inserter(out), sw);
+				fgl::bench::do_not_optimize(out.data());
+			}
+		);
+	}
+
+	{
+		// scaling of statistics with threads: 4M laps with a long tail
+		constexpr std::size_t n{ 4'000'000 };
+		fgl::debug::stopwatch sw("scaling", n);
+		fgl::debug::stopwatch::time_point_t now{};
+		sw.start(now);
+		for (std::size_t i{ 1 }; i <= n; ++i)
+		{
+			const std::size_t r{ (i * 2654435761) % 100'003 };
+			now += std::chrono::nanoseconds{
+				static_cast<std::int64_t>(r == 0 ? 1'000'000 : 20 + r % 997)
+			};
+			sw.lap(now);
+		}
+		sw.stop_without_record();
+		std::vector<fgl::debug::stopwatch::duration_t> scratch;
+		constexpr std::array percentiles{ 50.0, 99.0, 99.9 };
+		harness.run(
+			"stopwatch::calculate_statistics (4M laps)",
+			[&]()
+			{
+				const auto s{ sw.calculate_statistics(percentiles, scratch) };
+				fgl::bench::do_not_optimize(s.median);
+			}
+		);
+		// powers of two up to every core, and every core
+		const std::size_t cores{
+			std::max(std::thread::hardware_concurrency(), 1U)
+		};
+		std::vector<std::size_t> thread_counts;
+		for (std::size_t threads{ 1 }; threads < cores; threads *= 2)
+			thread_counts.push_back(threads);
+		thread_counts.push_back(cores);
+		for (const std::size_t threads : thread_counts)
+		{
+			harness.run(
+				"calculate_parallel_statistics (4M laps, "
+					+ std::to_string(threads) + " threads)",
+				[&]()
+				{
+					const auto s{ fgl::debug::calculate_parallel_statistics(
+						sw, percentiles, threads
+					) };
+					fgl::bench::do_not_optimize(s.median);
+				}
+			);
+		}
+	}
+
+	if (argc > 1)
+	{
+		std::ofstream file(argv[1]);
+		fgl::bench::write_json(file, harness.results());
+		if (!file)
+			return EXIT_FAILURE;
+	}
+	else
+		fgl::bench::write_json(std::cout, harness.results());
+	fgl::bench::write_csv(std::cout, harness.results());
+	return EXIT_SUCCESS;
+}
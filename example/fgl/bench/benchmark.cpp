@@ -0,0 +1,57 @@
+/**
+This file is an example for <fgl/bench/benchmark.hpp>
+
+--- Example output
+-------------------------------------------------------------------------------
+accumulate: median 633.509ns [95% CI 611.606ns, 642.841ns], 0 outlier(s)
+sort: median 5891.82ns [95% CI 5826.14ns, 5962.81ns], 1 outlier(s)
+
+name,unit,iterations_per_sample,number_of_samples,number_of_outliers,median,...
+"accumulate",ns,20000,50,0,633.5088,611.60642125,642.84145,0.95,560.905428,...
+"sort",ns,799,49,1,5891.823529411765,5826.138923654568,5962.81351689612,...
+*/
+
+#include <algorithm> // sort
+#include <iostream>
+#include <numeric> // accumulate, iota
+#include <vector>
+
+#include <fgl/bench.hpp>
+
+int main()
+{
+	std::vector<int> data(1000);
+	std::iota(data.rbegin(), data.rend(), 0);
+
+	fgl::bench::harness harness;
+
+	harness.run("accumulate", [&data]()
+	{
+		// without this, the unused result could be optimized away
+		fgl::bench::do_not_optimize(
+			std::accumulate(data.cbegin(), data.cend(), 0)
+		);
+	});
+
+	std::vector<int> copy;
+	harness.run("sort", [&data, &copy]()
+	{
+		copy = data;
+		std::sort(copy.begin(), copy.end());
+		fgl::bench::clobber(); // the sorted elements must be written
+	});
+
+	for (const fgl::bench::result& r : harness.results())
+	{
+		std::cout
+			<< r.name << ": median " << r.statistics.median->count()
+			<< "ns [" << r.confidence * 100 << "% CI "
+			<< r.median_lower.count() << "ns, "
+			<< r.median_upper.count() << "ns], "
+			<< r.number_of_outliers << " outlier(s)\n";
+	}
+	std::cout << '\n';
+
+	// machine-readable results; see also fgl::bench::write_json()
+	fgl::bench::write_csv(std::cout, harness.results());
+}
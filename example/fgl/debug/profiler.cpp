@@ -0,0 +1,56 @@
+/**
+This file is an example for <fgl/debug/profiler.hpp>
+
+--- Example output
+-------------------------------------------------------------------------------
+[PROFILER]
+ \_____ Profile: thread 140266365339520
+	frame loop: 1 call, inclusive 3ms 914µs 397ns, exclusive 2µs 292ns
+	  \_ frame: 10 calls, inclusive 3ms 807µs 999ns, exclusive 3µs 133ns
+	    \_ void parse() in example/fgl/debug/profiler.cpp: 10 calls, inclusive 1ms 559µs 750ns, exclusive 1ms 559µs 750ns
+	    \_ evaluate: 10 calls, inclusive 2ms 245µs 116ns, exclusive 757µs 372ns
+	      \_ evaluate: 10 calls, inclusive 1ms 487µs 744ns, exclusive 746µs 341ns
+	        \_ evaluate: 10 calls, inclusive 741µs 403ns, exclusive 741µs 403ns
+	  \_ void parse() in example/fgl/debug/profiler.cpp: 1 call, inclusive 104µs 106ns, exclusive 104µs 106ns
+*/
+
+#include <thread>
+
+// define enables the short "PROFILE_ZONE" and "PROFILE_FUNCTION" macros
+// could also #define FGL_SHORT_MACROS
+#define FGL_DEBUG_PROFILER_SHORT_MACROS
+#include <fgl/debug/profiler.hpp>
+
+void parse()
+{
+	PROFILE_FUNCTION;
+	std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+void evaluate(const int depth)
+{
+	PROFILE_ZONE("evaluate");
+	std::this_thread::sleep_for(std::chrono::microseconds(20));
+	if (depth > 0)
+		evaluate(depth - 1);
+}
+
+int main()
+{
+	{
+		PROFILE_ZONE("frame loop");
+		for (int frame{}; frame < 10; ++frame)
+		{
+			PROFILE_ZONE("frame");
+			parse();
+			evaluate(2);
+		}
+		parse();
+	}
+
+	// send this thread's call tree to libFGL's debug output stream
+	fgl::debug::output(fgl::debug::profiler::this_thread());
+
+	// flush because the program terminates right after this
+	fgl::debug::output::stream.flush();
+}
@@ -13,6 +13,7 @@ cout: One inner yield: 10µs 300ns  (100 laps)
         Median lap:     100ns
         Min lap:        100ns
         Max lap:        200ns
+        Std. deviation: 17ns
 [STOPWATCH]
  \_____ Statistics: One inner yield, one check yield, and increment
         Number of laps: 100
@@ -21,6 +22,58 @@ cout: One inner yield: 10µs 300ns  (100 laps)
         Median lap:     200ns
         Min lap:        100ns
         Max lap:        300ns
+        Std. deviation: 40ns
+[STOPWATCH]
+ \_____ Statistics: Streaming inner yield
+        Number of laps: 100000
+        Total elapsed:  10ms 412µs 300ns
+        Mean lap:       104ns
+        Min lap:        100ns
+        Max lap:        12µs 900ns
+        Std. deviation: 61ns
+[STOPWATCH]
+ \_____ Statistics: Histogram inner yield
+        Number of laps: 100000
+        Total elapsed:  10ms 398µs 200ns
+        Mean lap:       103ns
+        Median lap:     100ns
+        Min lap:        100ns
+        Max lap:        10µs 100ns
+        Std. deviation: 45ns
+        P50 lap:        100ns
+        P99 lap:        200ns
+        P99.9 lap:      200ns
+        P99.99 lap:     1µs 500ns
+[STOPWATCH]
+ \_____ Statistics: Throughput of yields
+        Number of laps: 1000
+        Total elapsed:  2ms 54µs 518ns
+        Mean lap:       2µs 54ns
+        Median lap:     2µs 41ns
+        Min lap:        2µs 13ns
+        Max lap:        7µs 892ns
+        Std. deviation: 198ns
+        Overall rate:   4.86732e+06 items/s
+        Mean rate:      4.88222e+06 items/s
+        Median rate:    4.89956e+06 items/s
+        Min rate:       1.26711e+06 items/s
+        Max rate:       4.96771e+06 items/s
+[STOPWATCH]
+ \_____ Statistics: Counters of yields
+        Number of laps: 1000
+        Total elapsed:  615µs 481ns
+        Mean lap:       615ns
+        Median lap:     608ns
+        Min lap:        586ns
+        Max lap:        6µs 738ns
+        Std. deviation: 194ns
+        IPC:            unavailable
+        cycles:         unavailable
+        instructions:   unavailable
+        cache misses:   unavailable
+        branch misses:  unavailable
+        task-clock:     611.943 mean, 608 median per lap
+        page faults:    0 mean, 0 median per lap
 */
 
 #include <iostream>
@@ -28,6 +81,7 @@ cout: One inner yield: 10µs 300ns  (100 laps)
 
 #define NDEBUG // eliminate some stopwatch assertions
 #include <fgl/debug/stopwatch.hpp>
+#include <fgl/debug/stopwatch/perf_counter_lap_record.hpp>
 
 int main()
 {
@@ -67,6 +121,61 @@ int main()
 
 	fgl::debug::output(sw);
 
+	// a streaming stopwatch only keeps running aggregates of its laps, so its
+	// memory footprint never grows. Statistics which require the individual
+	// laps, like the median, aren't available.
+	fgl::debug::streaming_stopwatch ssw("Streaming inner yield");
+	for (int i{}; i < 100'000; ++i)
+	{
+		ssw.start();
+		std::this_thread::yield();
+		ssw.stop();
+	}
+
+	fgl::debug::output(ssw);
+
+	// a histogram stopwatch counts laps in a fixed number of log-scaled
+	// buckets, providing approximate percentiles without retaining every lap.
+	// Percentiles are opt-in, and are configured per stopwatch type.
+	using fgl::debug::histogram_stopwatch;
+	fgl::debug::output_config<histogram_stopwatch>::percentiles =
+		{ 50.0, 99.0, 99.9, 99.99 };
+	histogram_stopwatch hsw("Histogram inner yield");
+	for (int i{}; i < 100'000; ++i)
+	{
+		hsw.start();
+		std::this_thread::yield();
+		hsw.stop();
+	}
+
+	fgl::debug::output(hsw);
+
+	// a throughput stopwatch also records how much work each lap performed,
+	// providing the distribution of items processed per second
+	fgl::debug::throughput_stopwatch tsw("Throughput of yields");
+	for (int i{}; i < 1'000; ++i)
+	{
+		tsw.start();
+		for (int j{}; j < 10; ++j)
+			std::this_thread::yield();
+		tsw.stop(10);
+	}
+
+	fgl::debug::output(tsw);
+
+	// on Linux, a perf stopwatch also records the performance counter deltas
+	// of each lap. Hardware counters are often unavailable in virtual
+	// machines, in which case only the software counters are reported.
+	fgl::debug::perf_stopwatch psw("Counters of yields");
+	for (int i{}; i < 1'000; ++i)
+	{
+		psw.start();
+		std::this_thread::yield();
+		psw.stop();
+	}
+
+	fgl::debug::output(psw);
+
 	// flush because the program terminates right after this
 	fgl::debug::output::stream.flush();
 }
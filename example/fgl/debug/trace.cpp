@@ -0,0 +1,73 @@
+/**
+This file is an example for <fgl/debug/trace.hpp>
+
+--- Example output
+-------------------------------------------------------------------------------
+Wrote example_trace.json; open it with chrome://tracing or ui.perfetto.dev
+*/
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// define enables the short "PROFILE_ZONE" and "PROFILE_FUNCTION" macros
+// could also #define FGL_SHORT_MACROS
+#define FGL_DEBUG_PROFILER_SHORT_MACROS
+#include <fgl/debug/trace.hpp>
+
+void work(const std::chrono::microseconds how_long)
+{
+	PROFILE_ZONE("work");
+	std::this_thread::sleep_for(how_long);
+}
+
+int main()
+{
+	fgl::debug::set_trace_thread_name("main");
+	fgl::debug::trace_writer trace("example_trace.json");
+
+	// profilers only retain zone events if asked to
+	fgl::debug::profiler::this_thread().capture_events(true);
+
+	// a stopwatch with a timeline record knows when each lap started
+	fgl::debug::timeline_stopwatch sw("main loop");
+	sw.start();
+	for (int i{}; i < 5; ++i)
+	{
+		work(std::chrono::microseconds(100 * (i + 1)));
+		sw.lap();
+	}
+	sw.stop();
+	trace.write_laps(sw);
+	trace.write_zones(fgl::debug::profiler::this_thread());
+
+	// the trace writer isn't thread-safe, so workers take turns writing
+	std::mutex trace_mutex;
+	std::vector<std::thread> workers;
+	for (int t{}; t < 3; ++t)
+	{
+		workers.emplace_back([&trace, &trace_mutex, t]()
+		{
+			fgl::debug::set_trace_thread_name("worker " + std::to_string(t));
+			auto& p{ fgl::debug::profiler::this_thread() };
+			p.capture_events(true);
+			{
+				PROFILE_ZONE("worker");
+				for (int i{}; i < 4; ++i)
+					work(std::chrono::microseconds(50 * (t + 1)));
+			}
+			const std::lock_guard lock(trace_mutex);
+			trace.write_zones(p);
+		});
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+
+	trace.close(); // also writes the thread names
+	std::cout
+		<< "Wrote example_trace.json; open it with chrome://tracing or "
+		"ui.perfetto.dev" << std::endl;
+}
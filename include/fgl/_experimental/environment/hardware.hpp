@@ -33,6 +33,11 @@ namespace fgl::hardware {
 
 #else
 
+// the values are only used for alignment within a program, never across an
+// ABI boundary, so their variance between compiler flags is acceptable.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+
 [[maybe_unused]] inline constexpr std::size_t dis{
 	std::hardware_destructive_interference_size
 };
@@ -41,6 +46,8 @@ namespace fgl::hardware {
 	std::hardware_constructive_interference_size
 };
 
+#pragma GCC diagnostic pop
+
 #endif
 
 static_assert(
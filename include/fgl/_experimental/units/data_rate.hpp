@@ -3,6 +3,9 @@
 #define FGL_UNITS_DATA_RATE_HPP_INCLUDED
 
 #include <chrono>
+#include <concepts> // same_as
+#include <ratio>
+#include <string>
 #include "data_size.hpp"
 
 namespace fgl::units {
@@ -37,6 +40,65 @@ struct data_rate
 	constexpr rep count() const { return value; }
 };
 
+/// data rate traits & concept
+
+template <typename T>
+struct is_data_rate : public std::false_type
+{};
+
+template <typename T_rep, typename T_data_size, typename T_duration>
+struct is_data_rate<data_rate<T_rep, T_data_size, T_duration>>
+: public std::true_type
+{};
+
+template <typename T>
+inline constexpr bool is_data_rate_v = is_data_rate<T>::value;
+
+template <typename T>
+concept data_rate_type = is_data_rate_v<T>;
+
+/// Converts between data rates of different sizes and durations
+template <data_rate_type T_out, data_rate_type T_in>
+[[nodiscard]] constexpr T_out data_rate_cast(const T_in& in_data_rate)
+{
+	using size_ratio = std::ratio_divide<
+		typename T_in::data_size::byte_ratio,
+		typename T_out::data_size::byte_ratio
+	>;
+	using time_ratio = std::ratio_divide<
+		typename T_out::duration::period,
+		typename T_in::duration::period
+	>;
+	using factor = std::ratio_multiply<size_ratio, time_ratio>;
+	return T_out{
+		static_cast<typename T_out::rep>(
+			static_cast<long double>(in_data_rate.count())
+			* static_cast<long double>(factor::num)
+			/ static_cast<long double>(factor::den)
+		)
+	};
+}
+
+/// @returns The unit of @p T_data_rate, such as <tt>"MB/s"</tt>
+template <data_rate_type T_data_rate>
+[[nodiscard]] std::string data_rate_unit()
+{
+	using period = typename T_data_rate::duration::period;
+	std::string unit{
+		internal::data_size_unit_suffix<
+			typename T_data_rate::data_size::byte_ratio
+		>()
+	};
+	if constexpr (std::same_as<period, std::ratio<1>>) unit += "/s";
+	else if constexpr (std::same_as<period, std::milli>) unit += "/ms";
+	else if constexpr (std::same_as<period, std::micro>) unit += "/us";
+	else if constexpr (std::same_as<period, std::nano>) unit += "/ns";
+	else if constexpr (std::same_as<period, std::ratio<60>>) unit += "/min";
+	else if constexpr (std::same_as<period, std::ratio<3600>>) unit += "/h";
+	else unit += "/?";
+	return unit;
+}
+
 using bits_per_second = data_rate<intmax_t, bits, std::chrono::seconds>;
 using bytes_per_second = data_rate<intmax_t, bytes, std::chrono::seconds>;
 using kilobits_per_second = data_rate<intmax_t, kilobits, std::chrono::seconds>;
@@ -495,36 +495,30 @@ consteval auto data_size_unit_suffix()
 	using namespace fgl::units::ratio;
 	if constexpr (std::same_as<T_ratio, ratio::bit>) return "b";
 	else if constexpr (std::same_as<T_ratio, ratio::byte>) return "B";
-	else if constexpr (T_ratio::num % 1024)
-	{ // IEC
-		if constexpr (std::same_as<T_ratio, kibibit>) return "Kib";
-		else if constexpr (std::same_as<T_ratio, mebibit>) return "Mib";
-		else if constexpr (std::same_as<T_ratio, gibibit>) return "Gib";
-		else if constexpr (std::same_as<T_ratio, tebibit>) return "Tib";
-		else if constexpr (std::same_as<T_ratio, pebibit>) return "Pib";
-		else if constexpr (std::same_as<T_ratio, exbibit>) return "Eib";
-		else if constexpr (std::same_as<T_ratio, kibibyte>) return "KiB";
-		else if constexpr (std::same_as<T_ratio, mebibyte>) return "MiB";
-		else if constexpr (std::same_as<T_ratio, gibibyte>) return "GiB";
-		else if constexpr (std::same_as<T_ratio, tebibyte>) return "TiB";
-		else if constexpr (std::same_as<T_ratio, pebibyte>) return "PiB";
-		else if constexpr (std::same_as<T_ratio, exbibyte>) return "EiB";
-	}
-	else // Metric
-	{
-		if constexpr (std::same_as<T_ratio, kilobit>) return "Kb";
-		else if constexpr (std::same_as<T_ratio, megabit>) return "Mb";
-		else if constexpr (std::same_as<T_ratio, gigabit>) return "Gb";
-		else if constexpr (std::same_as<T_ratio, terabit>) return "Tb";
-		else if constexpr (std::same_as<T_ratio, petabit>) return "Pb";
-		else if constexpr (std::same_as<T_ratio, exabit>) return "Eb";
-		else if constexpr (std::same_as<T_ratio, kilobyte>) return "KB";
-		else if constexpr (std::same_as<T_ratio, megabyte>) return "MB";
-		else if constexpr (std::same_as<T_ratio, gigabyte>) return "GB";
-		else if constexpr (std::same_as<T_ratio, terabyte>) return "TB";
-		else if constexpr (std::same_as<T_ratio, petabyte>) return "PB";
-		else if constexpr (std::same_as<T_ratio, exabyte>) return "EB";
-	}
+	else if constexpr (std::same_as<T_ratio, kibibit>) return "Kib";
+	else if constexpr (std::same_as<T_ratio, mebibit>) return "Mib";
+	else if constexpr (std::same_as<T_ratio, gibibit>) return "Gib";
+	else if constexpr (std::same_as<T_ratio, tebibit>) return "Tib";
+	else if constexpr (std::same_as<T_ratio, pebibit>) return "Pib";
+	else if constexpr (std::same_as<T_ratio, exbibit>) return "Eib";
+	else if constexpr (std::same_as<T_ratio, kibibyte>) return "KiB";
+	else if constexpr (std::same_as<T_ratio, mebibyte>) return "MiB";
+	else if constexpr (std::same_as<T_ratio, gibibyte>) return "GiB";
+	else if constexpr (std::same_as<T_ratio, tebibyte>) return "TiB";
+	else if constexpr (std::same_as<T_ratio, pebibyte>) return "PiB";
+	else if constexpr (std::same_as<T_ratio, exbibyte>) return "EiB";
+	else if constexpr (std::same_as<T_ratio, kilobit>) return "Kb";
+	else if constexpr (std::same_as<T_ratio, megabit>) return "Mb";
+	else if constexpr (std::same_as<T_ratio, gigabit>) return "Gb";
+	else if constexpr (std::same_as<T_ratio, terabit>) return "Tb";
+	else if constexpr (std::same_as<T_ratio, petabit>) return "Pb";
+	else if constexpr (std::same_as<T_ratio, exabit>) return "Eb";
+	else if constexpr (std::same_as<T_ratio, kilobyte>) return "KB";
+	else if constexpr (std::same_as<T_ratio, megabyte>) return "MB";
+	else if constexpr (std::same_as<T_ratio, gigabyte>) return "GB";
+	else if constexpr (std::same_as<T_ratio, terabyte>) return "TB";
+	else if constexpr (std::same_as<T_ratio, petabyte>) return "PB";
+	else if constexpr (std::same_as<T_ratio, exabyte>) return "EB";
 	return "";
 }
 
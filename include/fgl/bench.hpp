@@ -0,0 +1,16 @@
+#pragma once
+#ifndef FGL_BENCH_HPP_INCLUDED
+#define FGL_BENCH_HPP_INCLUDED
+
+// should contain all `bench/*.hpp`
+
+/**
+@page page-fgl-header-bench libFGL Benchmarking
+@details
+	<tt>#include <fgl/bench.hpp></tt> provides the following:
+	- @ref group-bench-benchmark
+*/
+
+#include "./bench/benchmark.hpp"
+
+#endif // FGL_BENCH_HPP_INCLUDED
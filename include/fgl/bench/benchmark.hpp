@@ -0,0 +1,549 @@
+#pragma once
+#ifndef FGL_BENCH_BENCHMARK_HPP_INCLUDED
+#define FGL_BENCH_BENCHMARK_HPP_INCLUDED
+#include "../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <algorithm> // sort, max, min
+#include <atomic> // atomic_signal_fence
+#include <charconv> // to_chars
+#include <chrono>
+#include <concepts> // invocable
+#include <ostream>
+#include <random> // random_device
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error> // errc
+#include <utility> // move
+#include <vector>
+
+#include "../types/traits.hpp"
+#include "../debug/constexpr_assert.hpp"
+#include "../debug/stopwatch.hpp"
+#include "../utility/random.hpp"
+
+namespace fgl::bench {
+
+/**
+@file
+
+@example example/fgl/bench/benchmark.cpp
+	An example for @ref group-bench-benchmark
+
+@defgroup group-bench-benchmark Benchmark
+
+@brief A statistically rigorous micro-benchmark harness
+
+@details
+	<tt>@ref fgl::bench::generic_harness</tt> measures a function by timing
+	a number of <i>samples</i>, each of which calls the function a fixed
+	number of times:
+	-# The function is called <tt>warmup_iterations</tt> times, untimed, to
+		warm caches and branch predictors.
+	-# Unless <tt>iterations_per_sample</tt> is configured, the number of
+		calls per sample is scaled until a sample takes at least
+		<tt>target_duration / number_of_samples</tt>. This amortizes the
+		overhead of reading the clock over many calls.
+	-# Every sample is timed as a lap of a stopwatch, and divided by the
+		number of calls to produce the time of a single call.
+	-# Samples outside of Tukey's fences, which are
+		<tt>outlier_fence</tt> interquartile ranges beyond the first and
+		third quartiles, are rejected as interference from the system.
+	-# A percentile bootstrap of the remaining samples estimates a
+		confidence interval of the median.
+
+	Results can be written as JSON with <tt>@ref fgl::bench::write_json()</tt>
+	or CSV with <tt>@ref fgl::bench::write_csv()</tt>.
+
+	Compilers are free to remove calculations whose results are unused.
+	<tt>@ref fgl::bench::do_not_optimize()</tt> and
+	<tt>@ref fgl::bench::clobber()</tt> prevent this without adding
+	meaningful overhead.
+
+	The programs in the <tt>bench/</tt> directory are built and run by Tup
+	alongside the tests; see <tt>tup.config.DEFAULT</tt>.
+
+	@see The example program @ref example/fgl/bench/benchmark.cpp
+@{
+*/
+
+/**
+@{ @name Optimization Barriers
+*/
+
+/**
+@brief Forces @p value to be computed and stored, as if it were read and
+	modified by something the compiler can't see.
+*/
+template <typename T>
+inline void do_not_optimize(T& value) noexcept
+{
+	#if defined(__GNUC__)
+	asm volatile("" : "+m"(value) : : "memory");
+	#else
+	static volatile const void* sink{};
+	sink = &value;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	#endif
+}
+
+/// @copybrief do_not_optimize(T&)
+template <typename T>
+inline void do_not_optimize(const T& value) noexcept
+{
+	#if defined(__GNUC__)
+	asm volatile("" : : "m"(value) : "memory");
+	#else
+	static volatile const void* sink{};
+	sink = &value;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	#endif
+}
+
+/// Forces all pending writes to memory to be performed
+inline void clobber() noexcept
+{
+	#if defined(__GNUC__)
+	asm volatile("" : : : "memory");
+	#else
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	#endif
+}
+///@} Optimization Barriers
+
+/// The configuration of a <tt>@ref generic_harness</tt>
+struct config
+{
+	/// The approximate total duration of the timed samples of a benchmark
+	std::chrono::nanoseconds target_duration{ std::chrono::milliseconds(200) };
+
+	/// The number of timed samples of a benchmark
+	std::size_t number_of_samples{ 50 };
+
+	/// The number of untimed calls made before any samples are taken
+	std::size_t warmup_iterations{ 100 };
+
+	/// The number of calls per sample, or <tt>0</tt> to scale automatically
+	std::size_t iterations_per_sample{ 0 };
+
+	/// The most calls per sample that automatic scaling may choose
+	std::size_t max_iterations_per_sample{ 1'000'000'000 };
+
+	/**
+	The number of interquartile ranges beyond the quartiles at which samples
+	are rejected as outliers. Zero or less disables outlier rejection.
+	*/
+	double outlier_fence{ 1.5 };
+
+	/// The number of bootstrap resamples used to estimate the interval
+	std::size_t bootstrap_resamples{ 2'000 };
+
+	/// The confidence level of the median interval, in <tt>(0, 1)</tt>
+	double confidence{ 0.95 };
+
+	/// The seed of the bootstrap, so that results are reproducible
+	std::random_device::result_type seed{ 0x5EED };
+};
+
+/// The measurements of a single benchmark
+struct result
+{
+	/// The duration type of a single call
+	using duration_t = std::chrono::duration<double, std::nano>;
+
+	/// The name of the benchmark
+	std::string name{};
+
+	/// The number of calls timed by each sample
+	std::size_t iterations_per_sample{};
+
+	/// The number of samples rejected as outliers
+	std::size_t number_of_outliers{};
+
+	/// The statistics of the samples which weren't rejected, per call
+	fgl::debug::lap_statistics<duration_t> statistics{};
+
+	/// The lower bound of the confidence interval of the median
+	duration_t median_lower{};
+
+	/// The upper bound of the confidence interval of the median
+	duration_t median_upper{};
+
+	/// The confidence level of the interval of the median
+	double confidence{};
+};
+
+/**
+@{ @name Sample Statistics
+*/
+
+/**
+@returns The @p q quantile of @p sorted, linearly interpolated between the
+	closest ranks.
+@param sorted Values sorted in ascending order. Mustn't be empty.
+@param q The quantile in the range <tt>[0, 1]</tt>
+*/
+template <typename T>
+[[nodiscard]] constexpr T quantile(
+	const std::span<const T> sorted,
+	const double q)
+{
+	FGL_DEBUG_CONSTEXPR_ASSERT(!sorted.empty());
+	FGL_DEBUG_CONSTEXPR_ASSERT(q >= 0.0 && q <= 1.0);
+	const double position{ q * static_cast<double>(sorted.size() - 1) };
+	const auto lower{ static_cast<std::size_t>(position) };
+	const std::size_t upper{ std::min(lower + 1, sorted.size() - 1) };
+	const double weight{ position - static_cast<double>(lower) };
+	return sorted[lower] + (sorted[upper] - sorted[lower]) * weight;
+}
+
+/**
+@brief Removes the values of @p sorted which lie outside of Tukey's fences.
+@param sorted Values sorted in ascending order, which remain sorted
+@param fence The number of interquartile ranges beyond the first and third
+	quartiles which values may lie within. Zero or less removes nothing.
+@returns The number of values which were removed
+*/
+template <typename T>
+constexpr std::size_t reject_outliers(
+	std::vector<T>& sorted,
+	const double fence)
+{
+	if (sorted.size() < 4 || !(fence > 0.0))
+		return 0;
+	const std::span<const T> s(sorted);
+	const T q1{ quantile(s, 0.25) };
+	const T q3{ quantile(s, 0.75) };
+	const T low{ q1 - (q3 - q1) * fence };
+	const T high{ q3 + (q3 - q1) * fence };
+	const auto first{ std::ranges::lower_bound(sorted, low) };
+	const auto last{ std::ranges::upper_bound(sorted, high) };
+	const auto removed{ static_cast<std::size_t>(
+		(first - sorted.begin()) + (sorted.end() - last)
+	) };
+	sorted.erase(last, sorted.end());
+	sorted.erase(sorted.begin(), first);
+	return removed;
+}
+
+/// A confidence interval
+template <typename T>
+struct interval
+{
+	T lower;
+	T upper;
+};
+
+/**
+@returns A percentile bootstrap confidence interval of the median of
+	@p sorted.
+@param sorted Values sorted in ascending order
+@param resamples The number of resamples to draw with replacement
+@param confidence The confidence level in <tt>(0, 1)</tt>
+@param seed The seed of the pseudo-random resampling
+*/
+template <typename T>
+[[nodiscard]] interval<T> bootstrap_median_interval(
+	const std::span<const T> sorted,
+	const std::size_t resamples,
+	const double confidence,
+	const std::random_device::result_type seed)
+{
+	FGL_DEBUG_CONSTEXPR_ASSERT(confidence > 0.0 && confidence < 1.0);
+	if (sorted.empty())
+		return { T{}, T{} };
+	if (sorted.size() == 1 || resamples == 0)
+	{
+		const T median{ quantile(sorted, 0.5) };
+		return { median, median };
+	}
+
+	fgl::random<std::size_t> pick(0, sorted.size() - 1, seed);
+	std::vector<T> resample(sorted.size());
+	std::vector<T> medians;
+	medians.reserve(resamples);
+	for (std::size_t r{}; r < resamples; ++r)
+	{
+		for (T& value : resample)
+			value = sorted[pick()];
+		std::ranges::sort(resample);
+		medians.push_back(quantile(std::span<const T>(resample), 0.5));
+	}
+	std::ranges::sort(medians);
+	const double tail{ (1.0 - confidence) / 2.0 };
+	const std::span<const T> m(medians);
+	return { quantile(m, tail), quantile(m, 1.0 - tail) };
+}
+///@} Sample Statistics
+
+/**
+@brief Runs benchmarks and retains their results.
+@tparam T_clock A @ref fgl::traits::steady_clock used to time the samples.
+	<tt>std::chrono::steady_clock</tt> by default.
+*/
+template <fgl::traits::steady_clock T_clock = std::chrono::steady_clock>
+class generic_harness
+{
+public:
+	/// The clock which times the samples
+	using clock_t = T_clock;
+
+	/// The stopwatch which times the samples
+	using stopwatch_t = fgl::debug::generic_stopwatch<clock_t>;
+
+private:
+	config m_config;
+	std::vector<result> m_results{};
+
+	template <std::invocable T_function>
+	static void repeat(T_function& function, const std::size_t iterations)
+	{
+		for (std::size_t i{}; i < iterations; ++i)
+			function();
+	}
+
+	/// @returns The number of calls for a sample to take the target duration
+	template <std::invocable T_function>
+	[[nodiscard]] std::size_t scale_iterations(T_function& function) const
+	{
+		using rep_t = std::chrono::nanoseconds::rep;
+		const std::size_t samples{
+			std::max(m_config.number_of_samples, std::size_t{ 1 })
+		};
+		const auto target{
+			m_config.target_duration / static_cast<rep_t>(samples)
+		};
+		const std::size_t max_iterations{ m_config.max_iterations_per_sample };
+		std::size_t iterations{ 1 };
+		stopwatch_t sw("scaling", 1);
+		for (;;)
+		{
+			sw.start();
+			repeat(function, iterations);
+			sw.stop();
+			const auto elapsed{ sw.previous_lap() };
+			sw.reset();
+			if (elapsed >= target || iterations >= max_iterations)
+				return iterations;
+
+			// grow towards the estimated count, by at most 10x per attempt
+			std::size_t next{ iterations * 10 };
+			if (elapsed > decltype(elapsed){})
+			{
+				const double estimate{
+					1.2 * static_cast<double>(iterations) * (
+						std::chrono::duration<double>(target)
+						/ std::chrono::duration<double>(elapsed)
+					)
+				};
+				if (estimate < static_cast<double>(next))
+					next = static_cast<std::size_t>(estimate);
+			}
+			next = std::max(next, iterations * 2);
+			iterations = std::min(next, max_iterations);
+		}
+	}
+
+public:
+	/// @param configuration How benchmarks will be measured
+	[[nodiscard]] explicit generic_harness(const config& configuration = {})
+	: m_config(configuration)
+	{}
+
+	/// @returns How benchmarks are measured
+	[[nodiscard]] const config& get_config() const noexcept
+	{ return m_config; }
+
+	/**
+	@brief Measures @p function and retains the result.
+	@param name The name of the benchmark
+	@param function The function to measure, which is called many times.
+		Use <tt>@ref do_not_optimize()</tt> on its results.
+	@returns A reference to the retained result
+	*/
+	template <std::invocable T_function>
+	const result& run(std::string name, T_function&& function)
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_config.number_of_samples != 0);
+		repeat(function, m_config.warmup_iterations);
+		const std::size_t iterations{
+			m_config.iterations_per_sample != 0
+			? m_config.iterations_per_sample
+			: scale_iterations(function)
+		};
+
+		stopwatch_t sw(name, m_config.number_of_samples);
+		for (std::size_t s{}; s < m_config.number_of_samples; ++s)
+		{
+			sw.start();
+			repeat(function, iterations);
+			sw.stop();
+		}
+
+		using duration_t = result::duration_t;
+		std::vector<duration_t> samples;
+		samples.reserve(sw.number_of_laps());
+		const auto n{ static_cast<double>(iterations) };
+		for (const auto lap : sw.get_all_laps())
+			samples.push_back(duration_t(lap) / n);
+		std::ranges::sort(samples);
+
+		result r;
+		r.name = std::move(name);
+		r.iterations_per_sample = iterations;
+		r.number_of_outliers = reject_outliers(samples, m_config.outlier_fence);
+		r.statistics = fgl::debug::lap_statistics<duration_t>(samples);
+		const auto median_interval{
+			bootstrap_median_interval(
+				std::span<const duration_t>(samples),
+				m_config.bootstrap_resamples,
+				m_config.confidence,
+				m_config.seed
+			)
+		};
+		r.median_lower = median_interval.lower;
+		r.median_upper = median_interval.upper;
+		r.confidence = m_config.confidence;
+		m_results.push_back(std::move(r));
+		return m_results.back();
+	}
+
+	/// @returns The results of every benchmark, in the order they were run
+	[[nodiscard]] std::span<const result> results() const noexcept
+	{ return m_results; }
+
+	/// Discards all results
+	void clear() noexcept
+	{ m_results.clear(); }
+};
+
+/// A convenient alias for a <tt>std::chrono::steady_clock</tt> harness
+using harness = generic_harness<>;
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/// Writes @p value with the fewest digits which represent it exactly
+inline void write_number(std::ostream& os, const double value)
+{
+	char digits[32];
+	const auto [end, ec]{ std::to_chars(digits, digits + 32, value) };
+	FGL_DEBUG_CONSTEXPR_ASSERT(ec == std::errc{});
+	os.write(digits, end - digits);
+}
+
+inline void write_json_string(std::ostream& os, const std::string_view s)
+{
+	constexpr std::string_view hex{ "0123456789abcdef" };
+	os.put('"');
+	for (const char c : s)
+	{
+		const auto uc{ static_cast<unsigned char>(c) };
+		if (c == '"' || c == '\\')
+			os.put('\\').put(c);
+		else if (uc < 0x20)
+			os << "\\u00" << hex[uc >> 4] << hex[uc & 0xF];
+		else
+			os.put(c);
+	}
+	os.put('"');
+}
+
+inline void write_csv_string(std::ostream& os, const std::string_view s)
+{
+	os.put('"');
+	for (const char c : s)
+	{
+		if (c == '"')
+			os.put('"');
+		os.put(c);
+	}
+	os.put('"');
+}
+
+} // namespace internal
+///@endcond
+
+/**
+@{ @name Result Output
+@brief Durations are written as fractional nanoseconds per call.
+*/
+
+/**
+@brief Writes @p results as a JSON document.
+@details The document is an object with a <tt>"benchmarks"</tt> array,
+	containing an object per result.
+*/
+inline void write_json(std::ostream& os, const std::span<const result> results)
+{
+	os << "{\"benchmarks\":[";
+	bool first{ true };
+	for (const result& r : results)
+	{
+		const auto& s{ r.statistics };
+		const auto field{
+			[&os](const std::string_view key, const double value)
+			{
+				os << ",\"" << key << "\":";
+				internal::write_number(os, value);
+			}
+		};
+		os << (first ? "\n{" : ",\n{");
+		first = false;
+		os << "\"name\":";
+		internal::write_json_string(os, r.name);
+		os << ",\"unit\":\"ns\"";
+		os << ",\"iterations_per_sample\":" << r.iterations_per_sample;
+		os << ",\"number_of_samples\":" << s.number_of_laps;
+		os << ",\"number_of_outliers\":" << r.number_of_outliers;
+		field("median", s.median.value_or(result::duration_t{}).count());
+		field("median_lower", r.median_lower.count());
+		field("median_upper", r.median_upper.count());
+		field("confidence", r.confidence);
+		field("mean", s.mean.count());
+		field("min", s.min.count());
+		field("max", s.max.count());
+		field("standard_deviation", s.standard_deviation.count());
+		os << '}';
+	}
+	os << "\n]}\n";
+}
+
+/// Writes @p results as CSV, with a header row and a row per result
+inline void write_csv(std::ostream& os, const std::span<const result> results)
+{
+	os << "name,unit,iterations_per_sample,number_of_samples,"
+		"number_of_outliers,median,median_lower,median_upper,confidence,"
+		"mean,min,max,standard_deviation\n";
+	for (const result& r : results)
+	{
+		const auto& s{ r.statistics };
+		const auto field{
+			[&os](const double value)
+			{
+				os.put(',');
+				internal::write_number(os, value);
+			}
+		};
+		internal::write_csv_string(os, r.name);
+		os << ",ns," << r.iterations_per_sample
+			<< ',' << s.number_of_laps
+			<< ',' << r.number_of_outliers;
+		field(s.median.value_or(result::duration_t{}).count());
+		field(r.median_lower.count());
+		field(r.median_upper.count());
+		field(r.confidence);
+		field(s.mean.count());
+		field(s.min.count());
+		field(s.max.count());
+		field(s.standard_deviation.count());
+		os.put('\n');
+	}
+}
+///@} Result Output
+
+///@} group-bench-benchmark
+} // namespace fgl::bench
+
+#endif // FGL_BENCH_BENCHMARK_HPP_INCLUDED
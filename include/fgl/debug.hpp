@@ -13,7 +13,9 @@
 	- @ref group-debug-exception_occurs
 	- @ref group-debug-fixme
 	- @ref group-debug-output
+	- @ref group-debug-profiler
 	- @ref group-debug-stopwatch
+	- @ref group-debug-trace
 */
 
 #include "./debug/constexpr_assert.hpp"
@@ -21,6 +23,14 @@
 #include "./debug/exception_occurs.hpp"
 #include "./debug/fixme.hpp"
 #include "./debug/output.hpp"
+#include "./debug/profiler.hpp"
 #include "./debug/stopwatch.hpp"
+#include "./debug/stopwatch/baseline.hpp"
+#include "./debug/stopwatch/concurrent_stopwatch.hpp"
+#include "./debug/stopwatch/interval_reporter.hpp"
+#include "./debug/stopwatch/overhead.hpp"
+#include "./debug/stopwatch/parallel_statistics.hpp"
+#include "./debug/stopwatch/registry.hpp"
+#include "./debug/trace.hpp"
 
 #endif // FGL_DEBUG_HPP_INCLUDED
@@ -180,36 +180,29 @@ class output_config<echo> final
 	///@{ @name Configurable formatters
 
 	/// Formatter for <tt>@ref ECHO()</tt>'s message string @showinitializer
-	static inline
-	std::function<std::string(std::string_view)> message_formatter{
-		default_echo_fmt
-	};
+	static inline configurable_formatter<default_echo_fmt> message_formatter{};
 
 	/**
 	@brief Formatter for <tt>@ref ECHOV()</tt>'s expression string
 	@showinitializer
 	*/
-	static inline
-	std::function<std::string(std::string_view)> expression_formatter{
-		default_echo_fmt
-	};
+	static inline configurable_formatter<default_echo_fmt>
+		expression_formatter{};
 
 	/**
 	@brief Formatter for the result of <tt>@ref ECHOV()</tt>'s expression
 	@showinitializer
 	*/
 	template <typename T>
-	static inline std::function<std::string(const T&)> value_formatter{
-		default_fmt_value<T>
-	};
+	static inline configurable_formatter<default_fmt_value<T>>
+		value_formatter{};
 
 	/**
 	@brief Formatter for <tt>@ref ECHO()</tt>'s message and source location
 	@showinitializer
 	*/
-	static inline output::format_msg_src_t formatter {
-		output::default_fmt_msg_src
-	};
+	static inline configurable_formatter<output::default_fmt_msg_src>
+		formatter{};
 	///@} Configurable formatters
 
 	/**
@@ -174,9 +174,8 @@ class output_config<fixme> final
 
 	///@{ @name Configurable formatters
 	/// Formatter for fix-me strings (both expressions and messages)
-	static inline output::format_msg_src_t formatter{
-		output::default_fmt_msg_src
-	};
+	static inline configurable_formatter<output::default_fmt_msg_src>
+		formatter{};
 	///@} Configurable formatters
 
 	/**
@@ -4,17 +4,31 @@
 #include "../environment/libfgl_compatibility_check.hpp"
 
 #include <cassert>
+#include <cstddef> // size_t, byte
+#include <cstdlib> // atexit
+#include <array>
+#include <atomic>
+#include <memory> // unique_ptr
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <iostream> // cout
 #include <sstream> // ostringstream
-#include <functional> // function, reference wrapper
+#include <functional> // reference_wrapper
+#include <concepts> // convertible_to
 #include <optional>
 #include <source_location>
+#include <type_traits> // remove_cvref_t
 
 #include "../types/traits.hpp"
 #include "../types/string_literal.hpp"
+#include "./output/async_writer.hpp"
+#include "./output/configurable_formatter.hpp"
+#include "./output/deferred.hpp"
+#include "./output/line_buffer.hpp"
+#include "./output/priority.hpp"
+#include "./output/sink.hpp"
 
 namespace fgl::debug {
 
@@ -67,29 +81,101 @@ namespace fgl::debug {
 	options such as channel name, priority, formatters, etc.
 	@endparblock
 
+	Output is written synchronously by the thread which sends it, unless
+	asynchronous output is enabled with
+	<tt>@ref fgl::debug::output::async_t::enable()</tt>. Then formatted output
+	is enqueued and written to the stream by a background thread, so sending
+	output doesn't wait for stream I/O.
+
+	Output may be sent by several threads at once. Each line is formatted in
+	the sending thread's own buffer, without a lock, and is then written to
+	the stream with a single <tt>write()</tt>, so concurrently sent lines are
+	never interleaved.
+
+	Output can also be fanned out to several
+	<tt>@ref fgl::debug::output_sink</tt>s, such as a stream, a file, and an
+	in-memory ring of recent lines, each with its own priority threshold and
+	batching. See <tt>@ref fgl::debug::output::sinks</tt>.
+
+	Channels can also be removed at compile-time, so that sending output on
+	them costs nothing: channels whose initial priority is below
+	<tt>@ref fgl::debug::priority_floor</tt>, which is set by the
+	<tt>@ref FGL_DEBUG_OUTPUT_PRIORITY_FLOOR</tt> macro, and channels for
+	which <tt>@ref fgl::debug::channel_compiled_in</tt> is specialized as
+	<tt>false</tt>. The <tt>@ref FGL_DEBUG_OUTPUT()</tt> family of macros
+	also removes the evaluation of the output's arguments.
+
 	@see The example programs @ref example/fgl/debug/output_simple.cpp and
 		@ref example/fgl/debug/output_advanced.cpp
 
 @{
 */
 
+#ifndef FGL_DEBUG_OUTPUT_PRIORITY_FLOOR
+	/**
+	@brief The name of the <tt>@ref fgl::debug::priority</tt> below which
+		channels are removed at compile-time, such as <tt>info</tt>.
+	@details Defaults to <tt>minimum</tt>, which removes nothing. Must be
+		the same in every translation unit, so it should be defined on the
+		command line; for example,
+		<tt>-DFGL_DEBUG_OUTPUT_PRIORITY_FLOOR=info</tt> for release builds.
+	@see <tt>@ref fgl::debug::priority_floor</tt>
+	*/
+	#define FGL_DEBUG_OUTPUT_PRIORITY_FLOOR minimum
+#endif // ifndef FGL_DEBUG_OUTPUT_PRIORITY_FLOOR
+
 /**
-@brief Output channel priority levels which are compared to
-	<tt>@ref fgl::debug::output::priority_threshold</tt>
+@brief Channels whose initial priority is below this floor are removed at
+	compile-time.
+@details Unlike <tt>@ref fgl::debug::output::priority_threshold</tt>, this
+	can't be changed at run-time, and output on removed channels is never
+	formatted or sent, nor are the channels' states checked. It only applies
+	to channels which declare a <tt>static constexpr priority
+	compile_time_priority</tt>, such as every
+	<tt>@ref fgl::debug::simple_output_channel</tt>.
+@see <tt>@ref FGL_DEBUG_OUTPUT_PRIORITY_FLOOR</tt>
 */
-enum class priority : unsigned char
-{
-	minimum,
-	debug,
-	info,
-	message,
-	event,
-	warning,
-	error,
-	fatal,
-	maximum
+inline constexpr priority priority_floor{
+	priority::FGL_DEBUG_OUTPUT_PRIORITY_FLOOR
 };
 
+/**
+@brief Specialize as <tt>false</tt> to remove a channel at compile-time.
+@details Output on a removed channel is never formatted or sent, regardless
+	of its enabled state, and the <tt>@ref FGL_DEBUG_OUTPUT()</tt> family of
+	macros doesn't evaluate its arguments. The specialization must be
+	declared before the channel is used.
+	@code
+	template <>
+	inline constexpr bool
+		fgl::debug::channel_compiled_in<fgl::debug::output_config<my_type>>
+		= false;
+	@endcode
+@tparam T_channel An <tt>@ref fgl::debug::output_channel</tt>
+*/
+template <typename T_channel>
+inline constexpr bool channel_compiled_in{ true };
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/// @returns <tt>false</tt> if @p T_channel is removed given @p floor
+template <typename T_channel>
+[[nodiscard]] consteval bool compiled_in(const priority floor) noexcept
+{
+	if constexpr (requires {
+		{ T_channel::compile_time_priority } -> std::convertible_to<priority>;
+	})
+	{
+		if (T_channel::compile_time_priority < floor)
+			return false;
+	}
+	return channel_compiled_in<T_channel>;
+}
+
+} // namespace internal
+///@endcond
+
 /**
 @details
 	An output channel is a type which is responsible for maintaining state
@@ -190,6 +276,11 @@ class simple_output_channel
 	///@}
 
 	public:
+	/**
+	@brief The initial priority, which is compared to
+		<tt>@ref fgl::debug::priority_floor</tt> at compile-time
+	*/
+	static constexpr priority compile_time_priority{ T_priority };
 
 	/// enables the output channel
 	static void turn_on() noexcept { m_enabled = true; }
@@ -340,10 +431,8 @@ class output_config
 		}
 	}
 
-	/// Configurable formatter for <tt>T</tt>
-	static inline std::function<std::string(const T&)> format{
-		default_formatter
-	};
+	/// Configurable formatter for <tt>T</tt> @showinitializer
+	static inline configurable_formatter<default_formatter> format{};
 };
 
 static_assert(output_handler<output_config<int>, int>);
@@ -368,18 +457,43 @@ class output final
 	class output_stream_t
 	{
 		static inline std::ostream* m_output_stream{ &std::cout };
+		static inline std::mutex m_write_mutex{};
 		friend class output;
 
 		/// Getter @internal
 		[[nodiscard]] std::ostream& operator()() const noexcept
 		{ return *m_output_stream; }
 
+		/**
+		@brief Writes a whole line with a single <tt>write()</tt> @internal
+		@details The lock is only held while the line, which was already
+			formatted, is written, so lines which are sent concurrently are
+			never interleaved.
+		*/
+		void write_line(const std::string_view line) const
+		{
+			const std::scoped_lock lock(m_write_mutex);
+			m_output_stream->write(line.data(), std::ssize(line));
+		}
+
 		public:
 
-		/// Writes uncommited changhes to the output stream
+		/**
+		@brief Writes uncommited changhes to the output stream
+		@details In asynchronous mode, waits for the output which was already
+			sent to be written and flushed by the writer thread. Every
+			registered <tt>@ref sinks</tt> is flushed too.
+		*/
 		output_stream_t& flush()
 		{
-			m_output_stream->flush();
+			if (async_writer* const writer{ async.writer() })
+				writer->flush();
+			else
+			{
+				const std::scoped_lock lock(m_write_mutex);
+				m_output_stream->flush();
+			}
+			sinks.flush();
 			return *this;
 		}
 
@@ -403,15 +517,176 @@ class output final
 	*/
 	static inline output_stream_t stream;
 
+	/**
+	@brief Configuration of asynchronous output
+	@details In asynchronous mode, output is formatted by the thread which
+		sends it and enqueued to an <tt>@ref fgl::debug::async_writer</tt>,
+		whose thread writes it to the output stream.
+
+		Everything sent before the program exits is written: the first time
+		asynchronous output is enabled, it registers an <tt>std::atexit</tt>
+		handler which disables it, so queued output is written while streams
+		which were constructed before then still exist. Output sent later,
+		such as by the destructors of static objects, is synchronous. Output
+		is lost if the program ends without running <tt>std::atexit</tt>
+		handlers, such as with <tt>std::quick_exit()</tt>.
+
+		Enabling, disabling, and exiting must not happen while other threads
+		send output.
+	*/
+	class async_t
+	{
+		static constinit inline internal::async_writer_slot m_slot{};
+		static inline std::atomic<bool> m_registered_at_exit{ false };
+
+		static void disable_at_exit() noexcept
+		{ async_t{}.disable(); }
+
+		public:
+		/**
+		@brief Enables asynchronous output, or changes its configuration by
+			replacing the writer after writing its queued output.
+		@param capacity The maximum number of queued records, rounded up to a
+			power of two.
+		@param policy What a thread sending output does if the queue is full
+		*/
+		void enable(
+			const std::size_t capacity = 8192,
+			const backpressure policy = backpressure::block) const
+		{
+			disable();
+			if (!m_registered_at_exit.exchange(true))
+				std::atexit(disable_at_exit);
+			m_slot.writer.store(
+				new async_writer(capacity, policy),
+				std::memory_order_release
+			);
+		}
+
+		/// Writes all queued output, and returns to synchronous output
+		void disable() const
+		{
+			std::unique_ptr<async_writer>(
+				m_slot.writer.exchange(nullptr, std::memory_order_acq_rel)
+			).reset();
+		}
+
+		/// @returns <tt>true</tt> if output is asynchronous
+		[[nodiscard]] bool enabled() const noexcept
+		{ return writer() != nullptr; }
+
+		/// @returns The writer, or <tt>nullptr</tt> if output is synchronous
+		[[nodiscard]] async_writer* writer() const noexcept
+		{ return m_slot.writer.load(std::memory_order_acquire); }
+
+		/**
+		@returns The number of records which were discarded by the writer's
+			backpressure policy since asynchronous output was enabled
+		*/
+		[[nodiscard]] std::size_t dropped() const noexcept
+		{
+			const async_writer* const w{ writer() };
+			return w ? w->dropped() : 0;
+		}
+	};
+
+	/// Asynchronous output configuration
+	static inline async_t async;
+
+	/**
+	@brief The registry of output sinks
+	@details While any sinks are registered, output is written to each sink
+		whose threshold its priority meets, instead of to
+		<tt>@ref stream</tt>. Each line is formatted once and shared by the
+		sinks, and isn't formatted at all if no sink would write it. For
+		example, a console which only shows warnings, a file of all output,
+		and the most recent lines in memory:
+		@code
+		using namespace fgl::debug;
+		output::sinks.add(
+			std::make_shared<stream_sink>(std::cerr, priority::warning)
+		);
+		output::sinks.add(std::make_shared<file_sink>("debug.log"));
+		const auto recent{ std::make_shared<memory_ring_sink>(256) };
+		output::sinks.add(recent);
+		@endcode
+
+		Sinks must not be added or removed while other threads send output.
+		In asynchronous mode, the writer thread writes to the sinks, and
+		queued output is written before they change.
+	*/
+	class sinks_t
+	{
+		static inline internal::sink_list m_sinks{};
+		friend class output;
+
+		/// Writes queued output which refers to the current sinks
+		static void drain() noexcept
+		{
+			if (async_writer* const writer{ async.writer() })
+				writer->flush();
+		}
+
+		public:
+		/// Registers @p sink
+		void add(std::shared_ptr<output_sink> sink) const
+		{
+			drain();
+			m_sinks.push_back(std::move(sink));
+		}
+
+		/**
+		@brief Unregisters @p sink
+		@returns <tt>false</tt> if it wasn't registered
+		*/
+		bool remove(const output_sink& sink) const
+		{
+			drain();
+			const auto removed{
+				std::erase_if(m_sinks, [&sink](const auto& p) noexcept
+				{ return p.get() == &sink; })
+			};
+			return removed != 0;
+		}
+
+		/// Unregisters every sink, so output is written to the stream again
+		void clear() const
+		{
+			drain();
+			m_sinks.clear();
+		}
+
+		/// @returns <tt>true</tt> if no sinks are registered
+		[[nodiscard]] bool empty() const noexcept
+		{ return m_sinks.empty(); }
+
+		/// @returns The number of registered sinks
+		[[nodiscard]] std::size_t size() const noexcept
+		{ return m_sinks.size(); }
+
+		/// Writes every sink's batched output, and flushes it
+		void flush() const
+		{
+			for (const auto& sink : m_sinks)
+				sink->flush();
+		}
+	};
+
+	/// Output sink registry
+	static inline sinks_t sinks;
+
 	///@{ @name Default Formatters
 
 	/// The default formatter for channel name prefixes
 	[[nodiscard]] static inline std::string default_fmt_head(
 		const std::string_view name)
 	{
-		std::ostringstream ss;
-		ss << '[' << name << "] ";
-		return ss.str();
+		std::string head;
+		head.reserve(name.size() + 3);
+		head += '[';
+		head += name;
+		head += "] ";
+		return head;
 	}
 
 	/// The formatter for messages
@@ -442,26 +717,28 @@ class output final
 
 	///@{ @name Formatter Configuration
 
-	using format_head_t = std::function<std::string(std::string_view)>;
+	using format_head_t = std::string (*)(std::string_view);
 
-	using format_msg_t = std::function<std::string(std::string_view)>;
+	using format_msg_t = std::string (*)(std::string_view);
 
 	using format_msg_src_t =
-		std::function<std::string(std::string_view, std::source_location)>;
+		std::string (*)(std::string_view, std::source_location);
 
 	/// Formatter for channel name prefixes @showinitializer
-	static inline format_head_t format_head{ default_fmt_head };
+	static inline configurable_formatter<default_fmt_head> format_head{};
 
 	/// Formatter for messages @showinitializer
-	static inline format_msg_t format_msg{ default_fmt_msg };
+	static inline configurable_formatter<default_fmt_msg> format_msg{};
 
 	/// Formatter for messages with a source location @showinitializer
-	static inline format_msg_src_t format_msg_src{ default_fmt_msg_src };
+	static inline configurable_formatter<default_fmt_msg_src> format_msg_src{};
 	///@} Configurable Formatters
 
 	/**
 	@brief Checks whether or not a channel is permitted to send output
-	@details Whether a channel may send output is determined by three factors:
+	@details Whether a channel may send output is determined by three factors,
+		unless the channel was removed at compile-time (see
+		<tt>@ref compiled_in()</tt>):
 		- whether or not <tt>fgl::debug::output::enabled</tt> is <tt>true</tt>
 		- whether or not the channel's <tt>enabled()</tt> state is
 			<tt>true</tt>
@@ -473,12 +750,27 @@ class output final
 	template <output_channel T_channel>
 	static bool can_send() noexcept
 	{
-		return
-			enabled
-			&& T_channel::enabled()
-			&& priority_threshold <= T_channel::priority_level();
+		if constexpr (!compiled_in<T_channel>())
+			return false;
+		else
+			return
+				enabled
+				&& T_channel::enabled()
+				&& priority_threshold <= T_channel::priority_level();
 	}
 
+	/**
+	@returns <tt>false</tt> if the channel was removed at compile-time,
+		because its initial priority is below
+		<tt>@ref fgl::debug::priority_floor</tt>, or because
+		<tt>@ref fgl::debug::channel_compiled_in</tt> is <tt>false</tt> for
+		it. Output on a removed channel compiles to nothing.
+	@tparam T_channel the channel being checked
+	*/
+	template <output_channel T_channel>
+	[[nodiscard]] static consteval bool compiled_in() noexcept
+	{ return internal::compiled_in<T_channel>(priority_floor); }
+
 	///@{ @name Output Stream Accessor
 
 	using optional_stream_t =
@@ -488,13 +780,18 @@ class output final
 	@brief Requests direct stream access for a given channel. Access is
 		granted and the output stream is returned if the channel
 		<tt>@ref can_send()<tt>
+	@note In asynchronous mode, queued output is written before access is
+		granted, and other threads mustn't send output until the stream is no
+		longer being accessed directly.
 	*/
 	template <output_channel T_channel>
 	[[nodiscard]] static optional_stream_t channel_stream()
 	{
-		return (can_send<T_channel>())
-			? std::make_optional(std::ref(stream()))
-			: std::nullopt;
+		if (!can_send<T_channel>())
+			return std::nullopt;
+		if (async_writer* const writer{ async.writer() })
+			writer->flush();
+		return std::make_optional(std::ref(stream()));
 	}
 	///@} Output Stream Accessor
 
@@ -522,14 +819,34 @@ class output final
 		fgl::debug::output_channel T_channel,
 		fgl::debug::output_formatter<T> T_formatter
 	>
-	static void custom(const T& t)
+	static void custom([[maybe_unused]] const T& t)
 	{
-		if (const auto& os{ channel_stream<T_channel>() }; os)
+		if constexpr (compiled_in<T_channel>())
 		{
-			os.value().get()
-				<< format_head(T_channel::name())
-				<< T_formatter::format(t)
-				<< '\n';
+			if (!can_send<T_channel>())
+				return;
+			const priority level{ T_channel::priority_level() };
+			if (!has_destination(level))
+				return;
+			if (async_writer* const writer{ async.writer() })
+			{
+				std::string line{ format_head(T_channel::name()) };
+				line += T_formatter::format(t);
+				line += '\n';
+				if (sinks.empty())
+					writer->push(stream(), std::move(line));
+				else
+					writer->push(sinks_t::m_sinks, level, std::move(line));
+			}
+			else
+			{
+				internal::line_buffer buffer;
+				std::string& line{ buffer.get() };
+				line += format_head(T_channel::name());
+				line += T_formatter::format(t);
+				line += '\n';
+				write_line(level, line);
+			}
 		}
 	}
 
@@ -557,12 +874,176 @@ class output final
 	void operator()(const T& t) const
 	{ handled<T, output_config<T>>(t); }
 
+	/**
+	@brief Sends a message whose arguments are formatted later.
+	@details In asynchronous mode, the arguments are captured as bytes in
+		the queued record, and the message is formatted by the writer
+		thread, so the sending thread only copies them. Otherwise, the
+		message is formatted and written immediately.
+		@code
+		fgl::debug::output::deferred<my_channel, "{} of {} done">(i, n);
+		@endcode
+	@tparam T_channel the <tt>@ref fgl::debug::output_channel</tt> on which to
+		send output
+	@tparam T_format the format string of a
+		<tt>@ref fgl::debug::deferred_message</tt>
+	@param[in] args Trivially copyable arguments which satisfy
+		<tt>@ref fgl::debug::deferred_formattable</tt>. Arguments which
+		exceed <tt>@ref async_writer::payload_capacity</tt> bytes in total
+		are formatted immediately.
+	@note The channel's name and <tt>@ref format_head</tt> are read by the
+		thread which formats the message.
+	*/
+	template
+	<
+		fgl::debug::output_channel T_channel,
+		fgl::string_literal T_format,
+		deferred_formattable ... T_args
+	>
+	static void deferred([[maybe_unused]] const T_args&... args)
+	{
+		using message_t = deferred_message<T_format, T_args...>;
+		if constexpr (compiled_in<T_channel>())
+		{
+			if (!can_send<T_channel>())
+				return;
+			const priority level{ T_channel::priority_level() };
+			if (!has_destination(level))
+				return;
+			constexpr auto format{ format_deferred<T_channel, message_t> };
+			constexpr bool capturable{
+				message_t::payload_size <= async_writer::payload_capacity
+			};
+			if constexpr (capturable)
+			{
+				if (async_writer* const writer{ async.writer() })
+				{
+					const auto capture{
+						[&args...](std::byte* const payload) noexcept
+						{ message_t::capture(payload, args...); }
+					};
+					if (sinks.empty())
+						writer->push_deferred(stream(), format, capture);
+					else
+						writer->push_deferred(
+							sinks_t::m_sinks, level, format, capture
+						);
+					return;
+				}
+			}
+			std::array<std::byte, message_t::payload_size> payload;
+			message_t::capture(payload.data(), args...);
+			if (async_writer* const writer{ async.writer() })
+			{
+				std::string line;
+				format(payload.data(), line);
+				if (sinks.empty())
+					writer->push(stream(), std::move(line));
+				else
+					writer->push(sinks_t::m_sinks, level, std::move(line));
+			}
+			else
+			{
+				internal::line_buffer buffer;
+				format(payload.data(), buffer.get());
+				write_line(level, buffer.get());
+			}
+		}
+	}
+
 	///@} Output Stream Senders
+
+	private:
+	/// @returns <tt>false</tt> if output of @p level wouldn't be written
+	[[nodiscard]] static bool has_destination(const priority level) noexcept
+	{
+		return sinks.empty()
+			|| internal::any_accepts(sinks_t::m_sinks, level);
+	}
+
+	/// Writes a formatted line to the sinks, or to the output stream
+	static void write_line(const priority level, const std::string_view line)
+	{
+		if (sinks.empty())
+			stream.write_line(line);
+		else
+			internal::write_to_sinks(sinks_t::m_sinks, { level, line });
+	}
+
+	/// Appends a line of output to @p out, formatted from a captured message
+	template <output_channel T_channel, typename T_message>
+	static void format_deferred(
+		const std::byte* const payload,
+		std::string& out)
+	{
+		out += format_head(T_channel::name());
+		T_message::format(payload, out);
+		out += '\n';
+	}
 };
 
 /// For access and configuration of the libFGL debug output stream
 [[maybe_unused]] static inline output output;
 
+/**
+@{ @name Output Macros
+@brief Send output without evaluating its arguments unless the channel
+	<tt>@ref fgl::debug::output::can_send()</tt>, and without any code at
+	all if the channel was removed at compile-time.
+@note Channel types which contain commas must be given an alias.
+*/
+
+#ifndef FGL_DEBUG_OUTPUT_ON
+	/**
+	@brief Evaluates @p statement only if @p channel can send output, and
+		compiles to nothing if @p channel was removed at compile-time.
+	@see <tt>@ref fgl::debug::output::compiled_in()</tt>
+	*/
+	#define FGL_DEBUG_OUTPUT_ON(channel, statement) \
+		do { \
+			if constexpr (fgl::debug::output::compiled_in<channel>()) \
+				if (fgl::debug::output::can_send<channel>()) \
+					statement; \
+		} while (false)
+#else
+	#error FGL_DEBUG_OUTPUT_ON already defined
+#endif // ifndef FGL_DEBUG_OUTPUT_ON
+
+#ifndef FGL_DEBUG_OUTPUT
+	/**
+	@brief Sends the value of an expression with
+		<tt>@ref fgl::debug::output::operator()()</tt> on the channel of its
+		<tt>@ref fgl::debug::output_config</tt>.
+	@note Variadic so that the expression may contain commas.
+	*/
+	#define FGL_DEBUG_OUTPUT(...) \
+		FGL_DEBUG_OUTPUT_ON( \
+			fgl::debug::output_config< \
+				std::remove_cvref_t<decltype(__VA_ARGS__)> \
+			>, \
+			fgl::debug::output(__VA_ARGS__) \
+		)
+#else
+	#error FGL_DEBUG_OUTPUT already defined
+#endif // ifndef FGL_DEBUG_OUTPUT
+
+#ifndef FGL_DEBUG_OUTPUT_DEFERRED
+	/**
+	@brief Sends a message with
+		<tt>@ref fgl::debug::output::deferred()</tt> on @p channel, whose
+		arguments follow @p format.
+	*/
+	#define FGL_DEBUG_OUTPUT_DEFERRED(channel, format, ...) \
+		FGL_DEBUG_OUTPUT_ON( \
+			channel, \
+			(fgl::debug::output::deferred<channel, format>(__VA_ARGS__)) \
+		)
+#else
+	#error FGL_DEBUG_OUTPUT_DEFERRED already defined
+#endif // ifndef FGL_DEBUG_OUTPUT_DEFERRED
+
+///@} Output Macros
+
 ///@} end of group debug_output
 } // namespace fgl::debug
 
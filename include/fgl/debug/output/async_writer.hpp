@@ -0,0 +1,488 @@
+#pragma once
+#ifndef FGL_DEBUG_OUTPUT_ASYNC_WRITER_HPP_INCLUDED
+#define FGL_DEBUG_OUTPUT_ASYNC_WRITER_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t, byte
+#include <cstdint> // uint64_t
+#include <algorithm> // find, max
+#include <array>
+#include <atomic>
+#include <bit> // bit_ceil
+#include <iterator> // ssize
+#include <memory> // unique_ptr
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility> // move, exchange
+#include <vector>
+
+#include "../../_experimental/environment/hardware.hpp"
+#include "./priority.hpp"
+#include "./sink.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-output
+@{
+*/
+
+/// What a producer does when the asynchronous output queue is full
+enum class backpressure : unsigned char
+{
+	/// Waits until the writer thread has made room
+	block,
+
+	/// Discards the new record
+	drop,
+
+	/// Discards the oldest queued record to make room for the new one
+	drop_oldest
+};
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/**
+@brief A bounded lock-free queue for any number of producers and consumers.
+@details Each cell carries a sequence number which tells a producer or a
+	consumer whether the cell is ready for it, so neither ever waits on a
+	lock, and producers only contend with one another on the position at
+	which they claim a cell.
+@tparam T A default constructible and move assignable type
+*/
+template <typename T>
+class bounded_mpmc_queue final
+{
+	struct alignas(fgl::hardware::dis) cell
+	{
+		std::atomic<std::size_t> sequence{};
+		T value{};
+	};
+
+	std::unique_ptr<cell[]> m_cells;
+	std::size_t m_mask;
+	alignas(fgl::hardware::dis) std::atomic<std::size_t> m_push_position{};
+	alignas(fgl::hardware::dis) std::atomic<std::size_t> m_pop_position{};
+
+	public:
+	/// @param capacity Rounded up to a power of two
+	[[nodiscard]] explicit bounded_mpmc_queue(const std::size_t capacity)
+	:
+		m_cells(new cell[std::bit_ceil(std::max(capacity, std::size_t{ 2 }))]),
+		m_mask(std::bit_ceil(std::max(capacity, std::size_t{ 2 })) - 1)
+	{
+		for (std::size_t i{}; i <= m_mask; ++i)
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	bounded_mpmc_queue(const bounded_mpmc_queue&) = delete;
+	bounded_mpmc_queue& operator=(const bounded_mpmc_queue&) = delete;
+
+	/// @returns The maximum number of queued values
+	[[nodiscard]] std::size_t capacity() const noexcept
+	{ return m_mask + 1; }
+
+	/// @returns <tt>false</tt> if the queue is full, leaving @p value intact
+	[[nodiscard]] bool try_push(T& value) noexcept
+	{
+		std::size_t position{
+			m_push_position.load(std::memory_order_relaxed)
+		};
+		for (;;)
+		{
+			cell& c{ m_cells[position & m_mask] };
+			const std::size_t sequence{
+				c.sequence.load(std::memory_order_acquire)
+			};
+			if (sequence == position)
+			{
+				if (m_push_position.compare_exchange_weak(
+					position, position + 1, std::memory_order_relaxed))
+				{
+					c.value = std::move(value);
+					c.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (sequence < position)
+				return false; // the cell hasn't been popped since last lap
+			else
+				position = m_push_position.load(std::memory_order_relaxed);
+		}
+	}
+
+	/// @returns <tt>false</tt> if the queue is empty
+	[[nodiscard]] bool try_pop(T& value) noexcept
+	{
+		std::size_t position{ m_pop_position.load(std::memory_order_relaxed) };
+		for (;;)
+		{
+			cell& c{ m_cells[position & m_mask] };
+			const std::size_t sequence{
+				c.sequence.load(std::memory_order_acquire)
+			};
+			if (sequence == position + 1)
+			{
+				if (m_pop_position.compare_exchange_weak(
+					position, position + 1, std::memory_order_relaxed))
+				{
+					value = std::move(c.value);
+					c.sequence.store(
+						position + m_mask + 1,
+						std::memory_order_release
+					);
+					return true;
+				}
+			}
+			else if (sequence < position + 1)
+				return false; // the cell hasn't been pushed yet
+			else
+				position = m_pop_position.load(std::memory_order_relaxed);
+		}
+	}
+};
+
+} // namespace internal
+///@endcond
+
+/**
+@brief Writes formatted output to its streams on a background thread.
+@details Producers enqueue records into a bounded lock-free queue, so they
+	only pay for formatting and a few atomic operations. The writer thread
+	drains the queue in batches, and flushes the streams it wrote to
+	whenever the queue is empty, or when <tt>@ref flush()</tt> is called.
+
+	Records remember the stream they're for, so redirecting the output
+	stream only affects records which are enqueued afterwards. Once the
+	writer owns the streams, they mustn't be written to directly by any
+	other thread until the writer is destroyed.
+
+	Every enqueued record is written before the destructor returns.
+	Exceptions thrown by a stream are ignored, as there's nobody to report
+	them to.
+@see <tt>@ref fgl::debug::output::async</tt>, which owns the writer used by
+	@ref group-debug-output.
+*/
+class async_writer final
+{
+	public:
+	/// The most bytes of arguments which a deferred record can capture
+	static constexpr std::size_t payload_capacity{ 64 };
+
+	/// Appends the line formatted from a payload to a string
+	using format_function_t = void (*)(const std::byte*, std::string&);
+
+	/**
+	@brief A line of output, and the stream or sinks to which it's written
+	@details The line is either already formatted as <tt>text</tt>, or is
+		formatted by the writer thread, by calling <tt>format</tt> with the
+		captured <tt>payload</tt>. A record with neither a stream nor sinks
+		is a flush request.
+	*/
+	struct record
+	{
+		std::ostream* stream{};
+		std::string text{};
+		format_function_t format{};
+		std::array<std::byte, payload_capacity> payload{};
+
+		/// If not <tt>nullptr</tt>, the line is written to these sinks
+		/// instead of a stream
+		const internal::sink_list* sinks{};
+
+		/// The priority with which the line is written to sinks
+		priority level{};
+
+		[[nodiscard]] bool is_flush_request() const noexcept
+		{ return stream == nullptr && sinks == nullptr; }
+	};
+
+	private:
+	internal::bounded_mpmc_queue<record> m_queue;
+	const backpressure m_policy;
+	std::atomic<std::uint32_t> m_signal{};
+	std::atomic<bool> m_stopping{ false };
+	std::atomic<std::size_t> m_dropped{};
+	std::atomic<std::uint64_t> m_flush_tickets{};
+	std::atomic<std::uint64_t> m_flushed{};
+	std::thread m_thread;
+
+	/// Wakes the writer thread, if it's waiting
+	void signal() noexcept
+	{
+		m_signal.fetch_add(1, std::memory_order_release);
+		m_signal.notify_one();
+	}
+
+	/// Enqueues @p r regardless of the policy, waiting for room if needed
+	void push_blocking(record& r) noexcept
+	{
+		while (!m_queue.try_push(r))
+		{
+			signal();
+			std::this_thread::yield();
+		}
+	}
+
+	void run() noexcept
+	{
+		std::vector<std::ostream*> written;
+		std::vector<record> batch;
+		std::string line; // reused for every deferred record
+		batch.reserve(256);
+		const auto flush_written{
+			[&written]() noexcept
+			{
+				for (std::ostream* const os : written)
+				{
+					try { os->flush(); }
+					catch (...) {} // output is best-effort on this thread
+				}
+				written.clear();
+			}
+		};
+		for (;;)
+		{
+			const std::uint32_t seen{
+				m_signal.load(std::memory_order_acquire)
+			};
+			const bool stopping{ m_stopping.load(std::memory_order_acquire) };
+			record r;
+			while (batch.size() < batch.capacity() && m_queue.try_pop(r))
+				batch.push_back(std::move(r));
+			std::uint64_t flushes{};
+			for (const record& b : batch)
+			{
+				if (b.is_flush_request())
+				{
+					flush_written();
+					++flushes;
+					continue;
+				}
+				try
+				{
+					std::string_view text{ b.text };
+					if (b.format != nullptr)
+					{
+						line.clear();
+						b.format(b.payload.data(), line);
+						text = line;
+					}
+					if (b.sinks != nullptr)
+						internal::write_to_sinks(*b.sinks, { b.level, text });
+					else
+					{
+						if (std::ranges::find(written, b.stream)
+							== written.end())
+							written.push_back(b.stream);
+						b.stream->write(text.data(), std::ssize(text));
+					}
+				}
+				catch (...) {} // output is best-effort on this thread
+			}
+			const bool drained{ batch.size() < batch.capacity() };
+			batch.clear();
+			if (drained)
+				flush_written();
+			if (flushes != 0)
+			{
+				m_flushed.fetch_add(flushes, std::memory_order_release);
+				m_flushed.notify_all();
+			}
+			if (!drained)
+				continue;
+			if (stopping)
+				return;
+			m_signal.wait(seen, std::memory_order_acquire);
+		}
+	}
+
+	public:
+	/**
+	@brief Starts the writer thread.
+	@param capacity The maximum number of queued records, rounded up to a
+		power of two.
+	@param policy What <tt>@ref push()</tt> does if the queue is full.
+	*/
+	[[nodiscard]] explicit async_writer(
+		const std::size_t capacity,
+		const backpressure policy = backpressure::block)
+	:
+		m_queue(capacity),
+		m_policy(policy),
+		m_thread([this]() noexcept { run(); })
+	{}
+
+	async_writer(const async_writer&) = delete;
+	async_writer& operator=(const async_writer&) = delete;
+
+	/// Writes every queued record, and then stops the writer thread
+	~async_writer()
+	{
+		m_stopping.store(true, std::memory_order_release);
+		signal();
+		m_thread.join();
+	}
+
+	/**
+	@brief Enqueues @p text to be written to @p os, subject to the
+		backpressure policy if the queue is full.
+	@returns <tt>false</tt> if the record was discarded
+	*/
+	bool push(std::ostream& os, std::string&& text) noexcept
+	{
+		record r{ &os, std::move(text), nullptr, {} };
+		return push(r);
+	}
+
+	/**
+	@brief Enqueues @p text to be written to each of @p sinks which accepts
+		@p level, subject to the backpressure policy if the queue is full.
+	@param sinks The sinks, which mustn't change until the record is written
+	@returns <tt>false</tt> if the record was discarded
+	*/
+	bool push(
+		const internal::sink_list& sinks,
+		const priority level,
+		std::string&& text) noexcept
+	{
+		record r{ nullptr, std::move(text), nullptr, {}, &sinks, level };
+		return push(r);
+	}
+
+	/**
+	@brief Enqueues a record whose line is formatted by the writer thread,
+		subject to the backpressure policy if the queue is full.
+	@param os The stream to which the line is written
+	@param format Appends the line formatted from the payload to a string.
+		It's called by the writer thread.
+	@param capture Copies up to <tt>@ref payload_capacity</tt> bytes to the
+		payload which is passed to @p format.
+	@returns <tt>false</tt> if the record was discarded
+	*/
+	bool push_deferred(
+		std::ostream& os,
+		const format_function_t format,
+		const auto& capture) noexcept
+	{
+		record r{ &os, {}, format, {} };
+		capture(r.payload.data());
+		return push(r);
+	}
+
+	/**
+	@brief Enqueues a record whose line is formatted by the writer thread,
+		and written to each of @p sinks which accepts @p level.
+	@see The other overload of <tt>@ref push_deferred()</tt>
+	*/
+	bool push_deferred(
+		const internal::sink_list& sinks,
+		const priority level,
+		const format_function_t format,
+		const auto& capture) noexcept
+	{
+		record r{ nullptr, {}, format, {}, &sinks, level };
+		capture(r.payload.data());
+		return push(r);
+	}
+
+	/**
+	@brief Enqueues @p r, subject to the backpressure policy if the queue is
+		full.
+	@returns <tt>false</tt> if the record was discarded
+	*/
+	bool push(record& r) noexcept
+	{
+		if (!m_queue.try_push(r))
+		{
+			switch (m_policy)
+			{
+			break; case backpressure::block:
+				push_blocking(r);
+			break; case backpressure::drop:
+				m_dropped.fetch_add(1, std::memory_order_relaxed);
+				signal();
+				return false;
+			break; case backpressure::drop_oldest:
+				for (record oldest; !m_queue.try_push(r);)
+				{
+					if (!m_queue.try_pop(oldest))
+						continue;
+					if (oldest.is_flush_request())
+						push_blocking(oldest); // never discard a flush
+					else
+						m_dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+			break; default:
+				return false;
+			}
+		}
+		signal();
+		return true;
+	}
+
+	/**
+	@brief Waits until every record which this thread enqueued, and which
+		wasn't discarded, has been written and its stream flushed.
+	@note Must not be called by the writer thread, such as from a stream.
+	*/
+	void flush() noexcept
+	{
+		const std::uint64_t ticket{
+			m_flush_tickets.fetch_add(1, std::memory_order_relaxed) + 1
+		};
+		record request{};
+		push_blocking(request);
+		signal();
+		for (;;)
+		{
+			const std::uint64_t flushed{
+				m_flushed.load(std::memory_order_acquire)
+			};
+			if (flushed >= ticket)
+				return;
+			m_flushed.wait(flushed, std::memory_order_acquire);
+		}
+	}
+
+	/// @returns The number of records discarded by the backpressure policy
+	[[nodiscard]] std::size_t dropped() const noexcept
+	{ return m_dropped.load(std::memory_order_relaxed); }
+
+	/// @returns The maximum number of queued records
+	[[nodiscard]] std::size_t capacity() const noexcept
+	{ return m_queue.capacity(); }
+
+	/// @returns The backpressure policy
+	[[nodiscard]] backpressure policy() const noexcept
+	{ return m_policy; }
+};
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/// Destroys the writer, writing all queued output, if it's still enabled
+/// when static objects are destroyed
+struct async_writer_slot final
+{
+	std::atomic<async_writer*> writer{ nullptr };
+
+	constexpr async_writer_slot() noexcept = default;
+	async_writer_slot(const async_writer_slot&) = delete;
+	async_writer_slot& operator=(const async_writer_slot&) = delete;
+
+	~async_writer_slot()
+	{ std::unique_ptr<async_writer>(writer.exchange(nullptr)).reset(); }
+};
+
+} // namespace internal
+///@endcond
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_OUTPUT_ASYNC_WRITER_HPP_INCLUDED
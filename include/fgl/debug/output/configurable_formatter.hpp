@@ -0,0 +1,106 @@
+#pragma once
+#ifndef FGL_DEBUG_OUTPUT_CONFIGURABLE_FORMATTER_HPP_INCLUDED
+#define FGL_DEBUG_OUTPUT_CONFIGURABLE_FORMATTER_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <concepts> // default_initializable
+#include <type_traits> // is_empty_v, is_invocable_r_v
+#include <utility> // forward
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-output
+@{
+*/
+
+/**
+@brief A formatter which can be replaced at run-time, and which calls its
+	default formatter directly unless it's replaced.
+@details Unlike a <tt>std::function</tt>, a replacement is a function
+	pointer, or a stateless function object such as a lambda without
+	captures, so calling it never allocates. Until a formatter is replaced,
+	or after it's <tt>@ref reset()</tt>, its default is called by a direct
+	call which the compiler can inline.
+	@code
+	fgl::debug::output::format_head =
+		[](std::string_view name) { return std::string(name) + ": "; };
+	@endcode
+@tparam T_default The default formatter, a function
+@note Like every other configuration of @ref group-debug-output, replacing a
+	formatter mustn't happen while other threads send output.
+*/
+template <auto T_default>
+class configurable_formatter;
+
+template
+<
+	typename T_result,
+	typename ... T_args,
+	T_result (*T_default)(T_args...)
+>
+class configurable_formatter<T_default> final
+{
+	public:
+	/// The type of a replacement formatter
+	using function_t = T_result (*)(T_args...);
+
+	private:
+	/// The replacement, or <tt>nullptr</tt> for the default
+	function_t m_function{ nullptr };
+
+	public:
+	constexpr configurable_formatter() noexcept = default;
+
+	/// Replaces the formatter with @p function
+	constexpr configurable_formatter& operator=(const function_t function)
+	noexcept
+	{
+		m_function = (function == T_default) ? nullptr : function;
+		return *this;
+	}
+
+	/**
+	@brief Replaces the formatter with a stateless function object, such as
+		a lambda without captures, whose result is converted to the
+		formatter's result.
+	*/
+	template <typename T_function>
+	requires (
+		std::is_empty_v<T_function>
+		&& std::default_initializable<T_function>
+		&& std::is_invocable_r_v<T_result, const T_function&, T_args...>
+	)
+	constexpr configurable_formatter& operator=(const T_function&) noexcept
+	{
+		m_function = [](T_args... args) -> T_result
+		{ return T_function{}(std::forward<T_args>(args)...); };
+		return *this;
+	}
+
+	/// Restores the default formatter
+	constexpr void reset() noexcept
+	{ m_function = nullptr; }
+
+	/// @returns <tt>true</tt> if the formatter hasn't been replaced
+	[[nodiscard]] constexpr bool is_default() const noexcept
+	{ return m_function == nullptr; }
+
+	/// @returns The current formatter
+	[[nodiscard]] constexpr function_t get() const noexcept
+	{ return is_default() ? T_default : m_function; }
+
+	/// Calls the current formatter
+	constexpr T_result operator()(T_args... args) const
+	{
+		if (is_default())
+			return T_default(std::forward<T_args>(args)...);
+		return m_function(std::forward<T_args>(args)...);
+	}
+};
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_OUTPUT_CONFIGURABLE_FORMATTER_HPP_INCLUDED
@@ -0,0 +1,253 @@
+#pragma once
+#ifndef FGL_DEBUG_OUTPUT_DEFERRED_HPP_INCLUDED
+#define FGL_DEBUG_OUTPUT_DEFERRED_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t, byte
+#include <cstdint> // uintptr_t
+#include <array>
+#include <bit> // bit_cast
+#include <charconv> // to_chars
+#include <concepts> // same_as, integral, floating_point
+#include <cstring> // memcpy
+#include <string>
+#include <string_view>
+#include <type_traits> // is_trivially_copyable_v, is_enum_v, underlying_type_t
+
+#include "../../types/string_literal.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-output
+@{
+*/
+
+/**
+@brief Formats a captured argument of a deferred message.
+@details Specializations must provide a static <tt>format(const T&,
+	std::string&)</tt> which appends the representation of the value.
+	Specializations are provided for arithmetic types, enumerations, and
+	pointers, which are formatted as their address.
+@tparam T A trivially copyable type
+*/
+template <typename T>
+struct deferred_formatter;
+
+/**
+@brief A type which can be captured by a deferred message: it's trivially
+	copyable, so it's captured by copying its bytes, and it has a
+	<tt>@ref fgl::debug::deferred_formatter</tt>.
+*/
+template <typename T>
+concept deferred_formattable =
+	std::is_trivially_copyable_v<T>
+	&& requires (const T& t, std::string& out)
+	{
+		{ deferred_formatter<T>::format(t, out) } -> std::same_as<void>;
+	};
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/// Appends @p value to @p out with <tt>std::to_chars</tt>
+template <typename T>
+void append_to_chars(std::string& out, const T value, const auto... options)
+{
+	std::array<char, 64> buffer;
+	const auto [end, error]{
+		std::to_chars(buffer.data(), buffer.data() + buffer.size(), value,
+			options...)
+	};
+	out.append(buffer.data(), end);
+}
+
+} // namespace internal
+///@endcond
+
+/// Formats <tt>bool</tt> as <tt>true</tt> or <tt>false</tt>
+template <>
+struct deferred_formatter<bool>
+{
+	static void format(const bool value, std::string& out)
+	{ out += value ? "true" : "false"; }
+};
+
+/// Formats <tt>char</tt> as a character
+template <>
+struct deferred_formatter<char>
+{
+	static void format(const char value, std::string& out)
+	{ out += value; }
+};
+
+/// Formats integers in decimal
+template <std::integral T>
+struct deferred_formatter<T>
+{
+	static void format(const T value, std::string& out)
+	{ internal::append_to_chars(out, value); }
+};
+
+/// Formats floating-point values in their shortest exact representation
+template <std::floating_point T>
+struct deferred_formatter<T>
+{
+	static void format(const T value, std::string& out)
+	{ internal::append_to_chars(out, value); }
+};
+
+/// Formats enumerations as their underlying value
+template <typename T>
+requires std::is_enum_v<T>
+struct deferred_formatter<T>
+{
+	static void format(const T value, std::string& out)
+	{
+		internal::append_to_chars(
+			out,
+			static_cast<std::underlying_type_t<T>>(value)
+		);
+	}
+};
+
+/**
+@brief Formats pointers as their address in hexadecimal.
+@note The pointed-to object isn't read, because it may no longer exist when
+	the message is formatted. To include a string, capture its contents in a
+	trivially copyable type with its own formatter.
+*/
+template <typename T>
+struct deferred_formatter<T*>
+{
+	static void format(const T* const value, std::string& out)
+	{
+		out += "0x";
+		internal::append_to_chars(
+			out,
+			reinterpret_cast<std::uintptr_t>(value),
+			16
+		);
+	}
+};
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/**
+@returns The number of <tt>{}</tt> placeholders in @p format, or
+	<tt>-1</tt> if it has an unmatched brace. Literal braces are written as
+	<tt>{{</tt> and <tt>}}</tt>.
+*/
+[[nodiscard]] constexpr int count_placeholders(const std::string_view format)
+noexcept
+{
+	int count{};
+	for (std::size_t i{}; i < format.size(); ++i)
+	{
+		const char c{ format[i] };
+		if (c != '{' && c != '}')
+			continue;
+		if (i + 1 == format.size())
+			return -1;
+		const char next{ format[i + 1] };
+		if (c == '{' && next == '}')
+			++count;
+		else if (c != next)
+			return -1;
+		++i;
+	}
+	return count;
+}
+
+/// Formats the captured argument of type @p T at @p p
+template <typename T>
+void format_captured(const std::byte* const p, std::string& out)
+{
+	std::array<std::byte, sizeof(T)> bytes;
+	std::memcpy(bytes.data(), p, sizeof(T));
+	deferred_formatter<T>::format(std::bit_cast<T>(bytes), out);
+}
+
+} // namespace internal
+///@endcond
+
+/**
+@brief A message whose arguments are captured as bytes and formatted later.
+@details Capturing a message copies its arguments' bytes, which is far
+	cheaper than formatting them. The static format string and the types of
+	the arguments are part of the message's type, so the captured bytes are
+	all that's needed to format the message later, on another thread.
+@tparam T_format The format string, in which each <tt>{}</tt> is replaced
+	by the next argument, and <tt>{{</tt> and <tt>}}</tt> are literal braces.
+@tparam T_args The types of the arguments
+*/
+template <fgl::string_literal T_format, deferred_formattable ... T_args>
+struct deferred_message final
+{
+	static_assert(
+		internal::count_placeholders(T_format) == sizeof...(T_args),
+		"The number of placeholders in a deferred message's format string "
+		"must match the number of arguments, and braces must be escaped."
+	);
+
+	/// The number of bytes which the captured arguments occupy
+	static constexpr std::size_t payload_size{ (sizeof(T_args) + ... + 0) };
+
+	private:
+	/// The position of every argument in the payload
+	static constexpr std::array<std::size_t, sizeof...(T_args)> offsets{
+		[]()
+		{
+			std::array<std::size_t, sizeof...(T_args)> result{};
+			std::size_t offset{};
+			std::size_t i{};
+			((result[i++] = offset, offset += sizeof(T_args)), ...);
+			return result;
+		}()
+	};
+
+	using format_captured_t = void (*)(const std::byte*, std::string&);
+
+	static constexpr std::array<format_captured_t, sizeof...(T_args)>
+		formatters{ internal::format_captured<T_args>... };
+
+	public:
+	/// Copies the bytes of @p args to @p payload
+	static void capture(std::byte* payload, const T_args&... args) noexcept
+	{
+		((std::memcpy(payload, &args, sizeof(T_args)),
+			payload += sizeof(T_args)), ...);
+	}
+
+	/// Appends the message formatted from the captured @p payload to @p out
+	static void format(const std::byte* const payload, std::string& out)
+	{
+		const std::string_view fmt{ T_format };
+		[[maybe_unused]] std::size_t argument{};
+		for (std::size_t i{}; i < fmt.size(); ++i)
+		{
+			const char c{ fmt[i] };
+			// without arguments, only escaped braces can appear
+			if constexpr (sizeof...(T_args) != 0)
+			{
+				if (c == '{' && fmt[i + 1] == '}')
+				{
+					formatters[argument](payload + offsets[argument], out);
+					++argument;
+					++i;
+					continue;
+				}
+			}
+			out += c;
+			if (c == '{' || c == '}')
+				++i; // an escaped brace
+		}
+	}
+};
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_OUTPUT_DEFERRED_HPP_INCLUDED
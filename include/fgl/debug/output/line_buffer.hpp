@@ -0,0 +1,85 @@
+#pragma once
+#ifndef FGL_DEBUG_OUTPUT_LINE_BUFFER_HPP_INCLUDED
+#define FGL_DEBUG_OUTPUT_LINE_BUFFER_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <string>
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-output
+*/
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/**
+@brief A thread's buffer in which a line of output is formatted before it's
+	written to the output stream as a whole.
+@details Each thread reuses its own buffer, so formatting neither allocates
+	once the buffer has grown nor involves any other thread. If a formatter
+	sends output while its thread's buffer is in use, the nested line is
+	formatted in a temporary buffer instead.
+*/
+class line_buffer final
+{
+	/// Buffers which grow beyond this are released when they're returned
+	static constexpr std::size_t max_retained_capacity{ 1 << 16 };
+
+	std::string m_temporary{};
+	std::string& m_line;
+
+	[[nodiscard]] static std::string& thread_buffer() noexcept
+	{
+		thread_local std::string buffer;
+		return buffer;
+	}
+
+	[[nodiscard]] static bool& thread_buffer_in_use() noexcept
+	{
+		thread_local bool in_use{ false };
+		return in_use;
+	}
+
+	[[nodiscard]] bool owns_thread_buffer() const noexcept
+	{ return &m_line != &m_temporary; }
+
+	public:
+	/// Takes the thread's buffer, emptied, if it isn't already in use
+	[[nodiscard]] line_buffer() noexcept
+	: m_line(thread_buffer_in_use() ? m_temporary : thread_buffer())
+	{
+		if (owns_thread_buffer())
+		{
+			thread_buffer_in_use() = true;
+			m_line.clear();
+		}
+	}
+
+	line_buffer(const line_buffer&) = delete;
+	line_buffer& operator=(const line_buffer&) = delete;
+
+	/// Returns the thread's buffer
+	~line_buffer()
+	{
+		if (!owns_thread_buffer())
+			return;
+		if (m_line.capacity() > max_retained_capacity)
+			std::string().swap(m_line);
+		thread_buffer_in_use() = false;
+	}
+
+	/// @returns The buffer
+	[[nodiscard]] std::string& get() noexcept
+	{ return m_line; }
+};
+
+} // namespace internal
+///@endcond
+
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_OUTPUT_LINE_BUFFER_HPP_INCLUDED
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef FGL_DEBUG_OUTPUT_PRIORITY_HPP_INCLUDED
+#define FGL_DEBUG_OUTPUT_PRIORITY_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-output
+@{
+*/
+
+/**
+@brief Output channel priority levels which are compared to
+	<tt>@ref fgl::debug::output::priority_threshold</tt>, and to the
+	threshold of each <tt>@ref fgl::debug::output_sink</tt>
+*/
+enum class priority : unsigned char
+{
+	minimum,
+	debug,
+	info,
+	message,
+	event,
+	warning,
+	error,
+	fatal,
+	maximum
+};
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_OUTPUT_PRIORITY_HPP_INCLUDED
@@ -0,0 +1,346 @@
+#pragma once
+#ifndef FGL_DEBUG_OUTPUT_SINK_HPP_INCLUDED
+#define FGL_DEBUG_OUTPUT_SINK_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <algorithm> // min
+#include <atomic>
+#include <filesystem> // path
+#include <fstream> // ofstream
+#include <iterator> // ssize
+#include <memory> // shared_ptr, unique_ptr
+#include <mutex>
+#include <ostream>
+#include <stdexcept> // runtime_error
+#include <string>
+#include <string_view>
+#include <utility> // move
+#include <vector>
+
+#include "./priority.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-output
+@{
+*/
+
+/// A line of output as it's delivered to every sink
+struct output_record
+{
+	/// The priority of the channel which sent the output
+	priority level;
+
+	/// The formatted line, including the channel's head and the newline
+	std::string_view line;
+};
+
+/**
+@brief A destination of output, which has its own priority threshold.
+@details Sinks are registered with
+	<tt>@ref fgl::debug::output::sinks</tt>. Every line of output is
+	formatted once, and then written to each sink whose threshold its
+	priority meets. Sinks are written to by every thread which sends output
+	(or by the asynchronous writer thread), so <tt>write()</tt> and
+	<tt>flush()</tt> must be thread-safe.
+*/
+class output_sink
+{
+	std::atomic<priority> m_threshold;
+
+	public:
+	/// @param threshold The minimum priority of the output which is written
+	[[nodiscard]] explicit output_sink(const priority threshold) noexcept
+	: m_threshold(threshold)
+	{}
+
+	output_sink(const output_sink&) = delete;
+	output_sink& operator=(const output_sink&) = delete;
+	virtual ~output_sink() = default;
+
+	/// @returns The minimum priority of the output which is written
+	[[nodiscard]] priority threshold() const noexcept
+	{ return m_threshold.load(std::memory_order_relaxed); }
+
+	/// Sets the minimum priority of the output which is written
+	void threshold(const priority threshold) noexcept
+	{ m_threshold.store(threshold, std::memory_order_relaxed); }
+
+	/// @returns <tt>true</tt> if output of priority @p level is written
+	[[nodiscard]] bool accepts(const priority level) const noexcept
+	{ return threshold() <= level; }
+
+	/// Writes, or batches, a line of output
+	virtual void write(const output_record& record) = 0;
+
+	/// Writes any batched output, and flushes the destination
+	virtual void flush() = 0;
+};
+
+/// How a <tt>@ref stream_sink</tt> batches and flushes its output
+struct sink_policy
+{
+	/**
+	@brief Lines are accumulated until there are at least this many bytes,
+		which are then written with a single <tt>write()</tt>. Zero writes
+		every line immediately.
+	*/
+	std::size_t batch_size{ 0 };
+
+	/**
+	@brief Lines of at least this priority are written immediately along
+		with the batch, and the stream is flushed.
+	*/
+	priority flush_threshold{ priority::error };
+};
+
+/**
+@brief A sink which writes to an <tt>std::ostream</tt>.
+@details A line is appended to the sink's batch under the sink's own lock,
+	and the batch is written with a single <tt>write()</tt> once it reaches
+	the policy's <tt>batch_size</tt>. Any batched output is written when the
+	sink is destroyed.
+*/
+class stream_sink : public output_sink
+{
+	public:
+	/**
+	@brief Appends a sink's own representation of a record to a string,
+		such as the line with a timestamp prefix.
+	*/
+	using line_formatter_t = void (*)(const output_record&, std::string&);
+
+	private:
+	std::mutex m_mutex{};
+	const std::unique_ptr<std::ostream> m_owned_stream{};
+	std::ostream& m_stream;
+	const sink_policy m_policy;
+	const line_formatter_t m_format;
+	std::string m_batch{};
+
+	/// Writes the batch to the stream. The lock must be held.
+	void write_batch()
+	{
+		if (m_batch.empty())
+			return;
+		m_stream.write(m_batch.data(), std::ssize(m_batch));
+		m_batch.clear();
+	}
+
+	public:
+	/**
+	@param stream The stream, which must outlive the sink
+	@param threshold The minimum priority of the output which is written
+	@param policy How the output is batched and flushed
+	@param format Produces the sink's representation of each record, or
+		<tt>nullptr</tt> to write the line as it was formatted.
+	*/
+	[[nodiscard]] explicit stream_sink(
+		std::ostream& stream,
+		const priority threshold = priority::minimum,
+		const sink_policy policy = {},
+		const line_formatter_t format = nullptr) noexcept
+	:
+		output_sink(threshold),
+		m_stream(stream),
+		m_policy(policy),
+		m_format(format)
+	{}
+
+	protected:
+	/// Constructs a sink which owns its stream
+	[[nodiscard]] stream_sink(
+		std::unique_ptr<std::ostream> stream,
+		const priority threshold,
+		const sink_policy policy) noexcept
+	:
+		output_sink(threshold),
+		m_owned_stream(std::move(stream)),
+		m_stream(*m_owned_stream),
+		m_policy(policy),
+		m_format(nullptr)
+	{}
+
+	public:
+	/// Writes any batched output
+	~stream_sink() override
+	{
+		try { flush(); }
+		catch (...) {} // a destructor mustn't throw
+	}
+
+	void write(const output_record& record) override
+	{
+		const std::scoped_lock lock(m_mutex);
+		const bool flush_now{ m_policy.flush_threshold <= record.level };
+		if (m_format == nullptr && m_policy.batch_size == 0)
+			m_stream.write(record.line.data(), std::ssize(record.line));
+		else
+		{
+			if (m_format != nullptr)
+				m_format(record, m_batch);
+			else
+				m_batch += record.line;
+			if (flush_now || m_policy.batch_size <= m_batch.size())
+				write_batch();
+		}
+		if (flush_now)
+			m_stream.flush();
+	}
+
+	void flush() override
+	{
+		const std::scoped_lock lock(m_mutex);
+		write_batch();
+		m_stream.flush();
+	}
+};
+
+/**
+@brief A sink which writes to a file which it owns.
+@details By default, output is written in batches of 64KiB, and lines of
+	<tt>priority::error</tt> or higher are written and flushed immediately.
+*/
+class file_sink final : public stream_sink
+{
+	[[nodiscard]] static std::unique_ptr<std::ostream> open(
+		const std::filesystem::path& path,
+		const bool append)
+	{
+		auto file{ std::make_unique<std::ofstream>(
+			path,
+			append ? std::ios::app : std::ios::trunc
+		) };
+		if (!*file)
+			throw std::runtime_error(
+				"fgl::debug::file_sink: couldn't open " + path.string()
+			);
+		return file;
+	}
+
+	public:
+	/// The default policy of a file sink
+	static constexpr sink_policy default_policy{ 1 << 16, priority::error };
+
+	/**
+	@param path The file, which is truncated unless @p append
+	@param threshold The minimum priority of the output which is written
+	@param policy How the output is batched and flushed
+	@param append Whether to append to an existing file
+	@throws std::runtime_error if the file couldn't be opened
+	*/
+	[[nodiscard]] explicit file_sink(
+		const std::filesystem::path& path,
+		const priority threshold = priority::minimum,
+		const sink_policy policy = default_policy,
+		const bool append = false)
+	: stream_sink(open(path, append), threshold, policy)
+	{}
+};
+
+/**
+@brief A sink which retains the most recent lines in memory, such as for a
+	crash report.
+@details The ring's strings are reused, so once every slot has held a line
+	as long as the lines it's given, writing doesn't allocate.
+*/
+class memory_ring_sink final : public output_sink
+{
+	mutable std::mutex m_mutex{};
+	std::vector<std::string> m_lines;
+	std::size_t m_next{};
+	std::size_t m_size{};
+
+	public:
+	/**
+	@param capacity The number of lines which are retained, at least one
+	@param threshold The minimum priority of the output which is written
+	*/
+	[[nodiscard]] explicit memory_ring_sink(
+		const std::size_t capacity,
+		const priority threshold = priority::minimum)
+	:
+		output_sink(threshold),
+		m_lines(std::max(capacity, std::size_t{ 1 }))
+	{}
+
+	void write(const output_record& record) override
+	{
+		const std::scoped_lock lock(m_mutex);
+		m_lines[m_next].assign(record.line);
+		m_next = (m_next + 1) % m_lines.size();
+		m_size = std::min(m_size + 1, m_lines.size());
+	}
+
+	/// Does nothing, as the lines are only kept in memory
+	void flush() override
+	{}
+
+	/// @returns The retained lines, oldest first
+	[[nodiscard]] std::vector<std::string> lines() const
+	{
+		const std::scoped_lock lock(m_mutex);
+		std::vector<std::string> result;
+		result.reserve(m_size);
+		const std::size_t first{
+			(m_next + m_lines.size() - m_size) % m_lines.size()
+		};
+		for (std::size_t i{}; i < m_size; ++i)
+			result.push_back(m_lines[(first + i) % m_lines.size()]);
+		return result;
+	}
+
+	/// @returns The number of retained lines
+	[[nodiscard]] std::size_t size() const
+	{
+		const std::scoped_lock lock(m_mutex);
+		return m_size;
+	}
+
+	/// @returns The maximum number of retained lines
+	[[nodiscard]] std::size_t capacity() const noexcept
+	{ return m_lines.size(); }
+
+	/// Discards every retained line
+	void clear()
+	{
+		const std::scoped_lock lock(m_mutex);
+		m_size = 0;
+	}
+};
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/// The registered sinks
+using sink_list = std::vector<std::shared_ptr<output_sink>>;
+
+/// @returns <tt>true</tt> if any of @p sinks accepts output of @p level
+[[nodiscard]] inline bool any_accepts(
+	const sink_list& sinks,
+	const priority level) noexcept
+{
+	for (const auto& sink : sinks)
+		if (sink->accepts(level))
+			return true;
+	return false;
+}
+
+/// Writes @p record to each of @p sinks which accepts it
+inline void write_to_sinks(const sink_list& sinks, const output_record& record)
+{
+	for (const auto& sink : sinks)
+		if (sink->accepts(record.level))
+			sink->write(record);
+}
+
+} // namespace internal
+///@endcond
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_OUTPUT_SINK_HPP_INCLUDED
@@ -0,0 +1,566 @@
+#pragma once
+#ifndef FGL_DEBUG_PROFILER_HPP_INCLUDED
+#define FGL_DEBUG_PROFILER_HPP_INCLUDED
+#include "../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cstdint> // uint_least32_t
+#include <chrono>
+#include <limits> // numeric_limits
+#include <source_location>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread> // this_thread::get_id
+#include <utility> // move
+#include <vector>
+
+#include "../types/traits.hpp"
+#include "./constexpr_assert.hpp"
+#include "./output.hpp"
+#include "./stopwatch.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+
+@example example/fgl/debug/profiler.cpp
+	An example for @ref group-debug-profiler
+
+@defgroup group-debug-profiler Profiler
+
+@brief Hierarchical scoped profiling zones
+
+@details
+	A profiling zone is an RAII object which times the scope it's declared
+	in. Zones nest into a call tree which is maintained separately for each
+	thread by <tt>@ref fgl::debug::generic_profiler</tt>: entering a zone
+	descends into the child of the current zone which represents the zone's
+	call site, creating the child the first time it's entered. Every zone in
+	the tree records its number of calls, its inclusive time (including
+	nested zones), and its exclusive time (excluding nested zones).
+
+	The tree is stored in a per-thread arena of zone nodes, which is
+	preallocated to avoid allocation while profiling. Entering a zone which
+	has been entered before only searches the current zone's children and
+	starts a stopwatch; leaving a zone only stops the stopwatch.
+
+	A profiler can be sent to libFGL's @ref group-debug-output to print the
+	call tree as an indented report.
+
+	Zones are usually declared with the <tt>@ref FGL_DEBUG_PROFILE_ZONE()</tt>
+	and <tt>@ref FGL_DEBUG_PROFILE_FUNCTION</tt> macros, which expand to
+	nothing if <tt>FGL_DEBUG_DISABLE_PROFILER</tt> is defined. Unlike most
+	debug facilities, the profiler isn't disabled by <tt>NDEBUG</tt>, as it's
+	most useful in optimized builds.
+
+	@see The example program @ref example/fgl/debug/profiler.cpp
+@{
+*/
+
+/**
+@brief A call tree of profiling zones, usually one per thread.
+@tparam T_clock A @ref fgl::traits::steady_clock used to time the zones.
+	<tt>std::chrono::steady_clock</tt> by default.
+*/
+template <fgl::traits::steady_clock T_clock = std::chrono::steady_clock>
+class generic_profiler
+{
+public:
+	/// The clock which the profiler is using
+	using clock_t = T_clock;
+
+	/// The duration type of the clock
+	using duration_t = typename T_clock::duration;
+
+	/// The stopwatch which times the calls of a zone
+	using stopwatch_t = generic_stopwatch<
+		clock_t,
+		streaming_lap_record<duration_t>
+	>;
+
+	/// Represents the absence of a zone index
+	static constexpr std::size_t npos{
+		std::numeric_limits<std::size_t>::max()
+	};
+
+	/// The default number of zones which the arena is preallocated for
+	static constexpr std::size_t default_capacity{ 256 };
+
+	/// A node in the call tree, representing a call site and its call path
+	struct zone
+	{
+		/// Identifies the function of the call site
+		std::string_view function;
+
+		/// Identifies the line of the call site
+		std::uint_least32_t line;
+
+		/// The depth of the zone in the call tree; zero for the root
+		std::size_t depth;
+
+		/// The index of the zone which encloses this zone
+		std::size_t parent;
+
+		/// The index of the first zone nested in this zone
+		std::size_t first_child;
+
+		/// The index of the next zone which shares this zone's parent
+		std::size_t next_sibling;
+
+		/// The total time spent in nested zones
+		duration_t children_elapsed;
+
+		/// Times each call of the zone. Its name is the zone's name.
+		stopwatch_t stopwatch;
+
+		/// @returns The number of completed calls of the zone
+		[[nodiscard]] std::size_t calls() const noexcept
+		{ return stopwatch.number_of_laps(); }
+
+		/// @returns The total time spent in the zone, including nested zones
+		[[nodiscard]] duration_t inclusive() const
+		{ return calls() != 0 ? stopwatch.elapsed() : duration_t{}; }
+
+		/// @returns The total time spent in the zone, excluding nested zones
+		[[nodiscard]] duration_t exclusive() const
+		{ return inclusive() - children_elapsed; }
+	};
+
+	/// A completed call of a zone, retained if event capture is enabled
+	struct zone_event
+	{
+		/// The index of the zone which was called
+		std::size_t zone;
+
+		/// When the call started, as a duration since the clock's epoch
+		duration_t start;
+
+		/// The inclusive duration of the call
+		duration_t duration;
+	};
+
+private:
+	std::vector<zone> m_zones;
+	std::vector<zone_event> m_events;
+	std::size_t m_current;
+	bool m_capture_events;
+
+	[[nodiscard]] static bool same_call_site(
+		const zone& z,
+		const std::source_location& location) noexcept
+	{
+		return z.line == location.line()
+			&& (z.function.data() == location.function_name()
+				|| z.function == location.function_name());
+	}
+
+	[[nodiscard]] std::size_t find_or_create_child(
+		const char* const label,
+		const std::source_location& location)
+	{
+		std::size_t* link{ &m_zones[m_current].first_child };
+		while (*link != npos)
+		{
+			if (same_call_site(m_zones[*link], location))
+				return *link;
+			link = &m_zones[*link].next_sibling;
+		}
+		const std::size_t index{ m_zones.size() };
+		*link = index; // before emplacing, which may invalidate `link`
+		m_zones.push_back(zone{
+			location.function_name(),
+			location.line(),
+			m_zones[m_current].depth + 1,
+			m_current,
+			npos,
+			npos,
+			duration_t{},
+			stopwatch_t(
+				label != nullptr
+					? std::string(label)
+					: internal::function_in_file(location),
+				0
+			)
+		});
+		return index;
+	}
+
+public:
+	/// The name of the profiler, such as the name of its thread
+	std::string name;
+
+	/// The ordinal of the thread which constructed the profiler
+	std::size_t thread_id;
+
+	/**
+	@param in_name The name of the profiler
+	@param capacity The number of zones to preallocate the arena for
+	*/
+	[[nodiscard]] explicit generic_profiler(
+		std::string&& in_name = "profiler",
+		const std::size_t capacity = default_capacity)
+	:
+		m_zones{},
+		m_events{},
+		m_current{ 0 },
+		m_capture_events{ false },
+		name(std::move(in_name)),
+		thread_id{ internal::thread_ordinal() }
+	{
+		m_zones.reserve(capacity);
+		m_zones.push_back(zone{
+			{}, 0, 0, npos, npos, npos, duration_t{}, stopwatch_t("root", 0)
+		});
+	}
+
+	/**
+	@returns The profiler of the calling thread, which is named after the
+		thread's id.
+	*/
+	[[nodiscard]] static generic_profiler& this_thread()
+	{
+		thread_local generic_profiler instance(
+			[]() -> std::string
+			{
+				std::ostringstream oss;
+				oss << "thread " << std::this_thread::get_id();
+				return oss.str();
+			}()
+		);
+		return instance;
+	}
+
+	/**
+	@brief Enters the zone of the call site at @p location, nested in the
+		current zone, and starts timing it.
+	@param label The name of the zone if it's created. If <tt>nullptr</tt>,
+		the name is created from @p location.
+	@param location The call site which identifies the zone
+	@returns The index of the entered zone, to be passed to
+		<tt>@ref leave()</tt>
+	*/
+	[[nodiscard]] std::size_t enter(
+		const char* const label,
+		const std::source_location& location)
+	{
+		const std::size_t index{ find_or_create_child(label, location) };
+		m_current = index;
+		m_zones[index].stopwatch.start(); // last, to exclude the bookkeeping
+		return index;
+	}
+
+	/**
+	@brief Stops timing the current zone and returns to its parent.
+	@param index The index returned by the matching <tt>@ref enter()</tt>
+	@note Zones must be left in the reverse order they were entered.
+	*/
+	void leave(const std::size_t index)
+	{
+		const auto now{ clock_t::now() }; // first, to exclude the bookkeeping
+		FGL_DEBUG_CONSTEXPR_ASSERT(index == m_current);
+		zone& z{ m_zones[index] };
+		z.stopwatch.stop(now);
+		const duration_t lap{ z.stopwatch.previous_lap() };
+		m_zones[z.parent].children_elapsed += lap;
+		m_current = z.parent;
+		if (m_capture_events)
+			m_events.push_back({ index, (now - lap).time_since_epoch(), lap });
+	}
+
+	/**
+	@brief Enables or disables the capture of a
+		<tt>@ref zone_event</tt> for every completed call, such as for
+		exporting with @ref group-debug-trace.
+	@param enable Whether or not events should be captured
+	@param reserve The number of events to preallocate space for
+	@note Capturing events retains memory for every call.
+	*/
+	void capture_events(const bool enable, const std::size_t reserve = 0)
+	{
+		m_capture_events = enable;
+		m_events.reserve(reserve);
+	}
+
+	/// @returns The captured events, in the order the calls completed
+	[[nodiscard]] std::span<const zone_event> events() const noexcept
+	{ return m_events; }
+
+	/// @returns The zones of the call tree. The first zone is the root.
+	[[nodiscard]] std::span<const zone> zones() const noexcept
+	{ return m_zones; }
+
+	/// @returns The index of the innermost zone which is being timed
+	[[nodiscard]] std::size_t current() const noexcept
+	{ return m_current; }
+
+	/**
+	@brief Discards every zone and captured event, retaining the arena's
+		capacity.
+	@note No zones may be active.
+	*/
+	void reset()
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_current == 0);
+		while (m_zones.size() > 1)
+			m_zones.pop_back();
+		m_zones.front().first_child = npos;
+		m_zones.front().children_elapsed = duration_t{};
+		m_events.clear();
+	}
+};
+
+/**
+@brief An RAII profiling zone which times its own lifetime in the calling
+	thread's <tt>@ref generic_profiler</tt>.
+@tparam T_clock The clock of the profiler.
+*/
+template <fgl::traits::steady_clock T_clock = std::chrono::steady_clock>
+class generic_profiler_zone final
+{
+public:
+	using profiler_t = generic_profiler<T_clock>;
+
+private:
+	profiler_t& m_profiler;
+	const std::size_t m_index;
+
+public:
+	/**
+	@param label The name of the zone. If <tt>nullptr</tt>, the name is
+		created from @p location.
+	@param location The call site which identifies the zone
+	@param profiler The profiler to record the zone in
+	*/
+	[[nodiscard]] explicit generic_profiler_zone(
+		const char* const label = nullptr,
+		const std::source_location& location = std::source_location::current(),
+		profiler_t& profiler = profiler_t::this_thread())
+	:
+		m_profiler{ profiler },
+		m_index{ profiler.enter(label, location) }
+	{}
+
+	~generic_profiler_zone()
+	{ m_profiler.leave(m_index); }
+
+	generic_profiler_zone(const generic_profiler_zone&) = delete;
+	generic_profiler_zone& operator=(const generic_profiler_zone&) = delete;
+};
+
+/// A convenient alias for a <tt>std::chrono::steady_clock</tt> profiler
+using profiler = generic_profiler<>;
+
+/// A convenient alias for a <tt>std::chrono::steady_clock</tt> zone
+using profiler_zone = generic_profiler_zone<>;
+
+///@cond FGL_INTERNAL_DOCS
+#ifndef FGL_DEBUG_PROFILER_CONCAT_IMPL
+	#define FGL_DEBUG_PROFILER_CONCAT_IMPL(a, b) a##b
+#else
+	#error FGL_DEBUG_PROFILER_CONCAT_IMPL already defined
+#endif
+#ifndef FGL_DEBUG_PROFILER_CONCAT
+	#define FGL_DEBUG_PROFILER_CONCAT(a, b) FGL_DEBUG_PROFILER_CONCAT_IMPL(a, b)
+#else
+	#error FGL_DEBUG_PROFILER_CONCAT already defined
+#endif
+///@endcond
+
+#ifdef FGL_DEBUG_DISABLE_PROFILER
+	#ifndef FGL_DEBUG_PROFILE_ZONE
+		#define FGL_DEBUG_PROFILE_ZONE(label)
+	#else
+		#error FGL_DEBUG_PROFILE_ZONE already defined
+	#endif
+	#ifndef FGL_DEBUG_PROFILE_FUNCTION
+		#define FGL_DEBUG_PROFILE_FUNCTION
+	#else
+		#error FGL_DEBUG_PROFILE_FUNCTION already defined
+	#endif
+#else
+	#ifndef FGL_DEBUG_PROFILE_ZONE
+		/**
+		@brief Declares a <tt>@ref fgl::debug::profiler_zone</tt> which times
+			the rest of the enclosing scope.
+		@param label The name of the zone (<tt>const char*</tt>)
+		@note If <tt>FGL_DEBUG_DISABLE_PROFILER</tt> is defined, this macro
+			expands to nothing.
+		*/
+		#define FGL_DEBUG_PROFILE_ZONE(label) \
+			const fgl::debug::profiler_zone \
+			FGL_DEBUG_PROFILER_CONCAT(fgl_debug_profiler_zone_, __LINE__) \
+			{ label }
+	#else
+		#error FGL_DEBUG_PROFILE_ZONE already defined
+	#endif // ifndef FGL_DEBUG_PROFILE_ZONE
+
+	#ifndef FGL_DEBUG_PROFILE_FUNCTION
+		/**
+		@brief Declares a <tt>@ref fgl::debug::profiler_zone</tt> named after
+			the enclosing function, which times the rest of the enclosing
+			scope.
+		@note If <tt>FGL_DEBUG_DISABLE_PROFILER</tt> is defined, this macro
+			expands to nothing.
+		*/
+		#define FGL_DEBUG_PROFILE_FUNCTION \
+			const fgl::debug::profiler_zone \
+			FGL_DEBUG_PROFILER_CONCAT(fgl_debug_profiler_zone_, __LINE__){}
+	#else
+		#error FGL_DEBUG_PROFILE_FUNCTION already defined
+	#endif // ifndef FGL_DEBUG_PROFILE_FUNCTION
+#endif // ifdef FGL_DEBUG_DISABLE_PROFILER
+
+/**
+@{ @name Opt-in Short Macros
+@ref page-fgl-macros
+*/
+#ifdef FGL_SHORT_MACROS
+	/// The Opt-in short macro symbol
+	#define FGL_DEBUG_PROFILER_SHORT_MACROS
+#endif // FGL_SHORT_MACROS
+
+#ifdef FGL_DEBUG_PROFILER_SHORT_MACROS
+	#ifndef PROFILE_ZONE
+		/// Alias for <tt>@ref FGL_DEBUG_PROFILE_ZONE()</tt>
+		#define PROFILE_ZONE(label) FGL_DEBUG_PROFILE_ZONE(label)
+	#else
+		#error PROFILE_ZONE already defined (FGL_DEBUG_PROFILER_SHORT_MACROS)
+	#endif // ifndef PROFILE_ZONE
+
+	#ifndef PROFILE_FUNCTION
+		/// Alias for <tt>@ref FGL_DEBUG_PROFILE_FUNCTION</tt>
+		#define PROFILE_FUNCTION FGL_DEBUG_PROFILE_FUNCTION
+	#else
+		#error PROFILE_FUNCTION already defined (FGL_DEBUG_PROFILER_SHORT_MACROS)
+	#endif // ifndef PROFILE_FUNCTION
+#endif // ifdef FGL_DEBUG_PROFILER_SHORT_MACROS
+///@} Opt-in Short Macros
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+static inline constexpr fgl::string_literal profiler_cname{ "PROFILER" };
+} // namespace internal
+///@endcond
+
+/**
+@brief An <tt>fgl::debug::output_handler</tt> specialization for using
+	profilers with libFGL's @ref group-debug-output.
+@details Formats the call tree as an indented report, with one line per zone
+	showing its number of calls, inclusive time, and exclusive time.
+@see @ref group-debug-output and <tt>@ref fgl::debug::output::operator()()</tt>
+*/
+template <fgl::traits::steady_clock T_clock>
+class output_config<generic_profiler<T_clock>>
+: public simple_output_channel
+	<
+		true,
+		priority::info,
+		internal::profiler_cname,
+		output_config<generic_profiler<T_clock>>
+	>
+{
+	output_config(auto&&...) = delete; ///< should never be instantiated
+	public:
+	using channel_t = simple_output_channel
+	<
+		true,
+		priority::info,
+		internal::profiler_cname,
+		output_config<generic_profiler<T_clock>>
+	>;
+
+	using profiler_t = generic_profiler<T_clock>;
+
+	/**
+	@brief Profiler formatter method to satisfy
+		<tt>fgl::debug::output_formatter</tt>
+	*/
+	[[nodiscard]] static std::string format(const profiler_t& p)
+	{
+		std::string temp("Profile: ");
+		temp += p.name;
+		temp += profile_formatter(p);
+		return output::default_fmt_msg(temp);
+	}
+
+	///@{ @name Default Formatters
+
+	/// Formats a zone as its name, calls, inclusive, and exclusive time
+	[[nodiscard]] static std::string default_zone_formatter(
+		const typename profiler_t::zone& zone)
+	{
+		using stopwatch_t = typename profiler_t::stopwatch_t;
+		const auto format_duration{
+			[](const typename profiler_t::duration_t d) -> std::string
+			{
+				std::string s{
+					output_config<stopwatch_t>::duration_formatter(d)
+				};
+				if (!s.empty() && s.back() == ' ')
+					s.pop_back();
+				return s;
+			}
+		};
+		std::ostringstream oss;
+		const std::size_t calls{ zone.calls() };
+		oss
+			<< zone.stopwatch.name << ": "
+			<< calls << " call" << (calls == 1 ? "" : "s")
+			<< ", inclusive " << format_duration(zone.inclusive())
+			<< ", exclusive " << format_duration(zone.exclusive());
+		return oss.str();
+	}
+
+	/// Formats every zone depth-first, indented by depth
+	[[nodiscard]] static std::string default_profile_formatter(
+		const profiler_t& p)
+	{
+		const auto zones{ p.zones() };
+		std::string s;
+		const auto visit{
+			[&](const auto& self, const std::size_t index) -> void
+			{
+				for (std::size_t i{ zones[index].first_child };
+					i != profiler_t::npos;
+					i = zones[i].next_sibling)
+				{
+					s += "\n\t";
+					s.append(2 * (zones[i].depth - 1), ' ');
+					if (zones[i].depth > 1)
+						s += "\\_ ";
+					s += zone_formatter(zones[i]);
+					self(self, i);
+				}
+			}
+		};
+		visit(visit, 0);
+		return s;
+	}
+	///@} Default Formatters
+
+	///@{ @name Configurable formatters
+
+	using zone_formatter_t =
+		std::string (*)(const typename profiler_t::zone&);
+
+	using profile_formatter_t = std::string (*)(const profiler_t&);
+
+	/// @showinitializer
+	static inline configurable_formatter<default_zone_formatter>
+		zone_formatter{};
+
+	/// @showinitializer
+	static inline configurable_formatter<default_profile_formatter>
+		profile_formatter{};
+	///@} Configurable formatters
+};
+
+static_assert(output_handler<output_config<profiler>, profiler>);
+
+///@} group-debug-profiler
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_PROFILER_HPP_INCLUDED
@@ -3,23 +3,36 @@
 #define FGL_DEBUG_STOPWATCH_HPP_INCLUDED
 #include "../environment/libfgl_compatibility_check.hpp"
 
+#include <cstddef> // size_t
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <string_view>
-#include <functional> // function
 #include <utility> // move
-#include <algorithm> // sort
-#include <numeric> // reduce
 #include <sstream>
 #include <ostream>
 #include <iomanip> // setw
+#include <iterator> // back_inserter, output_iterator
 #include <vector>
+#include <span>
 #include <source_location>
+#include <system_error> // errc
 
 #include "../environment/build_info.hpp"
 #include "./constexpr_assert.hpp"
 #include "./output.hpp"
 #include "../types/traits.hpp"
+#include "./stopwatch/statistics.hpp"
+#include "./stopwatch/format.hpp"
+#include "./stopwatch/lap_record.hpp"
+#include "./stopwatch/streaming_lap_record.hpp"
+#include "./stopwatch/histogram_lap_record.hpp"
+#include "./stopwatch/ring_lap_record.hpp"
+#include "./stopwatch/compressed_lap_record.hpp"
+#include "./stopwatch/sampled_lap_record.hpp"
+#include "./stopwatch/timeline_lap_record.hpp"
+#include "./stopwatch/throughput_lap_record.hpp"
 
 namespace fgl::debug {
 
@@ -40,6 +53,53 @@ namespace fgl::debug {
 	formatting fascilities which support sending output to libFGL's
 	@ref group-debug-output.
 
+	How recorded laps are stored is determined by the stopwatch's
+	@ref group-debug-stopwatch-lap_records "lap record". By default every lap
+	is retained, but a constant-memory
+	<tt>@ref fgl::debug::streaming_lap_record</tt> can be used instead for
+	long-running measurements, or a fixed-footprint
+	<tt>@ref fgl::debug::histogram_lap_record</tt> when tail latency
+	percentiles are required. A <tt>@ref fgl::debug::ring_lap_record</tt>
+	retains only the most recent laps, with a hard cap on memory. A
+	<tt>@ref fgl::debug::compressed_lap_record</tt> retains every lap in a
+	fraction of the memory, typically one or two bytes per lap. To reduce
+	the cost of timing a hot path, a
+	<tt>@ref fgl::debug::sampled_lap_record</tt> only times one of every
+	<tt>N</tt> laps, and a <tt>@ref fgl::debug::reservoir_lap_record</tt>
+	retains a uniform sample of a fixed number of laps. A
+	<tt>@ref fgl::debug::timeline_lap_record</tt> also retains when each lap
+	started, for exporting with @ref group-debug-trace.
+	A <tt>@ref fgl::debug::throughput_lap_record</tt> also retains the work
+	performed during each lap, so that the distribution of throughputs, such
+	as items or megabytes per second, can be calculated.
+
+	On Linux, a <tt>@ref fgl::debug::perf_counter_lap_record</tt> also
+	retains the @ref group-debug-stopwatch-perf_counters
+	"performance counter" deltas of each lap, such as instructions per cycle
+	and cache misses. It's provided by
+	<tt><fgl/debug/stopwatch/perf_counter_lap_record.hpp></tt>, which isn't
+	included by <tt><fgl/debug/stopwatch.hpp></tt> because it depends on the
+	Linux system headers; see <tt>@ref fgl::debug::perf_stopwatch</tt>.
+
+	A stopwatch which is shared by multiple threads is provided by
+	<tt><fgl/debug/stopwatch/concurrent_stopwatch.hpp></tt>; see
+	<tt>@ref fgl::debug::generic_concurrent_stopwatch</tt>. Its statistics can
+	be collected while laps are being recorded, and reported periodically by
+	the @ref group-debug-stopwatch-interval_reporter.
+
+	Stopwatches which are shared by every translation unit can be looked up
+	by name with the @ref group-debug-stopwatch-registry in
+	<tt><fgl/debug/stopwatch/registry.hpp></tt>, which also reports where
+	the time went, sorted by total time, when the program exits.
+
+	The cost of timing itself can be measured and subtracted from statistics
+	with the @ref group-debug-stopwatch-overhead facilities in
+	<tt><fgl/debug/stopwatch/overhead.hpp></tt>.
+
+	Laps can be saved as a baseline and later runs checked for performance
+	regressions against it with the @ref group-debug-stopwatch-baseline
+	facilities in <tt><fgl/debug/stopwatch/baseline.hpp></tt>.
+
 	@see The example program @ref example/fgl/debug/stopwatch.cpp
 @{
 */
@@ -56,11 +116,37 @@ inline std::string function_in_file(
 	default_name += sl.file_name();
 	return default_name;
 }
+
+/**
+@internal
+@returns A small integer which uniquely identifies the calling thread,
+	assigned in the order that threads first call this function.
+*/
+inline std::size_t thread_ordinal() noexcept
+{
+	static constinit std::atomic<std::size_t> next_ordinal{ 0 };
+	thread_local const std::size_t ordinal{
+		next_ordinal.fetch_add(1, std::memory_order_relaxed)
+	};
+	return ordinal;
+}
 }
 ///@endcond
 
-/// Template for a generic model stopwatch.
-template <fgl::traits::steady_clock T_clock = std::chrono::steady_clock>
+/**
+@brief Template for a generic model stopwatch.
+@tparam T_clock A @ref fgl::traits::steady_clock to be used by the
+	stopwatch. <tt>std::chrono::steady_clock</tt> by default.
+@tparam T_record The @ref group-debug-stopwatch-lap_records "lap record"
+	which stores the recorded laps. Its duration type must match the clock's.
+	<tt>@ref fgl::debug::vector_lap_record</tt> by default.
+*/
+template
+<
+	fgl::traits::steady_clock T_clock = std::chrono::steady_clock,
+	lap_record T_record = vector_lap_record<typename T_clock::duration>
+>
+requires std::same_as<typename T_record::duration_t, typename T_clock::duration>
 class generic_stopwatch
 {
 public:
@@ -73,6 +159,12 @@ public:
 	/// The duration type of the clock
 	using duration_t = T_clock::duration;
 
+	/// The lap record which stores the recorded laps
+	using record_t = T_record;
+
+	/// The statistics type produced by the lap record
+	using statistics = typename record_t::statistics_t;
+
 private:
 	/// The possible states of a stopwatch.
 	enum class state : unsigned char
@@ -92,7 +184,32 @@ private:
 	time_point_t m_last_point;
 
 	/// Record of lap durations
-	std::vector<duration_t> m_record;
+	record_t m_record;
+
+	/// Forwards the reserve hint to the lap record, if it supports one
+	constexpr void reserve_record(const std::size_t reserve)
+	{
+		if constexpr (requires { m_record.reserve(reserve); })
+			m_record.reserve(reserve);
+	}
+
+	/// Records the lap which ends at @p end, with its start if supported
+	constexpr void record_lap(const time_point_t end)
+	{
+		if constexpr (timestamped_lap_record<record_t>)
+			m_record.record(
+				m_last_point.time_since_epoch(),
+				end - m_last_point
+			);
+		else
+			m_record.record(end - m_last_point);
+	}
+
+	/// Records the lap which ends at @p end, during which @p quantity work
+	/// was performed
+	template <typename T_quantity>
+	constexpr void record_lap(const time_point_t end, const T_quantity quantity)
+	{ m_record.record(end - m_last_point, quantity); }
 
 public:
 	/// The name of the stopwatch
@@ -104,9 +221,13 @@ public:
 		name will be created from the source location.
 	@param reserve The number of durations or laps that are expected to be
 		recorded by the stopwatch. Defaults to <tt>1000</tt>. This is used by
-		an internal vector to avoid potentially costly reallocations.
-	@tparam T_clock A @ref fgl::traits::steady_clock to be used by the
-		stopwatch. <tt>std::chrono::steady_clock</tt> by default.
+		lap records which retain laps to avoid potentially costly
+		reallocations, and is ignored by those which don't. For a
+		<tt>@ref fgl::debug::ring_lap_record</tt>, this is the number of most
+		recent laps which are retained, and for a
+		<tt>@ref fgl::debug::reservoir_lap_record</tt>, the size of the
+		sample.
+	@param record A pre-configured lap record to be used by the stopwatch.
 	*/
 
 	[[nodiscard]] constexpr explicit
@@ -118,7 +239,7 @@ public:
 		m_last_point{},
 		m_record{},
 		name(std::move(in_name))
-	{ m_record.reserve(reserve); }
+	{ reserve_record(reserve); }
 
 	[[nodiscard]] constexpr explicit
 	generic_stopwatch(
@@ -129,7 +250,16 @@ public:
 		m_last_point{},
 		m_record{},
 		name(in_name)
-	{ m_record.reserve(reserve); }
+	{ reserve_record(reserve); }
+
+	[[nodiscard]] constexpr explicit
+	generic_stopwatch(std::string&& in_name, record_t&& record)
+	:
+		m_state(state::reset),
+		m_last_point{},
+		m_record(std::move(record)),
+		name(std::move(in_name))
+	{}
 
 	constexpr generic_stopwatch(const generic_stopwatch&) = default;
 	constexpr generic_stopwatch(generic_stopwatch&&) noexcept = default;
@@ -145,10 +275,14 @@ public:
 		stopping the stopwatch; its time point argument becomes the new start
 		time.
 
-		@note While these methods are <tt>constexpr</tt>, the default argument
-			<tt>clock_t::now()</tt> may not be depending on the clock type. At
-			the time of writing (C++20) there are no standard
-			<tt>constexpr</tt> clocks.
+		@note While these methods are <tt>constexpr</tt>, the overloads which
+			don't take a time point read <tt>clock_t::now()</tt>, which may
+			not be depending on the clock type. At the time of writing
+			(C++20) there are no standard <tt>constexpr</tt> clocks.
+
+		If the lap record is a <tt>@ref fgl::debug::sampling_lap_record</tt>,
+		the overloads which don't take a time point don't read the clock
+		when the laps it would end or begin aren't sampled.
 
 		Stopwatches have an internal state to prevent undefined behavior,
 		ensure correctness by enforcing a conceptually valid order of
@@ -180,12 +314,29 @@ public:
 	@note The stopwatch must not already be "ticking". Starting a stopwatch is
 		only valid after it's been stopped, reset, or first initialized.
 	*/
-	constexpr void start(const time_point_t time_point = clock_t::now())
+	constexpr void start(const time_point_t time_point)
 	{
 		FGL_DEBUG_CONSTEXPR_ASSERT(m_state != state::ticking);
 		if constexpr (fgl::debug_build)
 			m_state = state::ticking;
 		m_last_point = time_point;
+		if constexpr (started_lap_record<record_t>)
+			m_record.start();
+	}
+
+	/// Starts the stopwatch at <tt>clock_t::now()</tt>; see the other overload
+	constexpr void start()
+	{
+		if constexpr (sampling_lap_record<record_t>)
+		{
+			if (!m_record.samples_this_lap())
+			{
+				// unsampled, so the time point is irrelevant
+				start(m_last_point);
+				return;
+			}
+		}
+		start(clock_t::now());
 	}
 
 	/**
@@ -202,13 +353,47 @@ public:
 		rather than calling <tt>@ref lap()</tt> as the time between emplacing
 		the lap duration and updating the start time may be significant,
 		especially if the number of laps grows beyond what was reserved when
-		the stopwatch was constructed.
+		the stopwatch was constructed. A
+		<tt>@ref fgl::debug::ring_lap_record</tt> never reallocates.
+	*/
+	constexpr void lap(const time_point_t time_point)
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::ticking);
+		FGL_DEBUG_CONSTEXPR_ASSERT(time_point >= m_last_point);
+		record_lap(time_point);
+		m_last_point = time_point;
+	}
+
+	/// Records a lap at <tt>clock_t::now()</tt>; see the other overload
+	constexpr void lap()
+	{
+		if constexpr (sampling_lap_record<record_t>)
+		{
+			if (!m_record.samples_this_lap() && !m_record.samples_next_lap())
+			{
+				// unsampled, so the time point is irrelevant
+				lap(m_last_point);
+				return;
+			}
+		}
+		lap(clock_t::now());
+	}
+
+	/**
+	@brief Like <tt>@ref lap()</tt>, but also records the @p quantity of work
+		which was performed during the lap, such as a number of items or a
+		<tt>fgl::units::data_size</tt>.
+	@note Requires an <tt>@ref fgl::debug::quantified_lap_record</tt>.
 	*/
-	constexpr void lap(const time_point_t time_point = clock_t::now())
+	template <typename T_record_ = record_t>
+	requires quantified_lap_record<T_record_>
+	constexpr void lap(
+		const typename T_record_::quantity_t quantity,
+		const time_point_t time_point = clock_t::now())
 	{
 		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::ticking);
 		FGL_DEBUG_CONSTEXPR_ASSERT(time_point >= m_last_point);
-		m_record.emplace_back(time_point - m_last_point);
+		record_lap(time_point, quantity);
 		m_last_point = time_point;
 	}
 
@@ -220,13 +405,46 @@ public:
 	@note The stopwatch must be "ticking". Stopping a stopwatch is only valid
 		after it has been started.
 	*/
-	constexpr void stop(const time_point_t time_point = clock_t::now())
+	constexpr void stop(const time_point_t time_point)
 	{
 		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::ticking);
 		FGL_DEBUG_CONSTEXPR_ASSERT(time_point >= m_last_point);
 		if constexpr (fgl::debug_build)
 			m_state = state::stopped;
-		m_record.emplace_back(time_point - m_last_point);
+		record_lap(time_point);
+	}
+
+	/// Stops the stopwatch at <tt>clock_t::now()</tt>; see the other overload
+	constexpr void stop()
+	{
+		if constexpr (sampling_lap_record<record_t>)
+		{
+			if (!m_record.samples_this_lap())
+			{
+				// unsampled, so the time point is irrelevant
+				stop(m_last_point);
+				return;
+			}
+		}
+		stop(clock_t::now());
+	}
+
+	/**
+	@brief Like <tt>@ref stop()</tt>, but also records the @p quantity of work
+		which was performed during the lap.
+	@note Requires an <tt>@ref fgl::debug::quantified_lap_record</tt>.
+	*/
+	template <typename T_record_ = record_t>
+	requires quantified_lap_record<T_record_>
+	constexpr void stop(
+		const typename T_record_::quantity_t quantity,
+		const time_point_t time_point = clock_t::now())
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::ticking);
+		FGL_DEBUG_CONSTEXPR_ASSERT(time_point >= m_last_point);
+		if constexpr (fgl::debug_build)
+			m_state = state::stopped;
+		record_lap(time_point, quantity);
 	}
 
 	/**
@@ -261,14 +479,20 @@ public:
 	[[nodiscard]] constexpr std::size_t number_of_laps() const
 	{ return m_record.size(); }
 
+	/// @returns A <tt>const</tt> reference to the lap record
+	[[nodiscard]] constexpr const record_t& get_record() const noexcept
+	{ return m_record; }
+
 	/**
 	@note The stopwatch must be in a "stopped" state.
+	@note Requires an <tt>@ref fgl::debug::indexed_lap_record</tt>.
 	@param lap_number The lap to return the duration of. Must be less than the
 		number of recorded laps.
 	@returns The duration of the specified lap.
 	*/
 	[[nodiscard]] constexpr
 	duration_t get_lap(const std::size_t lap_number) const
+	requires indexed_lap_record<record_t>
 	{
 		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::stopped);
 		return m_record.at(lap_number);
@@ -280,21 +504,25 @@ public:
 		must have at least one lap recorded).
 	*/
 	[[nodiscard]] constexpr duration_t previous_lap() const
+	requires requires (const record_t& r)
+	{ { r.back() } -> std::same_as<duration_t>; }
 	{
 		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::stopped);
 		return m_record.back();
 	}
 
 	/**
-	@returns A <tt>const</tt> reference to the internal record of lap
-		durations.
+	@returns The laps retained by the lap record. For the default
+		<tt>@ref fgl::debug::vector_lap_record</tt>, this is a
+		<tt>const</tt> reference to the internal vector of lap durations.
 	@note The stopwatch must be in a "stopped" state.
+	@note Requires an <tt>@ref fgl::debug::indexed_lap_record</tt>.
 	*/
-	[[nodiscard]] constexpr
-	const std::vector<duration_t>& get_all_laps() const
+	[[nodiscard]] constexpr decltype(auto) get_all_laps() const
+	requires indexed_lap_record<record_t>
 	{
 		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::stopped);
-		return m_record;
+		return m_record.laps();
 	}
 
 	/**
@@ -306,27 +534,25 @@ public:
 	@returns The summation of durations
 		[<tt>start_lap</tt>, <tt>end_lap</tt>).
 	@note The stopwatch must be in either a "ticking" or "stopped" state.
+	@note Requires an <tt>@ref fgl::debug::indexed_lap_record</tt>.
 	*/
 	[[nodiscard]] constexpr duration_t elapsed_between_laps(
 		const std::size_t start_lap,
 		const std::size_t end_lap
 	) const
+	requires indexed_lap_record<record_t>
 	{
 		FGL_DEBUG_CONSTEXPR_ASSERT(m_state > state::reset);
 		FGL_DEBUG_CONSTEXPR_ASSERT(start_lap < end_lap);
 		FGL_DEBUG_CONSTEXPR_ASSERT(end_lap <= m_record.size());
-		using diff_t = decltype(m_record)::difference_type;
-		return std::reduce(
-			m_record.cbegin() + static_cast<diff_t>(start_lap),
-			m_record.cbegin() + static_cast<diff_t>(end_lap),
-			duration_t{}
-		);
+		return m_record.total_between(start_lap, end_lap);
 	}
 
 	/**
 	@returns The sum of all recorded lap durations.
 	@details Equivalent to calling
-		<tt>@ref elapsed_between_laps(0, number_of_laps())</tt>.
+		<tt>@ref elapsed_between_laps(0, number_of_laps())</tt> for records
+		which retain every lap.
 	@note The stopwatch must be in either a "ticking" or "stopped" state.
 	@note The elapsed time is **NOT** the last stop time point subtracted from
 		the first start time point. It is the sum of all recorded laps. There
@@ -334,101 +560,194 @@ public:
 		which isn't represented; this is an intentional design choice.
 	*/
 	[[nodiscard]] constexpr duration_t elapsed() const
-	{ return elapsed_between_laps(0, m_record.size()); }
-
-	struct statistics
-	{
-		std::size_t number_of_laps;
-		duration_t total_elapsed;
-		duration_t mean;
-		duration_t median;
-		duration_t min;
-		duration_t max;
-
-		/**
-		@{ @name Constructors
-		@note To generate statistics for a stopwatch, use the the stopwatch's
-			<tt>@ref calculate_statistics()</tt> factory method.
-		@param[in] sorted_laps A vector of lap durations, sorted in ascending
-			order, which will be used to produce the statistics.
-		*/
-		[[nodiscard]] explicit constexpr
-		statistics(const std::vector<duration_t>& sorted_laps) noexcept
-		:
-			number_of_laps{ sorted_laps.size() },
-			total_elapsed{
-				std::reduce(
-					sorted_laps.cbegin(),
-					sorted_laps.cend(),
-					duration_t{}
-				)
-			},
-			mean{ get_mean(sorted_laps) },
-			median{ get_median(sorted_laps) },
-			min{ sorted_laps.front() },
-			max{ sorted_laps.back() }
-		{
-			FGL_DEBUG_CONSTEXPR_ASSERT(
-				std::is_sorted(sorted_laps.cbegin(), sorted_laps.cend())
-			);
-		}
-
-		[[nodiscard]] explicit constexpr statistics(const statistics&)
-			noexcept = default;
-		///@} Constructors
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_state > state::reset);
+		return m_record.total();
+	}
 
-		private:
+	/**
+	@returns A <tt>@ref statistics</tt> object containing the statistics of
+		the recorded lap durations, as calculated by the lap record.
+	@note The stopwatch must be in a "stopped" state.
+	*/
+	[[nodiscard]] constexpr statistics calculate_statistics() const
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::stopped);
+		return m_record.calculate_statistics();
+	}
 
-		/// @returns The mean of a sorted vector of durations
-		[[nodiscard]] static constexpr
-		duration_t get_mean(const std::vector<duration_t>& v) noexcept
-		{
-			const auto size{ static_cast<duration_t::rep>(v.size()) };
+	/**
+	@returns A <tt>@ref statistics</tt> object containing the statistics of
+		the recorded lap durations, including the requested percentiles.
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt>, such as
+		<tt>99.9</tt>
+	@note The stopwatch must be in a "stopped" state.
+	@note Requires an <tt>@ref fgl::debug::percentile_lap_record</tt>.
+	*/
+	[[nodiscard]] constexpr statistics calculate_statistics(
+		const std::span<const double> percentiles) const
+	requires percentile_lap_record<record_t>
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::stopped);
+		return m_record.calculate_statistics(percentiles);
+	}
 
-			return (size != 0)
-				? std::reduce(v.cbegin(), v.cend(), duration_t{}) / size
-				: duration_t{};
-		}
+	/**
+	@returns Like <tt>@ref calculate_statistics()</tt>, but the record
+		calculates the statistics in @p scratch, which can be reused between
+		calls so that no allocation proportional to the number of laps
+		happens at report time.
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt>
+	@param scratch A buffer which only allocates if it has less capacity
+		than the number of laps.
+	@note The stopwatch must be in a "stopped" state.
+	@note Requires an <tt>@ref fgl::debug::scratch_lap_record</tt>.
+	*/
+	[[nodiscard]] constexpr statistics calculate_statistics(
+		const std::span<const double> percentiles,
+		std::vector<duration_t>& scratch) const
+	requires scratch_lap_record<record_t>
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::stopped);
+		return m_record.calculate_statistics(percentiles, scratch);
+	}
 
-		/// @returns The median from a sorted vector of durations
-		[[nodiscard]] static constexpr
-		duration_t get_median(const std::vector<duration_t>& v) noexcept
-		{
-			using rep_t = typename duration_t::rep;
-			const std::size_t size{ v.size() };
-			switch (size)
-			{
-			break; case 0: return {};
-			break; case 1: return { v[0] };
-			break; case 2: return { (v[0] + v[1]) / rep_t{2} };
-			break; default:
-				const std::size_t mid{ size / rep_t{2} };
-				return {
-					(size % 2 == 0)
-					? (v[mid-1] + v[mid]) / rep_t{2}
-					: v[mid]
-				};
-			}
-		}
-	};
+	/**
+	@returns The distribution of the throughputs of the recorded laps,
+		including the requested percentiles.
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt>
+	@note The stopwatch must be in a "stopped" state.
+	@note Requires a lap record such as
+		<tt>@ref fgl::debug::throughput_lap_record</tt>.
+	*/
+	[[nodiscard]] constexpr auto calculate_throughput_statistics(
+		const std::span<const double> percentiles = {}) const
+	requires requires { m_record.calculate_throughput_statistics(); }
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::stopped);
+		return m_record.calculate_throughput_statistics(percentiles);
+	}
 
 	/**
-	@returns A <tt>@ref statistics</tt> object containing the statistics of
-		the recorded lap durations.
+	@returns The distributions of the performance counter deltas of the
+		recorded laps.
 	@note The stopwatch must be in a "stopped" state.
+	@note Requires a lap record such as
+		<tt>@ref fgl::debug::perf_counter_lap_record</tt>.
 	*/
-	[[nodiscard]] constexpr statistics calculate_statistics() const
+	[[nodiscard]] auto calculate_counter_statistics() const
+	requires requires { m_record.calculate_counter_statistics(); }
 	{
 		FGL_DEBUG_CONSTEXPR_ASSERT(m_state == state::stopped);
-		std::vector<duration_t> v(m_record);
-		std::sort(v.begin(), v.end());
-		return statistics(v);
+		return m_record.calculate_counter_statistics();
 	}
+
+	/**
+	@returns How many of the observed laps were sampled.
+	@note Requires a lap record such as
+		<tt>@ref fgl::debug::sampled_lap_record</tt> or
+		<tt>@ref fgl::debug::reservoir_lap_record</tt>.
+	*/
+	[[nodiscard]] constexpr sampling_statistics calculate_sampling_statistics()
+	const
+	requires requires { m_record.calculate_sampling_statistics(); }
+	{ return m_record.calculate_sampling_statistics(); }
 };
 
 /// A convenient alias, as this is by far the most common use case.
 using stopwatch = generic_stopwatch<std::chrono::steady_clock>;
 
+/**
+@brief A convenient alias for a constant-memory
+	<tt>std::chrono::steady_clock</tt> stopwatch which only retains running
+	aggregates of its laps.
+*/
+using streaming_stopwatch = generic_stopwatch<
+	std::chrono::steady_clock,
+	streaming_lap_record<std::chrono::steady_clock::duration>
+>;
+
+/**
+@brief A convenient alias for a fixed-footprint
+	<tt>std::chrono::steady_clock</tt> stopwatch which counts its laps in a
+	log-linear histogram, providing approximate percentiles.
+*/
+using histogram_stopwatch = generic_stopwatch<
+	std::chrono::steady_clock,
+	histogram_lap_record<std::chrono::steady_clock::duration>
+>;
+
+/**
+@brief A convenient alias for a <tt>std::chrono::steady_clock</tt> stopwatch
+	which retains every lap along with the time point it started at.
+*/
+using timeline_stopwatch = generic_stopwatch<
+	std::chrono::steady_clock,
+	timeline_lap_record<std::chrono::steady_clock::duration>
+>;
+
+/**
+@brief A convenient alias for a <tt>std::chrono::steady_clock</tt> stopwatch
+	which retains only the most recent laps; as many as its <tt>reserve</tt>
+	constructor argument.
+*/
+using ring_stopwatch = generic_stopwatch<
+	std::chrono::steady_clock,
+	ring_lap_record<std::chrono::steady_clock::duration>
+>;
+
+/**
+@brief A convenient alias for a <tt>std::chrono::steady_clock</tt> stopwatch
+	which retains every lap in compressed chunks.
+*/
+using compressed_stopwatch = generic_stopwatch<
+	std::chrono::steady_clock,
+	compressed_lap_record<std::chrono::steady_clock::duration>
+>;
+
+/**
+@brief A convenient alias for a <tt>std::chrono::steady_clock</tt> stopwatch
+	which only times and retains one of every 100 laps.
+@details For a different period, construct it with a record such as
+	<tt>sampled_lap_record<vector_lap_record<...>>(1000)</tt>.
+*/
+using sampled_stopwatch = generic_stopwatch<
+	std::chrono::steady_clock,
+	sampled_lap_record<vector_lap_record<std::chrono::steady_clock::duration>>
+>;
+
+/**
+@brief A convenient alias for a <tt>std::chrono::steady_clock</tt> stopwatch
+	which retains a uniform random sample of its laps; as many as its
+	<tt>reserve</tt> constructor argument.
+*/
+using reservoir_stopwatch = generic_stopwatch<
+	std::chrono::steady_clock,
+	reservoir_lap_record<std::chrono::steady_clock::duration>
+>;
+
+/**
+@brief A convenient alias for a <tt>std::chrono::steady_clock</tt> stopwatch
+	which retains every lap along with the number of items it processed.
+*/
+using throughput_stopwatch = generic_stopwatch<
+	std::chrono::steady_clock,
+	throughput_lap_record<std::chrono::steady_clock::duration>
+>;
+
+/**
+@brief Specialize to append a section about the laps retained by a
+	@p T_record to the output of every stopwatch which uses it.
+@details A specialization provides a static <tt>format()</tt> which takes
+	the <tt>generic_stopwatch</tt> and returns the section's lines as a
+	<tt>std::string</tt>, each indented with a tab like the statistics.
+	For example, <tt><fgl/debug/stopwatch/perf_counter_lap_record.hpp></tt>
+	reports the performance counter deltas.
+*/
+template <typename T_record>
+struct lap_record_output_section
+{};
+
 /// Disables all stopwatch output channels if set to <tt>true</tt>
 static inline bool disable_stopwatch_output_channels{ false };
 
@@ -448,20 +767,21 @@ static inline constexpr fgl::string_literal stopwatch_cname{ "STOPWATCH" };
 
 @see @ref group-debug-output and @ref fgl::debug::output::operator()()
 @tparam T_clock The clock type to use for the stopwatch.
+@tparam T_record The lap record type used by the stopwatch.
 
 @todo formatters could do with a rework, and the channel formatter could be
 	made configurable.
 
 @todo should be able to print an empty stopwatch
 */
-template <fgl::traits::steady_clock T_clock>
-class output_config<generic_stopwatch<T_clock>>
+template <fgl::traits::steady_clock T_clock, lap_record T_record>
+class output_config<generic_stopwatch<T_clock, T_record>>
 : public simple_output_channel
 	<
 		true,
 		priority::info,
 		internal::stopwatch_cname,
-		output_config<generic_stopwatch<T_clock>>
+		output_config<generic_stopwatch<T_clock, T_record>>
 	>
 {
 	output_config(auto&&...) = delete; ///< should never be instantiated
@@ -471,13 +791,14 @@ class output_config<generic_stopwatch<T_clock>>
 		true,
 		priority::info,
 		internal::stopwatch_cname,
-		output_config<generic_stopwatch<T_clock>>
+		output_config<generic_stopwatch<T_clock, T_record>>
 	>;
 
-	using stopwatch_t = generic_stopwatch<T_clock>;
+	using stopwatch_t = generic_stopwatch<T_clock, T_record>;
 
-	[[nodiscard]] static constexpr bool is_enabled() noexcept
-	{ return channel_t::is_enabled() && !disable_stopwatch_output_channels; }
+	/// @returns <tt>true</tt> if the channel and stopwatch output are enabled
+	[[nodiscard]] static bool enabled() noexcept
+	{ return channel_t::enabled() && !disable_stopwatch_output_channels; }
 
 	/**
 	@brief Stopwatch formatter method to satisfy
@@ -486,56 +807,160 @@ class output_config<generic_stopwatch<T_clock>>
 	[[nodiscard]] static std::string format(const stopwatch_t& sw)
 	{
 		std::string temp("Statistics: ");
-		const auto& stats{ statistics_formatter(sw.calculate_statistics())};
+		const auto& stats{ statistics_formatter(calculate_statistics(sw)) };
 		temp.reserve(temp.size() + sw.name.size() + stats.size() + 1);
 		temp += sw.name;
 		temp += '\n';
 		temp += stats;
+		if constexpr (requires { sw.calculate_throughput_statistics(); })
+		{
+			temp += '\n';
+			temp += default_throughput_formatter(
+				sw.calculate_throughput_statistics(percentiles)
+			);
+		}
+		using section_t = lap_record_output_section<T_record>;
+		if constexpr (requires { section_t::format(sw); })
+		{
+			temp += '\n';
+			temp += section_t::format(sw);
+		}
+		if constexpr (requires { sw.calculate_sampling_statistics(); })
+		{
+			temp += '\n';
+			temp += default_sampling_formatter(
+				sw.calculate_sampling_statistics()
+			);
+		}
 		return output::default_fmt_msg(temp);
 	}
 
 	///@{ @name Default Formatters
 
+	/**
+	@brief Formats @p duration with <tt>@ref format_duration()</tt> in the
+		configured <tt>@ref format_mode</tt>, followed by a space.
+	@returns The formatted duration, or an empty string if it didn't fit
+	*/
 	[[nodiscard]] static
 	std::string default_duration_formatter(stopwatch_t::duration_t duration)
 	{
+		// the last character is reserved for the trailing space
+		std::array<char, max_formatted_duration_size + 1> buffer;
+		char* const first{ buffer.data() };
+		const auto [end, error]{
+			format_duration(
+				first,
+				first + max_formatted_duration_size,
+				duration,
+				format_mode
+			)
+		};
+		if (error != std::errc{})
+			return {};
+		*end = ' ';
+		return std::string(first, end + 1);
+	}
+
+	/**
+	@brief Formats @p stats in the configured <tt>@ref format_mode</tt>.
+	@details Unless <tt>@ref duration_formatter</tt> has been replaced, the
+		statistics are formatted by <tt>@ref format_statistics()</tt>
+		without any intermediate strings. Otherwise, each duration is
+		formatted by the replacement.
+	*/
+	[[nodiscard]] static std::string default_statistics_formatter(
+		const stopwatch_t::statistics& stats)
+	{
+		if (duration_formatter.is_default())
+		{
+			std::string s;
+			s.reserve(256 + stats.percentiles.size() * 32);
+			format_statistics(std::back_inserter(s), stats, format_mode);
+			return s;
+		}
+		const bool human{ format_mode == duration_format::human };
 		std::stringstream ss;
-		const auto process{
-			[&duration, &ss](const auto unit_time) -> void
+		const auto line{
+			[&ss, human](
+				const std::string_view human_label,
+				const std::string_view fixed_key,
+				const typename stopwatch_t::duration_t value)
 			{
-				if (unit_time.count() != 0)
-				{
-					duration -= unit_time;
-					ss << unit_time << ' ';
-				}
+				ss
+					<< (human ? human_label : fixed_key)
+					<< duration_formatter(value);
 			}
 		};
-		using namespace std::chrono;
-		process(duration_cast<years>(duration));
-		process(duration_cast<months>(duration));
-		process(duration_cast<weeks>(duration));
-		process(duration_cast<days>(duration));
-		process(duration_cast<hours>(duration));
-		process(duration_cast<minutes>(duration));
-		process(duration_cast<seconds>(duration));
-		process(duration_cast<milliseconds>(duration));
-		process(duration_cast<microseconds>(duration));
-		process(duration_cast<nanoseconds>(duration));
-		assert(duration.count() == 0);
+		ss << (human ? "\tNumber of laps: " : "laps=") << stats.number_of_laps;
+		line("\n\tTotal elapsed:  ", " total=", stats.total_elapsed);
+		line("\n\tMean lap:       ", " mean=", stats.mean);
+		if (stats.median)
+			line("\n\tMedian lap:     ", " median=", *stats.median);
+		line("\n\tMin lap:        ", " min=", stats.min);
+		line("\n\tMax lap:        ", " max=", stats.max);
+		line("\n\tStd. deviation: ", " stddev=", stats.standard_deviation);
+		for (const auto& [percentile, value] : stats.percentiles)
+		{
+			if (human)
+			{
+				std::ostringstream label;
+				label << 'P' << percentile << " lap:";
+				ss << "\n\t" << std::left << std::setw(16) << label.str();
+			}
+			else
+				ss << " p" << percentile << '=';
+			ss << duration_formatter(value);
+		}
 		return ss.str();
 	}
 
-	[[nodiscard]] static std::string default_statistics_formatter(
-		const stopwatch_t::statistics& stats)
+	/**
+	@brief Formats a throughput as items per second, or as a data rate such
+		as <tt>MB/s</tt> if the work quantity is a data size.
+	*/
+	template <typename T_rate>
+	[[nodiscard]] static std::string default_rate_formatter(const T_rate rate)
+	{
+		std::ostringstream oss;
+		if constexpr (fgl::units::data_rate_type<T_rate>)
+			oss << rate.count() << ' ' << fgl::units::data_rate_unit<T_rate>();
+		else
+			oss << rate << " items/s";
+		return oss.str();
+	}
+
+	/// Formats the throughput statistics of a throughput-annotated record
+	template <typename T_quantity>
+	[[nodiscard]] static std::string default_throughput_formatter(
+		const throughput_statistics<T_quantity>& stats)
+	{
+		std::stringstream ss;
+		ss
+			<< "\tOverall rate:   " << default_rate_formatter(stats.overall)
+			<< "\n\tMean rate:      " << default_rate_formatter(stats.mean)
+			<< "\n\tMedian rate:    " << default_rate_formatter(stats.median)
+			<< "\n\tMin rate:       " << default_rate_formatter(stats.min)
+			<< "\n\tMax rate:       " << default_rate_formatter(stats.max);
+		for (const auto& [percentile, value] : stats.percentiles)
+		{
+			std::ostringstream label;
+			label << 'P' << percentile << " rate:";
+			ss
+				<< "\n\t" << std::left << std::setw(16) << label.str()
+				<< default_rate_formatter(value);
+		}
+		return ss.str();
+	}
+
+	/// Formats how many of the observed laps were sampled
+	[[nodiscard]] static std::string default_sampling_formatter(
+		const sampling_statistics& stats)
 	{
 		std::stringstream ss;
 		ss
-			<< "\tNumber of laps: " << stats.number_of_laps
-			<< "\n\tTotal elapsed:  " << duration_formatter(stats.total_elapsed)
-			<< "\n\tMean lap:       " << duration_formatter(stats.mean)
-			<< "\n\tMedian lap:     " << duration_formatter(stats.median)
-			<< "\n\tMin lap:        " << duration_formatter(stats.min)
-			<< "\n\tMax lap:        " << duration_formatter(stats.max);
+			<< "\tSampled laps:   " << stats.sampled_laps << " of "
+			<< stats.observed_laps << " (" << stats.rate() * 100.0 << "%)";
 		return ss.str();
 	}
 
@@ -554,44 +979,72 @@ class output_config<generic_stopwatch<T_clock>>
 	///@{ @name Configurable formatters
 
 	using duration_formatter_t =
-		std::function<std::string(typename stopwatch_t::duration_t)>;
+		std::string (*)(typename stopwatch_t::duration_t);
 
 	using statistics_formatter_t =
-		std::function<std::string(const typename stopwatch_t::statistics&)>;
+		std::string (*)(const typename stopwatch_t::statistics&);
 
-	using stopwatch_formatter_t =
-		std::function<std::string(const stopwatch_t&)>;
+	using stopwatch_formatter_t = std::string (*)(const stopwatch_t&);
 
 	/// @showinitializer
-	static inline duration_formatter_t duration_formatter{
-		default_duration_formatter
-	};
+	static inline configurable_formatter<default_duration_formatter>
+		duration_formatter{};
 
 	/// @showinitializer
-	static inline statistics_formatter_t statistics_formatter{
-		default_statistics_formatter
-	};
+	static inline configurable_formatter<default_statistics_formatter>
+		statistics_formatter{};
 
 	/// @showinitializer
-	static inline stopwatch_formatter_t stopwatch_formatter{
-		default_stopwatch_formatter
-	};
+	static inline configurable_formatter<default_stopwatch_formatter>
+		stopwatch_formatter{};
+
+	/**
+	@brief The format of durations produced by the default formatters: either
+		human-readable, or a compact fixed unit for machine parsing.
+	@showinitializer
+	*/
+	static inline duration_format format_mode{ duration_format::human };
+
+	/**
+	@brief Percentiles in the range <tt>[0, 100]</tt> which are included in
+		the statistics, such as <tt>{ 99.0, 99.9, 99.99 }</tt>.
+	@note Only used if the stopwatch's lap record satisfies
+		<tt>@ref fgl::debug::percentile_lap_record</tt>.
+	@showinitializer
+	*/
+	static inline std::vector<double> percentiles{};
 
 	///@} Configurable formatters
+
+	/**
+	@returns The statistics of @p sw, including the configured
+		<tt>@ref percentiles</tt> if supported by the lap record.
+	*/
+	[[nodiscard]] static typename stopwatch_t::statistics
+	calculate_statistics(const stopwatch_t& sw)
+	{
+		if constexpr (percentile_lap_record<T_record>)
+			return sw.calculate_statistics(percentiles);
+		else
+			return sw.calculate_statistics();
+	}
 };
 
 static_assert(output_handler<output_config<stopwatch>, stopwatch>);
+static_assert(
+	output_handler<output_config<throughput_stopwatch>, throughput_stopwatch>
+);
 
 /**
 @brief <tt>std::ostream</tt> support for stopwatches. Utilizes the
 	<tt>@ref stopwatch_formatter</tt> member
 */
-template <fgl::traits::steady_clock T_clock>
+template <fgl::traits::steady_clock T_clock, lap_record T_record>
 std::ostream& operator<<(
 	std::ostream& os,
-	const generic_stopwatch<T_clock>& sw)
+	const generic_stopwatch<T_clock, T_record>& sw)
 {
-	using config = output_config<generic_stopwatch<T_clock>>;
+	using config = output_config<generic_stopwatch<T_clock, T_record>>;
 	return os << config::stopwatch_formatter(sw);
 }
 
@@ -602,40 +1055,49 @@ std::ostream& operator<<(
 	configurable formatters.
 */
 
-template <typename T_clock>
+template
+<
+	typename T_clock,
+	typename T_record = vector_lap_record<typename T_clock::duration>
+>
 [[nodiscard]] inline std::string to_string_duration(
-	const typename generic_stopwatch<T_clock>::duration_t duration)
+	const typename generic_stopwatch<T_clock, T_record>::duration_t duration)
 {
-	return output_config<generic_stopwatch<T_clock>>::duration_formatter(
-		duration
-	);
+	using config = output_config<generic_stopwatch<T_clock, T_record>>;
+	return config::duration_formatter(duration);
 }
 
-template <fgl::traits::steady_clock T_clock>
+template <fgl::traits::steady_clock T_clock, lap_record T_record>
 [[nodiscard]] inline std::string to_string_minimal(
-	const generic_stopwatch<T_clock>& sw)
+	const generic_stopwatch<T_clock, T_record>& sw)
 {
-	return output_config<generic_stopwatch<T_clock>>::stopwatch_formatter(sw);
+	using config = output_config<generic_stopwatch<T_clock, T_record>>;
+	return config::stopwatch_formatter(sw);
 }
 
-template <fgl::traits::steady_clock T_clock>
+template <fgl::traits::steady_clock T_clock, lap_record T_record>
 [[nodiscard]] inline std::string to_string_statistics(
-	const generic_stopwatch<T_clock>& sw)
+	const generic_stopwatch<T_clock, T_record>& sw)
 {
+	using config = output_config<generic_stopwatch<T_clock, T_record>>;
 	std::string s(sw.name);
 	s += "\n \\_____ Statistics\n";
-	s += output_config<generic_stopwatch<T_clock>>::statistics_formatter(
-		sw.calculate_statistics()
-	);
+	s += config::statistics_formatter(config::calculate_statistics(sw));
 	return s;
 }
 
-template <fgl::traits::steady_clock T_clock>
+/**
+@note Individual lap durations are only listed for stopwatches whose lap
+	record is an <tt>@ref fgl::debug::indexed_lap_record</tt>.
+*/
+template <fgl::traits::steady_clock T_clock, lap_record T_record>
 [[nodiscard]] inline std::string to_string_full(
-	const generic_stopwatch<T_clock>& sw)
+	const generic_stopwatch<T_clock, T_record>& sw)
 {
+	using config = output_config<generic_stopwatch<T_clock, T_record>>;
 	std::stringstream ss;
 	ss << to_string_statistics(sw);
+	if constexpr (indexed_lap_record<T_record>)
 	if (const std::size_t nlaps{ sw.number_of_laps() }; nlaps > 0)
 	{
 		// number of digits used to represent the highest lap number
@@ -648,19 +1110,99 @@ template <fgl::traits::steady_clock T_clock>
 			}(nlaps - 1) // laps count from 0
 		};
 
-		ss << "     \\_ Lap durations\n";
+		ss << "\n     \\_ Lap durations\n";
 		for (std::size_t i{}; const auto lap : sw.get_all_laps())
 		{
 			ss
 				<< "\tLap " << std::setw(max_digits) << i++ << ": "
-				<< output_config<generic_stopwatch<T_clock>>::duration_formatter(
-					lap)
+				<< config::duration_formatter(lap)
 				<< '\n';
 		}
 	}
 	return ss.str();
 }
 
+/**
+@brief Formats the statistics and the individual lap durations of @p sw to
+	the output iterator @p out, without using the configurable formatters.
+@details The human-readable format matches <tt>@ref to_string_full()</tt>
+	with the default formatters. The fixed format produces the name, the
+	statistics as a line of <tt>key=value</tt> pairs, and then one lap
+	duration per line.
+@returns The iterator past the last character written
+@note Individual lap durations are only listed for stopwatches whose lap
+	record is an <tt>@ref fgl::debug::indexed_lap_record</tt>.
+*/
+template
+<
+	std::output_iterator<char> T_iterator,
+	fgl::traits::steady_clock T_clock,
+	lap_record T_record
+>
+T_iterator format_full(
+	T_iterator out,
+	const generic_stopwatch<T_clock, T_record>& sw,
+	const duration_format format = duration_format::human)
+{
+	using config = output_config<generic_stopwatch<T_clock, T_record>>;
+	const bool human{ format == duration_format::human };
+	const auto put{
+		[&out](const std::string_view s)
+		{ out = std::copy(s.begin(), s.end(), out); }
+	};
+	put(sw.name);
+	put(human ? "\n \\_____ Statistics\n" : "\n");
+	out = format_statistics(out, config::calculate_statistics(sw), format);
+	if constexpr (indexed_lap_record<T_record>)
+	if (const std::size_t nlaps{ sw.number_of_laps() }; nlaps > 0)
+	{
+		// number of digits used to represent the highest lap number
+		std::array<char, 24> index;
+		const auto max_digits{ static_cast<std::size_t>(
+			std::to_chars(index.data(), index.data() + index.size(), nlaps - 1)
+				.ptr - index.data()
+		) };
+
+		put(human ? "\n     \\_ Lap durations\n" : "\n");
+		for (std::size_t i{}; const auto lap : sw.get_all_laps())
+		{
+			if (human)
+			{
+				const char* const end{ std::to_chars(
+					index.data(), index.data() + index.size(), i++
+				).ptr };
+				const auto digits{
+					static_cast<std::size_t>(end - index.data())
+				};
+				put("\tLap ");
+				for (std::size_t pad{ digits }; pad < max_digits; ++pad)
+					put(" ");
+				put(std::string_view(index.data(), digits));
+				put(": ");
+			}
+			out = format_duration(out, lap, format);
+			put(human ? " \n" : "\n");
+		}
+	}
+	return out;
+}
+
+/**
+@returns The statistics and individual lap durations of @p sw formatted by
+	<tt>@ref format_full()</tt> in @p format, which is much faster than the
+	configurable formatters for stopwatches with many laps.
+*/
+template <fgl::traits::steady_clock T_clock, lap_record T_record>
+[[nodiscard]] inline std::string to_string_full(
+	const generic_stopwatch<T_clock, T_record>& sw,
+	const duration_format format)
+{
+	std::string s;
+	s.reserve(256 + sw.number_of_laps() * 16);
+	format_full(std::back_inserter(s), sw, format);
+	return s;
+}
+
 ///@} Loose Helper Functions
 
 } // namespace fgl::debug
@@ -0,0 +1,462 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_BASELINE_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_BASELINE_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t, byte
+#include <cstdint> // uint64_t
+#include <algorithm> // sort, copy
+#include <array>
+#include <chrono>
+#include <cmath> // erfc, sqrt
+#include <concepts> // integral
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <sstream>
+#include <stdexcept> // runtime_error
+#include <string>
+#include <vector>
+
+#include "../../types/traits.hpp"
+#include "../../io/binary_files.hpp"
+#include "../constexpr_assert.hpp"
+#include "../output.hpp"
+#include "../stopwatch.hpp"
+#include "./statistics.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+
+@defgroup group-debug-stopwatch-baseline Stopwatch Baselines
+
+@ingroup group-debug-stopwatch
+
+@brief Saving lap distributions and detecting performance regressions
+
+@details
+	<tt>@ref fgl::debug::write_baseline()</tt> saves every lap of a stopwatch
+	to a compact binary file with <tt>fgl::write_binary_file()</tt>. A later
+	run can be compared against it with
+	<tt>@ref fgl::debug::compare_to_baseline()</tt>, which uses a one-sided
+	Mann-Whitney U test to decide whether the new laps are slower.
+
+	The Mann-Whitney U test compares the ranks of the laps rather than their
+	values, so it makes no assumption about the shape of the distributions
+	and isn't swayed by a few extreme laps. A regression is reported only if
+	the difference is both significant (its p-value is below
+	<tt>significance</tt>) and large enough to matter (its effect size is at
+	least <tt>minimum_effect_size</tt>). The effect size is the
+	Vargha-Delaney <i>A</i>: the probability that a random new lap is slower
+	than a random baseline lap, where <tt>0.5</tt> means no difference and
+	<tt>0.56</tt>, <tt>0.64</tt>, and <tt>0.71</tt> are conventionally
+	small, medium, and large.
+
+	@code
+	if (!std::filesystem::exists("parse.baseline"))
+		fgl::debug::write_baseline("parse.baseline", sw);
+	const auto comparison{
+		fgl::debug::compare_to_baseline("parse.baseline", sw)
+	};
+	fgl::debug::output(comparison);
+	return comparison.passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+	@endcode
+
+	A baseline file holds an 8 byte signature, the numerator and denominator
+	of the lap duration's period and the number of laps as 64-bit
+	little-endian integers, and then the laps in ascending order. The first
+	lap and the difference between each lap and its predecessor are encoded
+	as LEB128 variable-length integers, which takes one or two bytes for
+	most laps.
+@{
+*/
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+inline constexpr std::array<char, 8> baseline_signature{
+	'F', 'G', 'L', 'L', 'A', 'P', 'S', '1'
+};
+
+constexpr void append_u64(std::vector<std::byte>& out, std::uint64_t value)
+{
+	for (int i{}; i < 8; ++i, value >>= 8)
+		out.push_back(static_cast<std::byte>(value & 0xFF));
+}
+
+constexpr void append_leb128(std::vector<std::byte>& out, std::uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<std::byte>(value));
+}
+
+/// Reads from a span of bytes, throwing if it ends prematurely
+struct baseline_reader
+{
+	std::span<const std::byte> bytes;
+	std::size_t position{};
+
+	[[nodiscard]] constexpr std::byte next()
+	{
+		if (position >= bytes.size())
+			throw std::runtime_error("Baseline is truncated");
+		return bytes[position++];
+	}
+
+	[[nodiscard]] constexpr std::uint64_t u64()
+	{
+		std::uint64_t value{};
+		for (int i{}; i < 8; ++i)
+			value |= std::to_integer<std::uint64_t>(next()) << (8 * i);
+		return value;
+	}
+
+	[[nodiscard]] constexpr std::uint64_t leb128()
+	{
+		std::uint64_t value{};
+		for (int shift{}; shift < 64; shift += 7)
+		{
+			const auto b{ std::to_integer<std::uint64_t>(next()) };
+			value |= (b & 0x7F) << shift;
+			if ((b & 0x80) == 0)
+				return value;
+		}
+		throw std::runtime_error("Baseline contains an invalid lap");
+	}
+};
+
+} // namespace internal
+///@endcond
+
+/**
+@{ @name Baseline Encoding
+*/
+
+/**
+@returns The baseline file contents which represent @p laps
+@param laps The lap durations, which mustn't be negative
+*/
+template <typename T_duration>
+requires std::integral<typename T_duration::rep>
+[[nodiscard]] constexpr std::vector<std::byte> encode_baseline(
+	const std::span<const T_duration> laps)
+{
+	using period = typename T_duration::period;
+	std::vector<T_duration> sorted(laps.begin(), laps.end());
+	std::ranges::sort(sorted);
+	FGL_DEBUG_CONSTEXPR_ASSERT(
+		sorted.empty() || sorted.front() >= T_duration::zero()
+	);
+
+	std::vector<std::byte> out;
+	out.reserve(32 + sorted.size() * 2);
+	for (const char c : internal::baseline_signature)
+		out.push_back(static_cast<std::byte>(c));
+	internal::append_u64(out, static_cast<std::uint64_t>(period::num));
+	internal::append_u64(out, static_cast<std::uint64_t>(period::den));
+	internal::append_u64(out, sorted.size());
+	T_duration previous{};
+	for (const T_duration lap : sorted)
+	{
+		internal::append_leb128(
+			out,
+			static_cast<std::uint64_t>((lap - previous).count())
+		);
+		previous = lap;
+	}
+	return out;
+}
+
+/**
+@returns The laps represented by baseline file contents, in ascending order
+@param bytes The contents of a baseline file
+@throws std::runtime_error if @p bytes isn't a baseline, or its laps have a
+	different period than @p T_duration
+*/
+template <typename T_duration>
+requires std::integral<typename T_duration::rep>
+[[nodiscard]] constexpr std::vector<T_duration> decode_baseline(
+	const std::span<const std::byte> bytes)
+{
+	using period = typename T_duration::period;
+	using rep_t = typename T_duration::rep;
+	internal::baseline_reader reader{ bytes };
+	for (const char c : internal::baseline_signature)
+		if (reader.next() != static_cast<std::byte>(c))
+			throw std::runtime_error("Not a baseline");
+	const std::uint64_t num{ reader.u64() };
+	const std::uint64_t den{ reader.u64() };
+	if (num != static_cast<std::uint64_t>(period::num)
+		|| den != static_cast<std::uint64_t>(period::den))
+		throw std::runtime_error("Baseline laps have a different period");
+
+	const std::uint64_t count{ reader.u64() };
+	if (count > bytes.size() - reader.position) // at least one byte per lap
+		throw std::runtime_error("Baseline is truncated");
+	std::vector<T_duration> laps;
+	laps.reserve(static_cast<std::size_t>(count));
+	std::uint64_t value{};
+	for (std::uint64_t i{}; i < count; ++i)
+	{
+		value += reader.leb128();
+		constexpr auto max_rep{ std::numeric_limits<rep_t>::max() };
+		if (value > static_cast<std::uint64_t>(max_rep))
+			throw std::runtime_error("Baseline contains an invalid lap");
+		laps.emplace_back(static_cast<rep_t>(value));
+	}
+	return laps;
+}
+///@} Baseline Encoding
+
+/**
+@{ @name Baseline Files
+*/
+
+/**
+@brief Writes every lap of @p sw to the baseline file @p path
+@throws [various] exceptions from <tt>fgl::write_binary_file()</tt>
+*/
+template <fgl::traits::steady_clock T_clock, indexed_lap_record T_record>
+void write_baseline(
+	const std::filesystem::path& path,
+	const generic_stopwatch<T_clock, T_record>& sw)
+{
+	using duration_t = typename T_record::duration_t;
+	const auto& laps{ sw.get_all_laps() };
+	const std::vector<duration_t> copy(laps.begin(), laps.end());
+	fgl::write_binary_file(path, encode_baseline(std::span(copy)));
+}
+
+/**
+@returns The laps of the baseline file @p path, in ascending order
+@throws std::runtime_error if the file isn't a baseline of @p T_duration
+@throws [various] exceptions from <tt>fgl::read_binary_file()</tt>
+*/
+template <typename T_duration>
+requires std::integral<typename T_duration::rep>
+[[nodiscard]] std::vector<T_duration> read_baseline(
+	const std::filesystem::path& path)
+{
+	const std::vector<std::byte> bytes{ fgl::read_binary_file(path) };
+	return decode_baseline<T_duration>(bytes);
+}
+///@} Baseline Files
+
+/// The thresholds which a difference must exceed to be a regression
+struct baseline_criteria
+{
+	/// The p-value below which a difference is significant
+	double significance{ 0.01 };
+
+	/// The effect size at or above which a difference matters
+	double minimum_effect_size{ 0.64 };
+};
+
+/**
+@brief The result of comparing laps to a baseline.
+@tparam T_duration The <tt>std::chrono::duration</tt> type of the laps.
+*/
+template <typename T_duration>
+struct baseline_comparison
+{
+	using duration_t = T_duration;
+
+	/// The name of the compared stopwatch, if any
+	std::string name{};
+
+	/// The number of baseline laps
+	std::size_t baseline_laps{};
+
+	/// The number of candidate laps
+	std::size_t candidate_laps{};
+
+	/// The median baseline lap
+	duration_t baseline_median{};
+
+	/// The median candidate lap
+	duration_t candidate_median{};
+
+	/// The Mann-Whitney U statistic of the candidate laps
+	double u{};
+
+	/// The standard score of <tt>u</tt>, corrected for ties and continuity
+	double z{};
+
+	/// The probability of a difference at least this slow if there were none
+	double p_value{ 1.0 };
+
+	/// The probability that a candidate lap is slower than a baseline lap
+	double effect_size{ 0.5 };
+
+	/// Whether the candidate laps are a significant and large regression
+	bool regression{ false };
+
+	/// @returns <tt>true</tt> if the candidate laps aren't a regression
+	[[nodiscard]] constexpr bool passed() const noexcept
+	{ return !regression; }
+};
+
+/**
+@{ @name Baseline Comparison
+*/
+
+/**
+@returns The comparison of @p candidate laps to @p baseline laps
+@param baseline The laps of the baseline
+@param candidate The laps to compare against the baseline
+@param criteria The thresholds for a difference to be a regression
+*/
+template <typename T_duration>
+[[nodiscard]] baseline_comparison<T_duration> compare_to_baseline(
+	const std::span<const T_duration> baseline,
+	const std::span<const T_duration> candidate,
+	const baseline_criteria& criteria = {})
+{
+	using statistics_t = lap_statistics<T_duration>;
+	std::vector<T_duration> b(baseline.begin(), baseline.end());
+	std::vector<T_duration> c(candidate.begin(), candidate.end());
+	std::ranges::sort(b);
+	std::ranges::sort(c);
+
+	baseline_comparison<T_duration> result;
+	result.baseline_laps = b.size();
+	result.candidate_laps = c.size();
+	result.baseline_median = statistics_t::get_median(b);
+	result.candidate_median = statistics_t::get_median(c);
+	if (b.empty() || c.empty())
+		return result;
+
+	// walk both in ascending order, giving tied laps their average rank
+	double candidate_rank_sum{};
+	double tie_correction{};
+	double rank{ 1.0 };
+	for (std::size_t i{}, j{}; i < b.size() || j < c.size();)
+	{
+		const T_duration value{
+			(j == c.size() || (i < b.size() && b[i] < c[j])) ? b[i] : c[j]
+		};
+		std::size_t tied_b{}, tied_c{};
+		while (i < b.size() && b[i] == value) { ++i; ++tied_b; }
+		while (j < c.size() && c[j] == value) { ++j; ++tied_c; }
+		const auto tied{ static_cast<double>(tied_b + tied_c) };
+		candidate_rank_sum +=
+			static_cast<double>(tied_c) * (rank + (tied - 1.0) / 2.0);
+		tie_correction += tied * tied * tied - tied;
+		rank += tied;
+	}
+
+	const auto nb{ static_cast<double>(b.size()) };
+	const auto nc{ static_cast<double>(c.size()) };
+	const double n{ nb + nc };
+	result.u = candidate_rank_sum - nc * (nc + 1.0) / 2.0;
+	result.effect_size = result.u / (nb * nc);
+	const double variance{
+		nb * nc / 12.0 * ((n + 1.0) - tie_correction / (n * (n - 1.0)))
+	};
+	if (variance > 0.0)
+	{
+		result.z = (result.u - nb * nc / 2.0 - 0.5) / std::sqrt(variance);
+		result.p_value = 0.5 * std::erfc(result.z / std::sqrt(2.0));
+	}
+	result.regression =
+		result.p_value < criteria.significance
+		&& result.effect_size >= criteria.minimum_effect_size;
+	return result;
+}
+
+/**
+@returns The comparison of the laps of @p sw to the baseline file @p path
+@throws [various] exceptions from <tt>@ref read_baseline()</tt>
+*/
+template <fgl::traits::steady_clock T_clock, indexed_lap_record T_record>
+[[nodiscard]] baseline_comparison<typename T_record::duration_t>
+compare_to_baseline(
+	const std::filesystem::path& path,
+	const generic_stopwatch<T_clock, T_record>& sw,
+	const baseline_criteria& criteria = {})
+{
+	using duration_t = typename T_record::duration_t;
+	const std::vector<duration_t> baseline{ read_baseline<duration_t>(path) };
+	const auto& laps{ sw.get_all_laps() };
+	const std::vector<duration_t> candidate(laps.begin(), laps.end());
+	auto result{
+		compare_to_baseline(
+			std::span<const duration_t>(baseline),
+			std::span<const duration_t>(candidate),
+			criteria
+		)
+	};
+	result.name = sw.name;
+	return result;
+}
+///@} Baseline Comparison
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+static inline constexpr fgl::string_literal baseline_cname{ "BASELINE" };
+} // namespace internal
+///@endcond
+
+/**
+@brief An <tt>fgl::debug::output_handler</tt> specialization for using
+	baseline comparisons with libFGL's @ref group-debug-output.
+@see @ref group-debug-output and <tt>@ref fgl::debug::output::operator()()</tt>
+*/
+template <typename T_duration>
+class output_config<baseline_comparison<T_duration>>
+: public simple_output_channel
+	<
+		true,
+		priority::info,
+		internal::baseline_cname,
+		output_config<baseline_comparison<T_duration>>
+	>
+{
+	output_config(auto&&...) = delete; ///< should never be instantiated
+	public:
+	using channel_t = simple_output_channel
+	<
+		true,
+		priority::info,
+		internal::baseline_cname,
+		output_config<baseline_comparison<T_duration>>
+	>;
+
+	using comparison_t = baseline_comparison<T_duration>;
+
+	/**
+	@brief Comparison formatter method to satisfy
+		<tt>fgl::debug::output_formatter</tt>
+	*/
+	[[nodiscard]] static std::string format(const comparison_t& c)
+	{
+		std::ostringstream oss;
+		oss
+			<< "Baseline comparison: " << c.name
+			<< (c.regression ? " REGRESSED" : " passed")
+			<< "\n\tBaseline median:  " << c.baseline_median
+			<< " (" << c.baseline_laps << " laps)"
+			<< "\n\tCandidate median: " << c.candidate_median
+			<< " (" << c.candidate_laps << " laps)"
+			<< "\n\tMann-Whitney U:   " << c.u << " (z " << c.z
+			<< ", p " << c.p_value << ')'
+			<< "\n\tEffect size (A):  " << c.effect_size;
+		return output::default_fmt_msg(oss.str());
+	}
+};
+
+static_assert(output_handler<
+	output_config<baseline_comparison<std::chrono::nanoseconds>>,
+	baseline_comparison<std::chrono::nanoseconds>
+>);
+
+///@} group-debug-stopwatch-baseline
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_BASELINE_HPP_INCLUDED
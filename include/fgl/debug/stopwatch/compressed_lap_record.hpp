@@ -0,0 +1,298 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_COMPRESSED_LAP_RECORD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_COMPRESSED_LAP_RECORD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t, byte
+#include <cstdint> // uint64_t
+#include <algorithm> // upper_bound
+#include <chrono>
+#include <concepts> // integral
+#include <span>
+#include <vector>
+
+#include "../constexpr_assert.hpp"
+#include "./statistics.hpp"
+#include "./lap_record.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch-lap_records
+@{
+*/
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/// Maps signed differences onto unsigned values, so small ones stay small
+[[nodiscard]] constexpr std::uint64_t zigzag_encode(const std::uint64_t delta)
+noexcept
+{ return (delta << 1) ^ (0 - (delta >> 63)); }
+
+[[nodiscard]] constexpr std::uint64_t zigzag_decode(const std::uint64_t value)
+noexcept
+{ return (value >> 1) ^ (0 - (value & 1)); }
+
+} // namespace internal
+///@endcond
+
+/**
+@brief A lap record which retains every lap, compressed as the variable
+	length difference between each lap and its predecessor.
+@details Each lap is stored as the zigzag-encoded difference from the
+	previous lap, as a LEB128 variable-length integer. Laps which are short,
+	or which are similar to their predecessor, take one or two bytes rather
+	than the eight of a <tt>@ref vector_lap_record</tt>.
+
+	The encoded laps are appended to chunks of @p T_chunk_bytes bytes which
+	are allocated once and never reallocated, so memory grows without the
+	copying and transient doubling of a growing <tt>std::vector</tt>. Every
+	chunk begins anew from a previous lap of zero, so it can be decoded
+	independently of the others.
+
+	Laps are decoded sequentially, so statistics and
+	<tt>@ref laps()</tt> are <tt>O(n)</tt>, as with the other records, but
+	accessing a single lap with <tt>@ref at()</tt> decodes its chunk up to
+	that lap. The sum of the laps is maintained as they're recorded.
+@tparam T_duration The lap duration type, which must have an integral
+	representation of at most 64 bits.
+@tparam T_chunk_bytes The size of each chunk of encoded laps.
+*/
+template <typename T_duration, std::size_t T_chunk_bytes = 16384>
+requires std::integral<typename T_duration::rep>
+class compressed_lap_record
+{
+	public:
+	using duration_t = T_duration;
+	using statistics_t = lap_statistics<duration_t>;
+
+	/// The size of each chunk of encoded laps
+	static constexpr std::size_t chunk_bytes{ T_chunk_bytes };
+
+	/// The longest encoding of a single lap
+	static constexpr std::size_t max_lap_bytes{ 10 };
+
+	static_assert(sizeof(typename duration_t::rep) <= sizeof(std::uint64_t));
+	static_assert(chunk_bytes >= max_lap_bytes);
+
+	private:
+	using rep_t = typename duration_t::rep;
+
+	struct chunk
+	{
+		/// The encoded laps; never grows beyond its initial capacity
+		std::vector<std::byte> bytes{};
+
+		/// The number of laps recorded before the first lap of this chunk
+		std::size_t first_lap{};
+	};
+
+	std::vector<chunk> m_chunks{};
+	std::size_t m_size{};
+	duration_t m_previous{};
+	duration_t m_total{};
+
+	/// Decodes laps sequentially from a chunk
+	struct decoder
+	{
+		const std::byte* position{};
+		std::uint64_t previous{};
+
+		[[nodiscard]] constexpr duration_t next() noexcept
+		{
+			std::uint64_t value{};
+			for (int shift{};; shift += 7)
+			{
+				const auto b{ std::to_integer<std::uint64_t>(*position++) };
+				value |= (b & 0x7F) << shift;
+				if ((b & 0x80) == 0)
+					break;
+			}
+			previous += internal::zigzag_decode(value);
+			return duration_t{ static_cast<rep_t>(previous) };
+		}
+	};
+
+	/// Calls @p f with laps [<tt>start_lap</tt>, <tt>end_lap</tt>), in order
+	constexpr void decode(
+		const std::size_t start_lap,
+		const std::size_t end_lap,
+		auto&& f) const
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(start_lap <= end_lap);
+		FGL_DEBUG_CONSTEXPR_ASSERT(end_lap <= m_size);
+		if (start_lap == end_lap)
+			return;
+		// the last chunk whose first lap isn't after start_lap
+		auto it{ std::upper_bound(
+			m_chunks.cbegin(),
+			m_chunks.cend(),
+			start_lap,
+			[](const std::size_t index, const chunk& c)
+			{ return index < c.first_lap; }
+		) };
+		--it;
+		std::size_t lap{ it->first_lap };
+		for (; it != m_chunks.cend() && lap < end_lap; ++it)
+		{
+			decoder d{ it->bytes.data() };
+			const std::byte* const last{ it->bytes.data() + it->bytes.size() };
+			for (; d.position != last && lap < end_lap; ++lap)
+			{
+				const duration_t duration{ d.next() };
+				if (lap >= start_lap)
+					f(duration);
+			}
+		}
+	}
+
+	public:
+	/// Reserves the chunk index for about @p capacity laps of two bytes each
+	constexpr void reserve(const std::size_t capacity)
+	{ m_chunks.reserve((capacity * 2) / chunk_bytes + 1); }
+
+	/// Encodes and stores @p lap
+	constexpr void record(const duration_t lap)
+	{
+		if (m_chunks.empty()
+			|| m_chunks.back().bytes.size() + max_lap_bytes > chunk_bytes)
+		{
+			m_chunks.push_back({ {}, m_size });
+			m_chunks.back().bytes.reserve(chunk_bytes);
+			m_previous = duration_t{};
+		}
+		std::vector<std::byte>& bytes{ m_chunks.back().bytes };
+		// the difference wraps around, as does its decoding
+		std::uint64_t value{ internal::zigzag_encode(
+			static_cast<std::uint64_t>(lap.count())
+			- static_cast<std::uint64_t>(m_previous.count())
+		) };
+		while (value >= 0x80)
+		{
+			bytes.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		bytes.push_back(static_cast<std::byte>(value));
+		m_previous = lap;
+		m_total += lap;
+		++m_size;
+	}
+
+	/// Discards all laps and releases their chunks
+	constexpr void clear() noexcept
+	{
+		m_chunks.clear();
+		m_size = 0;
+		m_previous = duration_t{};
+		m_total = duration_t{};
+	}
+
+	/// @returns The number of recorded laps
+	[[nodiscard]] constexpr std::size_t size() const noexcept
+	{ return m_size; }
+
+	/// @returns The number of bytes of encoded laps
+	[[nodiscard]] constexpr std::size_t compressed_size() const noexcept
+	{
+		std::size_t bytes{};
+		for (const chunk& c : m_chunks)
+			bytes += c.bytes.size();
+		return bytes;
+	}
+
+	/// @returns The number of bytes allocated for chunks
+	[[nodiscard]] constexpr std::size_t allocated_size() const noexcept
+	{ return m_chunks.size() * chunk_bytes; }
+
+	/**
+	@brief Calls @p f with every lap, in the order they were recorded.
+	@details This is the most efficient way to export the laps without
+		decompressing them into memory.
+	*/
+	constexpr void for_each(auto&& f) const
+	{ decode(0, m_size, f); }
+
+	/// @returns The duration of lap number @p index
+	[[nodiscard]] constexpr duration_t at(const std::size_t index) const
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(index < m_size);
+		duration_t lap{};
+		decode(index, index + 1, [&lap](const duration_t d){ lap = d; });
+		return lap;
+	}
+
+	/// @returns The most recently recorded lap
+	[[nodiscard]] constexpr duration_t back() const
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_size > 0);
+		return m_previous;
+	}
+
+	/// @returns A decompressed copy of the laps
+	[[nodiscard]] constexpr std::vector<duration_t> laps() const
+	{
+		std::vector<duration_t> v;
+		v.reserve(m_size);
+		for_each([&v](const duration_t lap){ v.push_back(lap); });
+		return v;
+	}
+
+	/// @returns The sum of laps [<tt>start_lap</tt>, <tt>end_lap</tt>)
+	[[nodiscard]] constexpr duration_t total_between(
+		const std::size_t start_lap,
+		const std::size_t end_lap) const
+	{
+		duration_t sum{};
+		decode(start_lap, end_lap, [&sum](const duration_t d){ sum += d; });
+		return sum;
+	}
+
+	/// @returns The sum of all recorded laps
+	[[nodiscard]] constexpr duration_t total() const noexcept
+	{ return m_total; }
+
+	/**
+	@returns Exact statistics calculated by selection from a decompressed
+		copy of the laps
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles = {}) const
+	{
+		std::vector<duration_t> scratch;
+		return calculate_statistics(percentiles, scratch);
+	}
+
+	/**
+	@returns Exact statistics calculated by selection from the laps
+		decompressed into @p scratch, which only allocates if it has less
+		capacity than the number of laps.
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	@param scratch A buffer which can be reused between calls.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles,
+		std::vector<duration_t>& scratch) const
+	{
+		scratch.clear();
+		scratch.reserve(m_size);
+		for_each([&scratch](const duration_t lap){ scratch.push_back(lap); });
+		return statistics_t::from_unsorted(scratch, percentiles);
+	}
+};
+
+static_assert(
+	indexed_lap_record<compressed_lap_record<std::chrono::nanoseconds>>
+);
+static_assert(
+	scratch_lap_record<compressed_lap_record<std::chrono::nanoseconds>>
+);
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_COMPRESSED_LAP_RECORD_HPP_INCLUDED
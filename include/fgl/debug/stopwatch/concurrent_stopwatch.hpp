@@ -0,0 +1,378 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_CONCURRENT_STOPWATCH_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_CONCURRENT_STOPWATCH_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <atomic>
+#include <array>
+#include <bit> // bit_ceil
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread> // hardware_concurrency, yield
+#include <utility> // move
+#include <vector>
+
+#include "../../_experimental/environment/hardware.hpp"
+#include "../../types/traits.hpp"
+#include "../constexpr_assert.hpp"
+#include "../stopwatch.hpp"
+#include "./streaming_lap_record.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch
+@{
+*/
+
+/**
+@brief A stopwatch which may be shared by any number of threads.
+@details Laps are recorded into per-thread shards, each of which occupies its
+	own <tt>fgl::hardware::dis</tt> aligned cache line(s), so threads don't
+	contend with one another on the hot path. Every shard maintains the
+	running aggregates of a <tt>@ref streaming_lap_record</tt>.
+
+	Each shard is guarded by a sequence lock. Recording a lap makes the
+	sequence odd, updates the aggregates, and makes the sequence even again.
+	Readers never block writers: they retry their copy of a shard if its
+	sequence was odd or changed while it was being read. This allows
+	statistics to be collected at any time, while the writers continue
+	recording.
+
+	Laps are also accumulated per interval, so that the laps recorded since
+	the previous interval can be taken with <tt>@ref take_interval()</tt>
+	without disturbing the writers, or reported periodically by a
+	<tt>@ref generic_interval_reporter</tt>.
+
+	Unlike <tt>@ref generic_stopwatch</tt>, a concurrent stopwatch doesn't
+	hold a start time. <tt>@ref start()</tt> returns the time point which
+	must later be passed to <tt>@ref stop()</tt> by the same caller.
+
+	@code
+	fgl::debug::concurrent_stopwatch csw("request handler");
+	// on any number of threads:
+	const auto start{ csw.start() };
+	handle_request();
+	csw.stop(start);
+	// on any thread, at any time:
+	const auto stats{ csw.calculate_statistics() };
+	@endcode
+
+@note Threads are assigned to shards in the order that they first record a
+	lap. If more threads record laps than there are shards, some threads will
+	share a shard, which remains correct but may contend.
+@tparam T_clock A @ref fgl::traits::steady_clock to be used by the
+	stopwatch. <tt>std::chrono::steady_clock</tt> by default.
+*/
+template <fgl::traits::steady_clock T_clock = std::chrono::steady_clock>
+class generic_concurrent_stopwatch
+{
+public:
+	/// The clock which the stopwatch is using
+	using clock_t = T_clock;
+
+	/// The type of time point the stopwatch's interface uses
+	using time_point_t = std::chrono::time_point<clock_t>;
+
+	/// The duration type of the clock
+	using duration_t = typename T_clock::duration;
+
+	/// The lap record produced by merging the shards
+	using record_t = streaming_lap_record<duration_t>;
+
+	/// The statistics type produced by the merged lap record
+	using statistics = typename record_t::statistics_t;
+
+private:
+	using aggregates_t = typename record_t::aggregates;
+	using rep_t = typename duration_t::rep;
+
+	/// Running aggregates which may be copied while they're being updated
+	struct atomic_aggregates
+	{
+		std::atomic<std::size_t> count{ 0 };
+		std::atomic<rep_t> total{ 0 };
+		std::atomic<rep_t> min{ 0 };
+		std::atomic<rep_t> max{ 0 };
+		std::atomic<rep_t> last{ 0 };
+		std::atomic<double> mean{ 0.0 };
+		std::atomic<double> m2{ 0.0 };
+
+		[[nodiscard]] aggregates_t load() const noexcept
+		{
+			constexpr auto relaxed{ std::memory_order_relaxed };
+			return {
+				count.load(relaxed),
+				duration_t{ total.load(relaxed) },
+				duration_t{ min.load(relaxed) },
+				duration_t{ max.load(relaxed) },
+				duration_t{ last.load(relaxed) },
+				mean.load(relaxed),
+				m2.load(relaxed)
+			};
+		}
+
+		void store(const aggregates_t& a) noexcept
+		{
+			constexpr auto relaxed{ std::memory_order_relaxed };
+			count.store(a.count, relaxed);
+			total.store(a.total.count(), relaxed);
+			min.store(a.min.count(), relaxed);
+			max.store(a.max.count(), relaxed);
+			last.store(a.last.count(), relaxed);
+			mean.store(a.mean, relaxed);
+			m2.store(a.m2, relaxed);
+		}
+
+		/// Adds @p lap to the aggregates
+		void record(const duration_t lap) noexcept
+		{
+			record_t r(load());
+			r.record(lap);
+			store(r.get_aggregates());
+		}
+	};
+
+	/// The running aggregates of the laps recorded by a group of threads
+	struct alignas(fgl::hardware::dis) shard
+	{
+		/// Odd while a writer is updating the aggregates
+		std::atomic<std::uint64_t> sequence{ 0 };
+
+		/// Every lap since construction or the last reset
+		atomic_aggregates cumulative{};
+
+		/// Laps of the current and previous intervals, selected by the epoch
+		std::array<atomic_aggregates, 2> windows{};
+
+		/// Makes the sequence odd. @returns The odd sequence number.
+		std::uint64_t lock_writer() noexcept
+		{
+			std::uint64_t expected{ sequence.load(std::memory_order_relaxed) };
+			for (;;)
+			{
+				// sequentially consistent so that the interval epoch, which
+				// is loaded while locked, can't be reordered before the lock
+				if (expected % 2 == 0 && sequence.compare_exchange_weak(
+					expected,
+					expected + 1,
+					std::memory_order_seq_cst,
+					std::memory_order_relaxed))
+				{
+					// aggregate stores mustn't become visible before the lock
+					std::atomic_thread_fence(std::memory_order_release);
+					return expected + 1;
+				}
+				if (expected % 2 != 0)
+				{
+					std::this_thread::yield();
+					expected = sequence.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		/// Makes the odd sequence number @p locked_sequence even
+		void unlock_writer(const std::uint64_t locked_sequence) noexcept
+		{ sequence.store(locked_sequence + 1, std::memory_order_release); }
+
+		/// @returns A consistent copy of the cumulative aggregates, without
+		/// locking
+		[[nodiscard]] aggregates_t read() const noexcept
+		{
+			for (;;)
+			{
+				const std::uint64_t before{
+					sequence.load(std::memory_order_acquire)
+				};
+				if (before % 2 != 0)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				const aggregates_t copy{ cumulative.load() };
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence.load(std::memory_order_relaxed) == before)
+					return copy;
+			}
+		}
+	};
+
+	/// Always a power of two, so a shard can be selected with a mask
+	std::vector<shard> m_shards;
+
+	/// Selects which of each shard's windows is being recorded into
+	std::atomic<std::uint64_t> m_epoch{ 0 };
+
+	/// Serializes collectors of intervals; never acquired by writers
+	std::mutex m_interval_mutex{};
+
+	[[nodiscard]] shard& local_shard() noexcept
+	{ return m_shards[internal::thread_ordinal() & (m_shards.size() - 1)]; }
+
+public:
+	/// The name of the stopwatch
+	std::string name;
+
+	/// @returns The number of hardware threads, or <tt>1</tt> if unknown
+	[[nodiscard]] static std::size_t default_shard_count() noexcept
+	{
+		const unsigned int n{ std::thread::hardware_concurrency() };
+		return n != 0 ? n : 1;
+	}
+
+	/**
+	@{ @name Constructors
+	@param in_name The name of the stopwatch. If no name is provided, the
+		name will be created from the source location.
+	@param shard_count The number of shards that laps are recorded into.
+		Rounded up to a power of two. Defaults to the number of hardware
+		threads.
+	*/
+	[[nodiscard]] explicit generic_concurrent_stopwatch(
+		std::string&& in_name = internal::function_in_file(),
+		const std::size_t shard_count = default_shard_count())
+	:
+		m_shards(std::bit_ceil(shard_count != 0 ? shard_count : 1)),
+		name(std::move(in_name))
+	{}
+
+	generic_concurrent_stopwatch(const generic_concurrent_stopwatch&) = delete;
+	generic_concurrent_stopwatch& operator=(
+		const generic_concurrent_stopwatch&) = delete;
+	///@} Constructors
+
+	/**
+	@{ @name Stopwatch Recording Methods
+	@brief These methods may be called concurrently from any thread.
+	*/
+
+	/// @returns <tt>time_point</tt>, to later be passed to <tt>stop()</tt>
+	[[nodiscard]] time_point_t start(
+		const time_point_t time_point = clock_t::now()) const noexcept
+	{ return time_point; }
+
+	/**
+	@brief Records a lap whose duration is <tt>start_point</tt> subtracted
+		from <tt>time_point</tt>.
+	@param start_point A time point previously returned by <tt>start()</tt>
+	@param time_point The time point which marks the end of the lap
+	*/
+	void stop(
+		const time_point_t start_point,
+		const time_point_t time_point = clock_t::now()) noexcept
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(time_point >= start_point);
+		record(time_point - start_point);
+	}
+
+	/// Records @p lap into the calling thread's shard
+	void record(const duration_t lap) noexcept
+	{
+		shard& s{ local_shard() };
+		const std::uint64_t locked_sequence{ s.lock_writer() };
+		const std::uint64_t epoch{ m_epoch.load(std::memory_order_seq_cst) };
+		s.cumulative.record(lap);
+		s.windows[epoch % 2].record(lap);
+		s.unlock_writer(locked_sequence);
+	}
+
+	/**
+	@brief Discards the laps recorded by every shard.
+	@note Laps which are recorded concurrently with a reset may or may not be
+		discarded.
+	*/
+	void reset() noexcept
+	{
+		for (shard& s : m_shards)
+		{
+			const std::uint64_t locked_sequence{ s.lock_writer() };
+			s.cumulative.store(aggregates_t{});
+			s.windows[0].store(aggregates_t{});
+			s.windows[1].store(aggregates_t{});
+			s.unlock_writer(locked_sequence);
+		}
+	}
+	///@} Stopwatch Recording Methods
+
+	/// @returns The number of shards
+	[[nodiscard]] std::size_t number_of_shards() const noexcept
+	{ return m_shards.size(); }
+
+	/**
+	@returns A lap record containing the merged aggregates of every shard.
+	@details Each shard is read consistently, but shards are read one after
+		another while writers may still be recording. The result is therefore
+		a snapshot of every shard, not of a single instant.
+	*/
+	[[nodiscard]] record_t snapshot() const noexcept
+	{
+		record_t merged;
+		for (const shard& s : m_shards)
+			merged.merge(record_t(s.read()));
+		return merged;
+	}
+
+	/// @returns The number of recorded laps
+	[[nodiscard]] std::size_t number_of_laps() const noexcept
+	{ return snapshot().size(); }
+
+	/// @returns The sum of all recorded lap durations
+	[[nodiscard]] duration_t elapsed() const noexcept
+	{ return snapshot().total(); }
+
+	/**
+	@returns The statistics of a <tt>@ref snapshot()</tt>. As the laps
+		aren't retained, the median is empty.
+	*/
+	[[nodiscard]] statistics calculate_statistics() const noexcept
+	{ return snapshot().calculate_statistics(); }
+
+	/**
+	@returns A lap record containing only the laps which were recorded since
+		the previous call, or since construction or a reset.
+	@details Each shard's interval aggregates are double-buffered. Taking an
+		interval advances an epoch which switches writers to the other
+		buffer, waits for any writer which may still be recording into the
+		previous buffer to unlock its shard, and then collects and clears the
+		previous buffer. Writers are never blocked by a collector, so this
+		can be called periodically, such as by a
+		<tt>@ref generic_interval_reporter</tt>, while laps are recorded.
+	@note Concurrent calls are serialized. Each lap belongs to exactly one
+		interval.
+	*/
+	[[nodiscard]] record_t take_interval()
+	{
+		const std::scoped_lock lock(m_interval_mutex);
+		const std::uint64_t epoch{ m_epoch.load(std::memory_order_relaxed) };
+		m_epoch.store(epoch + 1, std::memory_order_seq_cst);
+
+		record_t interval;
+		for (shard& s : m_shards)
+		{
+			// a writer which locked before the epoch advanced may still be
+			// recording into the previous window
+			const std::uint64_t sequence{
+				s.sequence.load(std::memory_order_seq_cst)
+			};
+			if (sequence % 2 != 0)
+				while (s.sequence.load(std::memory_order_acquire) == sequence)
+					std::this_thread::yield();
+			atomic_aggregates& window{ s.windows[epoch % 2] };
+			interval.merge(record_t(window.load()));
+			window.store(aggregates_t{});
+		}
+		return interval;
+	}
+};
+
+/// A convenient alias for a <tt>std::chrono::steady_clock</tt> stopwatch
+using concurrent_stopwatch = generic_concurrent_stopwatch<>;
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_CONCURRENT_STOPWATCH_HPP_INCLUDED
@@ -0,0 +1,348 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_FORMAT_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_FORMAT_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cstdint> // int64_t
+#include <algorithm> // copy
+#include <array>
+#include <charconv> // to_chars, chars_format
+#include <chrono>
+#include <concepts> // integral
+#include <iterator> // output_iterator
+#include <ratio>
+#include <string_view>
+#include <system_error> // errc
+
+#include "./statistics.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+
+@defgroup group-debug-stopwatch-format Stopwatch Formatting
+
+@ingroup group-debug-stopwatch
+
+@brief Allocation-free formatting of lap durations and statistics
+
+@details
+	These functions format with <tt>std::to_chars</tt> into a caller-supplied
+	character buffer or output iterator, without streams, allocations, or
+	type-erased calls, so that reporting a large number of laps costs far
+	less than recording them. They're used by the default formatters of the
+	stopwatch's <tt>output_config</tt>.
+
+	Two formats are provided by <tt>@ref fgl::debug::duration_format</tt>: a
+	human-readable format which splits a duration into units, such as
+	<tt>1ms 20µs 5ns</tt>, and a compact format for machine parsing, which
+	is the duration's count in its own unit, such as <tt>1020005ns</tt>.
+
+	@code
+	std::string out;
+	for (const auto lap : sw.get_all_laps())
+	{
+		fgl::debug::format_duration(std::back_inserter(out), lap);
+		out += '\n';
+	}
+	@endcode
+@{
+*/
+
+/// The formats produced by <tt>@ref format_duration()</tt>
+enum class duration_format : unsigned char
+{
+	/// Every non-zero unit from years to nanoseconds, such as
+	/// <tt>1ms 20µs 5ns</tt>
+	human,
+
+	/// The count in the duration's own unit, such as <tt>1020005ns</tt>
+	fixed
+};
+
+/**
+@brief The largest number of characters which <tt>@ref format_duration()</tt>
+	produces for a duration whose representation is at most 64 bits.
+*/
+inline constexpr std::size_t max_formatted_duration_size{ 384 };
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/// Writes to a character buffer, and remembers if it ran out of space
+struct char_writer
+{
+	char* position;
+	char* last;
+	bool overflowed{ false };
+
+	constexpr void put(const std::string_view s) noexcept
+	{
+		const auto available{ static_cast<std::size_t>(last - position) };
+		if (overflowed || available < s.size())
+		{
+			overflowed = true;
+			return;
+		}
+		position = std::copy(s.begin(), s.end(), position);
+	}
+
+	template <typename T>
+	void put_number(const T value) noexcept
+	{
+		if (overflowed)
+			return;
+		const auto [end, error]{ std::to_chars(position, last, value) };
+		if (error != std::errc{})
+			overflowed = true;
+		else
+			position = end;
+	}
+
+	void put_general(const double value) noexcept
+	{
+		if (overflowed)
+			return;
+		const auto [end, error]{
+			std::to_chars(position, last, value, std::chars_format::general, 6)
+		};
+		if (error != std::errc{})
+			overflowed = true;
+		else
+			position = end;
+	}
+
+	[[nodiscard]] constexpr std::to_chars_result result() const noexcept
+	{
+		if (overflowed)
+			return { last, std::errc::value_too_large };
+		return { position, std::errc{} };
+	}
+};
+
+/// Writes the unit suffix which the fixed format uses for @p T_period
+template <typename T_period>
+void put_fixed_suffix(char_writer& w) noexcept
+{
+	if constexpr (std::same_as<T_period, std::nano>)
+		w.put("ns");
+	else if constexpr (std::same_as<T_period, std::micro>)
+		w.put("us");
+	else if constexpr (std::same_as<T_period, std::milli>)
+		w.put("ms");
+	else if constexpr (std::same_as<T_period, std::ratio<1>>)
+		w.put("s");
+	else if constexpr (std::same_as<T_period, std::ratio<60>>)
+		w.put("min");
+	else if constexpr (std::same_as<T_period, std::ratio<3600>>)
+		w.put("h");
+	else
+	{
+		w.put("[");
+		w.put_number(T_period::num);
+		if constexpr (T_period::den != 1)
+		{
+			w.put("/");
+			w.put_number(T_period::den);
+		}
+		w.put("]s");
+	}
+}
+
+/// A unit of the human-readable format, and its suffix
+struct human_unit
+{
+	std::int64_t nanoseconds;
+	std::string_view suffix;
+};
+
+/// The suffixes match those of <tt>std::chrono::duration</tt>'s
+/// <tt>operator<<</tt>
+inline constexpr std::array<human_unit, 10> human_units{{
+	{ 31'556'952'000'000'000, "[31556952]s" }, // years
+	{ 2'629'746'000'000'000, "[2629746]s" }, // months
+	{ 604'800'000'000'000, "[604800]s" }, // weeks
+	{ 86'400'000'000'000, "d" },
+	{ 3'600'000'000'000, "h" },
+	{ 60'000'000'000, "min" },
+	{ 1'000'000'000, "s" },
+	{ 1'000'000, "ms" },
+	{ 1'000, "µs" },
+	{ 1, "ns" }
+}};
+
+template <typename T_duration>
+void put_duration(
+	char_writer& w,
+	const T_duration duration,
+	const duration_format format) noexcept
+{
+	if (format == duration_format::fixed)
+	{
+		w.put_number(duration.count());
+		put_fixed_suffix<typename T_duration::period>(w);
+		return;
+	}
+	std::int64_t remaining{
+		std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()
+	};
+	if (remaining == 0)
+	{
+		w.put("0ns");
+		return;
+	}
+	bool first{ true };
+	for (const human_unit& unit : human_units)
+	{
+		const std::int64_t count{ remaining / unit.nanoseconds };
+		if (count == 0)
+			continue;
+		remaining -= count * unit.nanoseconds;
+		if (!first)
+			w.put(" ");
+		first = false;
+		w.put_number(count);
+		w.put(unit.suffix);
+	}
+}
+
+} // namespace internal
+///@endcond
+
+/**
+@{ @name Duration Formatting
+*/
+
+/**
+@brief Formats @p duration into the character range
+	[<tt>first</tt>, <tt>last</tt>).
+@returns Like <tt>std::to_chars</tt>, the end of the formatted characters,
+	or <tt>std::errc::value_too_large</tt> if they didn't fit.
+@note The human-readable format is produced by splitting the duration into
+	nanoseconds, so durations with a finer period are truncated.
+*/
+template <typename T_duration>
+requires std::integral<typename T_duration::rep>
+std::to_chars_result format_duration(
+	char* const first,
+	char* const last,
+	const T_duration duration,
+	const duration_format format = duration_format::human) noexcept
+{
+	internal::char_writer w{ first, last };
+	internal::put_duration(w, duration, format);
+	return w.result();
+}
+
+/**
+@brief Formats @p duration to the output iterator @p out.
+@returns The iterator past the last character written
+*/
+template <std::output_iterator<char> T_iterator, typename T_duration>
+requires std::integral<typename T_duration::rep>
+T_iterator format_duration(
+	T_iterator out,
+	const T_duration duration,
+	const duration_format format = duration_format::human)
+{
+	std::array<char, max_formatted_duration_size> buffer;
+	char* const first{ buffer.data() };
+	const auto [end, error]{
+		format_duration(first, first + buffer.size(), duration, format)
+	};
+	return std::copy(first, end, out);
+}
+///@} Duration Formatting
+
+/**
+@{ @name Statistics Formatting
+*/
+
+/**
+@brief Formats @p stats to the output iterator @p out.
+@details The human-readable format produces a line for each statistic,
+	indented by a tab, such as <tt>"\tMean lap:       57ns"</tt>. The fixed
+	format produces a single line of space-separated <tt>key=value</tt>
+	pairs, such as <tt>"laps=80 total=4560ns mean=57ns ..."</tt>, in which
+	percentiles are keyed as <tt>p99.9</tt>.
+@returns The iterator past the last character written
+*/
+template <std::output_iterator<char> T_iterator, typename T_duration>
+T_iterator format_statistics(
+	T_iterator out,
+	const lap_statistics<T_duration>& stats,
+	const duration_format format = duration_format::human)
+{
+	// the longest line: a label, a number or percentile, and a duration
+	std::array<char, 64 + max_formatted_duration_size> buffer;
+	const auto flush{
+		[&out, &buffer](const internal::char_writer& w)
+		{ out = std::copy(buffer.data(), w.position, out); }
+	};
+	const auto writer{
+		[&buffer]()
+		{
+			char* const first{ buffer.data() };
+			return internal::char_writer{ first, first + buffer.size() };
+		}
+	};
+	const bool human{ format == duration_format::human };
+	const auto line{
+		[&](
+			const std::string_view human_label,
+			const std::string_view fixed_key,
+			const T_duration value)
+		{
+			internal::char_writer w{ writer() };
+			w.put(human ? human_label : fixed_key);
+			internal::put_duration(w, value, format);
+			flush(w);
+		}
+	};
+
+	{
+		internal::char_writer w{ writer() };
+		w.put(human ? "\tNumber of laps: " : "laps=");
+		w.put_number(stats.number_of_laps);
+		flush(w);
+	}
+	line("\n\tTotal elapsed:  ", " total=", stats.total_elapsed);
+	line("\n\tMean lap:       ", " mean=", stats.mean);
+	if (stats.median)
+		line("\n\tMedian lap:     ", " median=", *stats.median);
+	line("\n\tMin lap:        ", " min=", stats.min);
+	line("\n\tMax lap:        ", " max=", stats.max);
+	line("\n\tStd. deviation: ", " stddev=", stats.standard_deviation);
+	for (const auto& [percentile, value] : stats.percentiles)
+	{
+		internal::char_writer w{ writer() };
+		if (human)
+		{
+			// left-aligned in 16 columns, such as "P99.9 lap:      "
+			w.put("\n\tP");
+			char* const label{ w.position - 1 };
+			w.put_general(percentile);
+			w.put(" lap:");
+			const auto width{ static_cast<std::size_t>(w.position - label) };
+			for (std::size_t i{ width }; i < 16; ++i)
+				w.put(" ");
+		}
+		else
+		{
+			w.put(" p");
+			w.put_general(percentile);
+			w.put("=");
+		}
+		internal::put_duration(w, value, format);
+		flush(w);
+	}
+	return out;
+}
+///@} Statistics Formatting
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_FORMAT_HPP_INCLUDED
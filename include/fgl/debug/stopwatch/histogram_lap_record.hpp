@@ -0,0 +1,238 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_HISTOGRAM_LAP_RECORD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_HISTOGRAM_LAP_RECORD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <limits>
+#include <algorithm> // clamp
+#include <array>
+#include <bit> // bit_width
+#include <chrono>
+#include <span>
+
+#include "../constexpr_assert.hpp"
+#include "./statistics.hpp"
+#include "./lap_record.hpp"
+#include "./streaming_lap_record.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch-lap_records
+@{
+*/
+
+/**
+@brief A fixed-footprint, log-linear (HDR-style) histogram lap record.
+@details Laps are counted in buckets whose width grows with the magnitude of
+	the lap: values below <tt>2^T_precision_bits</tt> ticks are counted
+	exactly, and every power-of-two range above that is divided into
+	<tt>2^(T_precision_bits - 1)</tt> equally sized buckets. Recording a lap
+	is <tt>O(1)</tt>, the footprint never grows, and any percentile can be
+	queried without sorting. Histograms of the same type may be merged, for
+	example to combine measurements from several threads.
+
+	Percentiles and the median are approximations whose relative error is
+	at most <tt>@ref max_relative_error</tt>. The count, total, mean,
+	minimum, maximum, and standard deviation are exact, because the running
+	aggregates of a <tt>@ref streaming_lap_record</tt> are maintained
+	alongside the histogram.
+
+@tparam T_duration The lap duration type. Laps are bucketed by their tick
+	count, so a finer duration type yields finer absolute resolution.
+@tparam T_precision_bits Controls the number of buckets per power of two,
+	and therefore the relative error and footprint. The default of <tt>7</tt>
+	bounds the error to under 0.8% with 3776 buckets.
+*/
+template <typename T_duration, unsigned int T_precision_bits = 7>
+requires (T_precision_bits >= 2 && T_precision_bits <= 16)
+class histogram_lap_record
+{
+	public:
+	using duration_t = T_duration;
+	using statistics_t = lap_statistics<duration_t>;
+	using count_t = std::uint64_t;
+
+	private:
+	using value_t = std::size_t;
+	using rep_t = typename duration_t::rep;
+
+	static constexpr value_t sub_bucket_count{ value_t{1} << T_precision_bits };
+	static constexpr value_t half_bucket_count{ sub_bucket_count / 2 };
+
+	static constexpr unsigned int value_bits{
+		std::numeric_limits<value_t>::digits
+	};
+
+	public:
+	/// The number of buckets in the histogram
+	static constexpr std::size_t bucket_count{
+		sub_bucket_count
+		+ (value_bits - T_precision_bits) * half_bucket_count
+	};
+
+	/// The maximum relative error of a reported percentile
+	static constexpr double max_relative_error{
+		1.0 / static_cast<double>(sub_bucket_count)
+	};
+
+	/// @returns The index of the bucket which counts @p value
+	[[nodiscard]] static constexpr
+	std::size_t bucket_index(const value_t value) noexcept
+	{
+		if (value < sub_bucket_count)
+			return value;
+		const auto exponent{
+			static_cast<unsigned int>(std::bit_width(value)) - T_precision_bits
+		};
+		const value_t mantissa{ value >> exponent };
+		return sub_bucket_count
+			+ (exponent - 1) * half_bucket_count
+			+ (mantissa - half_bucket_count);
+	}
+
+	/// @returns The smallest value counted by the bucket at @p index
+	[[nodiscard]] static constexpr
+	value_t bucket_lowest_value(const std::size_t index) noexcept
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(index < bucket_count);
+		if (index < sub_bucket_count)
+			return index;
+		const value_t offset{ index - sub_bucket_count };
+		const value_t exponent{ offset / half_bucket_count + 1 };
+		const value_t mantissa{
+			offset % half_bucket_count + half_bucket_count
+		};
+		return mantissa << exponent;
+	}
+
+	/// @returns The number of values counted by the bucket at @p index
+	[[nodiscard]] static constexpr
+	value_t bucket_width(const std::size_t index) noexcept
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(index < bucket_count);
+		if (index < sub_bucket_count)
+			return 1;
+		const value_t exponent{
+			(index - sub_bucket_count) / half_bucket_count + 1
+		};
+		return value_t{1} << exponent;
+	}
+
+	private:
+	streaming_lap_record<duration_t> m_aggregate{};
+	std::array<count_t, bucket_count> m_buckets{};
+
+	[[nodiscard]] static constexpr value_t to_value(const duration_t lap)
+	noexcept
+	{ return lap.count() > 0 ? static_cast<value_t>(lap.count()) : 0; }
+
+	public:
+	/// Counts @p lap in its bucket and updates the running aggregates
+	constexpr void record(const duration_t lap) noexcept
+	{
+		m_aggregate.record(lap);
+		++m_buckets[bucket_index(to_value(lap))];
+	}
+
+	/**
+	@brief Combines the counts and aggregates of @p other into this record,
+		as if every lap recorded by @p other had been recorded by this record.
+	*/
+	constexpr void merge(const histogram_lap_record& other) noexcept
+	{
+		m_aggregate.merge(other.m_aggregate);
+		for (std::size_t i{}; i < bucket_count; ++i)
+			m_buckets[i] += other.m_buckets[i];
+	}
+
+	/// Discards all counts and aggregates
+	constexpr void clear() noexcept
+	{
+		m_aggregate.clear();
+		m_buckets.fill(0);
+	}
+
+	/// @returns The number of recorded laps
+	[[nodiscard]] constexpr std::size_t size() const noexcept
+	{ return m_aggregate.size(); }
+
+	/// @returns The most recently recorded lap
+	[[nodiscard]] constexpr duration_t back() const noexcept
+	{ return m_aggregate.back(); }
+
+	/// @returns The sum of all recorded laps
+	[[nodiscard]] constexpr duration_t total() const noexcept
+	{ return m_aggregate.total(); }
+
+	/// @returns A view of the bucket counts
+	[[nodiscard]] constexpr std::span<const count_t, bucket_count> buckets()
+	const noexcept
+	{ return m_buckets; }
+
+	/**
+	@returns The approximate lap duration at @p percentile, clamped to the
+		exact minimum and maximum. Zero if no laps have been recorded.
+	@param percentile A percentile in the range <tt>[0, 100]</tt>
+	*/
+	[[nodiscard]] constexpr
+	duration_t value_at_percentile(const double percentile) const noexcept
+	{
+		const std::size_t count{ size() };
+		if (count == 0)
+			return {};
+		const std::size_t rank{
+			statistics_t::percentile_rank(percentile, count)
+		};
+		const statistics_t aggregate{ m_aggregate.calculate_statistics() };
+		count_t cumulative{};
+		for (std::size_t i{}; i < bucket_count; ++i)
+		{
+			cumulative += m_buckets[i];
+			if (cumulative >= rank)
+			{
+				// the midpoint of the bucket halves the worst-case error
+				const value_t midpoint{
+					bucket_lowest_value(i) + (bucket_width(i) - 1) / 2
+				};
+				return std::clamp(
+					duration_t{ static_cast<rep_t>(midpoint) },
+					aggregate.min,
+					aggregate.max
+				);
+			}
+		}
+		return aggregate.max;
+	}
+
+	/**
+	@returns Statistics with exact aggregates and approximate order
+		statistics (the median and percentiles).
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles = {}) const
+	{
+		statistics_t stats{ m_aggregate.calculate_statistics() };
+		if (stats.number_of_laps == 0)
+			return stats;
+		stats.median = value_at_percentile(50.0);
+		stats.percentiles.reserve(percentiles.size());
+		for (const double p : percentiles)
+			stats.percentiles.push_back({ p, value_at_percentile(p) });
+		return stats;
+	}
+};
+
+static_assert(
+	percentile_lap_record<histogram_lap_record<std::chrono::nanoseconds>>
+);
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_HISTOGRAM_LAP_RECORD_HPP_INCLUDED
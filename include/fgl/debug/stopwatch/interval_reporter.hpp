@@ -0,0 +1,267 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_INTERVAL_REPORTER_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_INTERVAL_REPORTER_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstdint> // uint64_t
+#include <chrono>
+#include <condition_variable> // condition_variable_any
+#include <mutex>
+#include <sstream>
+#include <stop_token>
+#include <string>
+#include <thread> // jthread
+
+#include "../../types/traits.hpp"
+#include "../output.hpp"
+#include "../stopwatch.hpp"
+#include "./concurrent_stopwatch.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+
+@defgroup group-debug-stopwatch-interval_reporter Interval Reporter
+
+@ingroup group-debug-stopwatch
+
+@brief Periodic reporting of a concurrent stopwatch's interval statistics
+
+@details
+	A long-running program can't stop its stopwatches to report latency.
+	<tt>@ref fgl::debug::generic_interval_reporter</tt> owns a background
+	thread which, every period, takes the laps recorded since the previous
+	report from a <tt>@ref fgl::debug::generic_concurrent_stopwatch</tt> and
+	sends their statistics to @ref group-debug-output as a
+	<tt>@ref fgl::debug::stopwatch_interval</tt>. Each report covers only its
+	own interval rather than every lap since the stopwatch was constructed,
+	and the threads recording laps are never blocked or stopped.
+
+	@code
+	fgl::debug::concurrent_stopwatch csw("request handler");
+	fgl::debug::interval_reporter reporter(csw, std::chrono::seconds(10));
+	// laps recorded by any thread are reported every 10 seconds
+	@endcode
+
+	Intervals can also be taken manually with
+	<tt>@ref fgl::debug::generic_concurrent_stopwatch::take_interval()</tt>.
+@{
+*/
+
+/**
+@brief The statistics of the laps recorded by a stopwatch during one
+	reporting interval.
+@tparam T_clock The clock of the stopwatch.
+*/
+template <fgl::traits::steady_clock T_clock>
+struct stopwatch_interval
+{
+	using clock_t = T_clock;
+	using time_point_t = std::chrono::time_point<clock_t>;
+	using statistics_t =
+		typename generic_concurrent_stopwatch<clock_t>::statistics;
+
+	/// The name of the stopwatch
+	std::string name{};
+
+	/// The number of intervals which were reported before this one
+	std::uint64_t index{};
+
+	/// When the interval began
+	time_point_t begin{};
+
+	/// When the interval ended
+	time_point_t end{};
+
+	/// The statistics of the laps recorded during the interval
+	statistics_t statistics{};
+};
+
+/**
+@brief A background thread which periodically sends the interval statistics
+	of a concurrent stopwatch to @ref group-debug-output.
+@details Intervals during which no laps were recorded aren't reported. When
+	the reporter is destroyed, it reports the final, partial interval and
+	joins its thread.
+@warning The stopwatch must outlive the reporter.
+@tparam T_clock The clock of the stopwatch.
+*/
+template <fgl::traits::steady_clock T_clock = std::chrono::steady_clock>
+class generic_interval_reporter final
+{
+	public:
+	using clock_t = T_clock;
+	using stopwatch_t = generic_concurrent_stopwatch<clock_t>;
+	using interval_t = stopwatch_interval<clock_t>;
+
+	private:
+	stopwatch_t& m_stopwatch;
+	std::chrono::nanoseconds m_period;
+	std::uint64_t m_index{};
+	typename interval_t::time_point_t m_begin{};
+	std::jthread m_thread{};
+
+	/// Takes the current interval and outputs it, unless it's empty
+	void report()
+	{
+		interval_t interval;
+		interval.name = m_stopwatch.name;
+		interval.begin = m_begin;
+		const auto laps{ m_stopwatch.take_interval() };
+		interval.end = clock_t::now();
+		m_begin = interval.end;
+		if (laps.size() == 0)
+			return;
+		interval.index = m_index++;
+		interval.statistics = laps.calculate_statistics();
+		fgl::debug::output(interval);
+	}
+
+	/// Reports the current interval, discarding it if reporting throws
+	void try_report() noexcept
+	{
+		try { report(); }
+		catch (...) {} // reporting is best-effort on this thread
+	}
+
+	/// The body of the reporting thread
+	void run(const std::stop_token token) noexcept
+	{
+		std::mutex mutex;
+		std::condition_variable_any wake;
+		std::unique_lock lock(mutex);
+		auto next{ std::chrono::steady_clock::now() + m_period };
+		for (;;)
+		{
+			wake.wait_until(lock, token, next, [](){ return false; });
+			if (token.stop_requested())
+				break;
+			try_report();
+			next += m_period;
+		}
+		try_report();
+	}
+
+	public:
+	/**
+	@brief Starts reporting the intervals of @p sw.
+	@param sw The stopwatch to report. Laps recorded before the
+		reporter was constructed are included in the first interval.
+	@param period The duration of each interval.
+	*/
+	[[nodiscard]] generic_interval_reporter(
+		stopwatch_t& sw,
+		const std::chrono::nanoseconds period)
+	:
+		m_stopwatch(sw),
+		m_period(period),
+		m_begin(clock_t::now())
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(period > std::chrono::nanoseconds::zero());
+		m_thread = std::jthread(
+			[this](const std::stop_token token) noexcept { run(token); }
+		);
+	}
+
+	generic_interval_reporter(const generic_interval_reporter&) = delete;
+	generic_interval_reporter& operator=(
+		const generic_interval_reporter&) = delete;
+
+	/// Reports the final interval and joins the reporting thread
+	~generic_interval_reporter()
+	{ stop(); }
+
+	/**
+	@brief Reports the final interval and joins the reporting thread.
+	@note Does nothing if the reporter was already stopped.
+	*/
+	void stop() noexcept
+	{
+		if (m_thread.joinable())
+		{
+			m_thread.request_stop();
+			m_thread.join();
+		}
+	}
+
+	/// @returns The duration of each interval
+	[[nodiscard]] std::chrono::nanoseconds period() const noexcept
+	{ return m_period; }
+};
+
+/// A convenient alias for a <tt>std::chrono::steady_clock</tt> reporter
+using interval_reporter = generic_interval_reporter<>;
+
+/**
+@brief An <tt>fgl::debug::output_handler</tt> specialization for sending
+	stopwatch intervals to libFGL's @ref group-debug-output.
+@details Shares the stopwatch output channel, and formats statistics with
+	the configurable <tt>statistics_formatter</tt> of the corresponding
+	streaming stopwatch's <tt>output_config</tt>.
+@see @ref group-debug-output and <tt>@ref fgl::debug::output::operator()()</tt>
+*/
+template <fgl::traits::steady_clock T_clock>
+class output_config<stopwatch_interval<T_clock>>
+: public simple_output_channel
+	<
+		true,
+		priority::info,
+		internal::stopwatch_cname,
+		output_config<stopwatch_interval<T_clock>>
+	>
+{
+	output_config(auto&&...) = delete; ///< should never be instantiated
+	public:
+	using channel_t = simple_output_channel
+	<
+		true,
+		priority::info,
+		internal::stopwatch_cname,
+		output_config<stopwatch_interval<T_clock>>
+	>;
+
+	using interval_t = stopwatch_interval<T_clock>;
+
+	/// The configuration whose formatters are used for the statistics
+	using stopwatch_config_t = output_config<
+		generic_stopwatch<
+			T_clock,
+			typename generic_concurrent_stopwatch<T_clock>::record_t
+		>
+	>;
+
+	/// @returns <tt>true</tt> if the channel and stopwatch output are enabled
+	[[nodiscard]] static bool enabled() noexcept
+	{ return channel_t::enabled() && !disable_stopwatch_output_channels; }
+
+	/**
+	@brief Interval formatter method to satisfy
+		<tt>fgl::debug::output_formatter</tt>
+	*/
+	[[nodiscard]] static std::string format(const interval_t& interval)
+	{
+		std::ostringstream oss;
+		oss
+			<< "Interval: " << interval.name << " #" << interval.index
+			<< ", "
+			<< stopwatch_config_t::duration_formatter(
+				std::chrono::duration_cast<
+					typename stopwatch_config_t::stopwatch_t::duration_t
+				>(interval.end - interval.begin)
+			)
+			<< '\n'
+			<< stopwatch_config_t::statistics_formatter(interval.statistics);
+		return output::default_fmt_msg(oss.str());
+	}
+};
+
+static_assert(output_handler<
+	output_config<stopwatch_interval<std::chrono::steady_clock>>,
+	stopwatch_interval<std::chrono::steady_clock>
+>);
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_INTERVAL_REPORTER_HPP_INCLUDED
@@ -0,0 +1,288 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_LAP_RECORD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_LAP_RECORD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <chrono>
+#include <concepts> // same_as, convertible_to
+#include <numeric> // reduce
+#include <span>
+#include <vector>
+
+#include "../constexpr_assert.hpp"
+#include "./statistics.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+
+@defgroup group-debug-stopwatch-lap_records Stopwatch Lap Records
+
+@ingroup group-debug-stopwatch
+
+@brief Storage policies for the lap durations recorded by a stopwatch
+
+@details
+	A lap record is the backing store of a
+	<tt>@ref fgl::debug::generic_stopwatch</tt>. Every time the stopwatch
+	produces a lap duration, it's handed to the lap record which decides what
+	to retain. Different records trade memory and per-lap cost against the
+	amount of information available when statistics are calculated.
+
+	All records satisfy <tt>@ref fgl::debug::lap_record</tt>. Records which
+	retain every lap and support random access additionally satisfy
+	<tt>@ref fgl::debug::indexed_lap_record</tt>, which enables the
+	stopwatch's per-lap accessors. Records which satisfy
+	<tt>@ref fgl::debug::timestamped_lap_record</tt> are also told when each
+	lap started, and those which satisfy
+	<tt>@ref fgl::debug::quantified_lap_record</tt> can be told how much work
+	each lap performed. Records which satisfy
+	<tt>@ref fgl::debug::started_lap_record</tt> are notified when the
+	stopwatch starts, so they can sample other state at the start of a lap.
+	Records which satisfy <tt>@ref fgl::debug::scratch_lap_record</tt> can
+	calculate statistics in a caller-provided buffer, so that reporting
+	doesn't need to allocate.
+	Records which satisfy <tt>@ref fgl::debug::sampling_lap_record</tt> only
+	record some laps, and tell the stopwatch in advance which ones, so that
+	it can avoid reading the clock for the others.
+@{
+*/
+
+/**
+@brief Satisfied if @p T can be used as the lap record of a stopwatch.
+@details A lap record must provide:
+	- <tt>duration_t</tt>, the lap duration type
+	- <tt>statistics_t</tt>, the type returned by
+		<tt>calculate_statistics()</tt>
+	- <tt>record(duration_t)</tt> to store a lap duration
+	- <tt>clear()</tt> to discard all stored information
+	- <tt>size()</tt>, the number of laps which have been recorded
+	- <tt>total()</tt>, the sum of all laps which have been recorded
+	- <tt>calculate_statistics()</tt>
+*/
+template <typename T>
+concept lap_record = requires (
+	T& record,
+	const T& const_record,
+	const typename T::duration_t lap)
+{
+	typename T::duration_t;
+	typename T::statistics_t;
+	{ record.record(lap) } -> std::same_as<void>;
+	{ record.clear() } -> std::same_as<void>;
+	{ const_record.size() } -> std::same_as<std::size_t>;
+	{ const_record.total() } -> std::same_as<typename T::duration_t>;
+	{ const_record.calculate_statistics() }
+		-> std::same_as<typename T::statistics_t>;
+};
+
+/**
+@brief Satisfied if @p T is a <tt>@ref lap_record</tt> which can calculate
+	statistics that include requested percentiles.
+*/
+template <typename T>
+concept percentile_lap_record = lap_record<T> && requires (
+	const T& const_record,
+	const std::span<const double> percentiles)
+{
+	{ const_record.calculate_statistics(percentiles) }
+		-> std::same_as<typename T::statistics_t>;
+};
+
+/**
+@brief Satisfied if @p T is a <tt>@ref percentile_lap_record</tt> which can
+	calculate its statistics in a reusable scratch buffer.
+*/
+template <typename T>
+concept scratch_lap_record = percentile_lap_record<T> && requires (
+	const T& const_record,
+	const std::span<const double> percentiles,
+	std::vector<typename T::duration_t>& scratch)
+{
+	{ const_record.calculate_statistics(percentiles, scratch) }
+		-> std::same_as<typename T::statistics_t>;
+};
+
+/**
+@brief Satisfied if @p T is a <tt>@ref lap_record</tt> which can also record
+	when each lap started.
+@details The stopwatch passes the start of the lap, as a duration since the
+	clock's epoch, followed by the lap's duration.
+*/
+template <typename T>
+concept timestamped_lap_record = lap_record<T> && requires (
+	T& record,
+	const typename T::duration_t start,
+	const typename T::duration_t lap)
+{
+	{ record.record(start, lap) } -> std::same_as<void>;
+};
+
+/**
+@brief Satisfied if @p T is a <tt>@ref lap_record</tt> which can also record
+	the quantity of work performed during each lap.
+@details A quantified record must provide <tt>quantity_t</tt>, the type of
+	the work quantity, such as a number of items or a
+	<tt>fgl::units::data_size</tt>. The stopwatch passes the lap's duration,
+	followed by its quantity.
+*/
+template <typename T>
+concept quantified_lap_record = lap_record<T> && requires (
+	T& record,
+	const typename T::duration_t lap,
+	const typename T::quantity_t quantity)
+{
+	{ record.record(lap, quantity) } -> std::same_as<void>;
+};
+
+/**
+@brief Satisfied if @p T is a <tt>@ref lap_record</tt> which must be
+	notified when the stopwatch is started.
+@details The stopwatch calls <tt>start()</tt> after reading the start time,
+	so that records can sample state, such as performance counters, which
+	the following lap is measured against.
+*/
+template <typename T>
+concept started_lap_record = lap_record<T> && requires (T& record)
+{
+	{ record.start() } -> std::same_as<void>;
+};
+
+/**
+@brief Satisfied if @p T is a <tt>@ref lap_record</tt> which only records
+	some laps, and knows in advance which ones.
+@details <tt>samples_this_lap()</tt> returns whether the current lap, or
+	the next lap to be started if the stopwatch isn't ticking, will be
+	recorded. <tt>samples_next_lap()</tt> returns whether the lap which
+	follows it will be. The durations of laps which aren't recorded are
+	still passed to the record, but are ignored, so the stopwatch doesn't
+	need to read the clock for them.
+*/
+template <typename T>
+concept sampling_lap_record = lap_record<T> && requires (const T& const_record)
+{
+	{ const_record.samples_this_lap() } -> std::same_as<bool>;
+	{ const_record.samples_next_lap() } -> std::same_as<bool>;
+};
+
+/**
+@brief Satisfied if @p T is a <tt>@ref lap_record</tt> which retains laps
+	and provides random access to them.
+*/
+template <typename T>
+concept indexed_lap_record = lap_record<T> && requires (
+	const T& const_record,
+	const std::size_t index)
+{
+	{ const_record.at(index) }
+		-> std::convertible_to<typename T::duration_t>;
+	{ const_record.total_between(index, index) }
+		-> std::same_as<typename T::duration_t>;
+	const_record.laps();
+};
+
+/**
+@brief The default lap record, which retains every lap in a
+	<tt>std::vector</tt>.
+@details Provides exact statistics and random access to every lap, at the
+	cost of memory which grows with the number of laps.
+@tparam T_duration The lap duration type.
+*/
+template <typename T_duration>
+class vector_lap_record
+{
+	public:
+	using duration_t = T_duration;
+	using statistics_t = lap_statistics<duration_t>;
+
+	private:
+	std::vector<duration_t> m_laps{};
+
+	public:
+	/// Reserves space for @p capacity laps to avoid reallocations
+	constexpr void reserve(const std::size_t capacity)
+	{ m_laps.reserve(capacity); }
+
+	/// Stores @p lap
+	constexpr void record(const duration_t lap)
+	{ m_laps.emplace_back(lap); }
+
+	/// Discards all laps
+	constexpr void clear() noexcept
+	{ m_laps.clear(); }
+
+	/// @returns The number of recorded laps
+	[[nodiscard]] constexpr std::size_t size() const noexcept
+	{ return m_laps.size(); }
+
+	/// @returns The duration of lap number @p index
+	[[nodiscard]] constexpr duration_t at(const std::size_t index) const
+	{ return m_laps.at(index); }
+
+	/// @returns The most recently recorded lap
+	[[nodiscard]] constexpr duration_t back() const
+	{ return m_laps.back(); }
+
+	/// @returns A <tt>const</tt> reference to the vector of laps
+	[[nodiscard]] constexpr const std::vector<duration_t>& laps() const noexcept
+	{ return m_laps; }
+
+	/// @returns The sum of laps [<tt>start_lap</tt>, <tt>end_lap</tt>)
+	[[nodiscard]] constexpr duration_t total_between(
+		const std::size_t start_lap,
+		const std::size_t end_lap) const
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(start_lap <= end_lap);
+		FGL_DEBUG_CONSTEXPR_ASSERT(end_lap <= m_laps.size());
+		using diff_t = typename std::vector<duration_t>::difference_type;
+		return std::reduce(
+			m_laps.cbegin() + static_cast<diff_t>(start_lap),
+			m_laps.cbegin() + static_cast<diff_t>(end_lap),
+			duration_t{}
+		);
+	}
+
+	/// @returns The sum of all recorded laps
+	[[nodiscard]] constexpr duration_t total() const
+	{ return total_between(0, m_laps.size()); }
+
+	/**
+	@returns Exact statistics calculated by selection from a copy of the laps
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles = {}) const
+	{
+		std::vector<duration_t> scratch;
+		return calculate_statistics(percentiles, scratch);
+	}
+
+	/**
+	@returns Exact statistics calculated by selection from a copy of the laps
+		in @p scratch, which only allocates if it has less capacity than the
+		number of laps.
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	@param scratch A buffer which can be reused between calls.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles,
+		std::vector<duration_t>& scratch) const
+	{
+		scratch.assign(m_laps.cbegin(), m_laps.cend());
+		return statistics_t::from_unsorted(scratch, percentiles);
+	}
+};
+
+static_assert(indexed_lap_record<vector_lap_record<std::chrono::nanoseconds>>);
+static_assert(
+	scratch_lap_record<vector_lap_record<std::chrono::nanoseconds>>
+);
+
+///@} group-debug-stopwatch-lap_records
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_LAP_RECORD_HPP_INCLUDED
@@ -0,0 +1,221 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_OVERHEAD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_OVERHEAD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <algorithm> // sort, is_sorted, max
+#include <chrono>
+#include <vector>
+
+#include "../../types/traits.hpp"
+#include "../constexpr_assert.hpp"
+#include "../stopwatch.hpp"
+#include "./statistics.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+
+@defgroup group-debug-stopwatch-overhead Stopwatch Overhead Calibration
+
+@ingroup group-debug-stopwatch
+
+@brief Measurement and subtraction of a stopwatch's own timing overhead
+
+@details
+	Every lap includes the cost of reading the clock and of the stopwatch's
+	own bookkeeping between the two time points, which biases very short
+	measurements. <tt>@ref fgl::debug::calibrate_overhead()</tt> measures
+	that cost for a clock by timing empty <tt>start()</tt> and
+	<tt>stop()</tt> pairs, and <tt>@ref fgl::debug::subtract_overhead()</tt>
+	removes it from a set of statistics.
+
+	The result also includes a <i>noise floor</i>: the median absolute
+	deviation of the empty laps, but never less than the resolution of the
+	clock. Differences between measurements which are smaller than the noise
+	floor shouldn't be considered significant.
+
+	@code
+	using fgl::debug::stopwatch;
+	static const auto overhead{
+		fgl::debug::calibrate_overhead<stopwatch::clock_t>()
+	};
+	const auto corrected{
+		fgl::debug::subtract_overhead(sw.calculate_statistics(), overhead)
+	};
+	@endcode
+
+	@note Calibration is opt-in, and should be performed under the same
+		conditions (thread, core, build mode) as the measurements it's used to
+		correct.
+@{
+*/
+
+/**
+@brief The measured timing overhead of a stopwatch.
+@tparam T_duration The <tt>std::chrono::duration</tt> type of the laps.
+*/
+template <typename T_duration>
+struct stopwatch_overhead
+{
+	using duration_t = T_duration;
+
+	/// The number of empty laps which were measured
+	std::size_t number_of_samples{};
+
+	/// The median duration of an empty lap
+	duration_t overhead{};
+
+	/// The smallest non-zero difference observed between two empty laps
+	duration_t resolution{};
+
+	/// The greater of the median absolute deviation and the resolution
+	duration_t noise_floor{};
+
+	/// Constructs an empty overhead, which doesn't correct anything
+	[[nodiscard]] constexpr stopwatch_overhead() noexcept = default;
+
+	/**
+	@param[in] sorted_laps A vector of empty lap durations, sorted in
+		ascending order.
+	*/
+	[[nodiscard]] explicit constexpr
+	stopwatch_overhead(const std::vector<duration_t>& sorted_laps)
+	:
+		number_of_samples{ sorted_laps.size() },
+		overhead{ lap_statistics<duration_t>::get_median(sorted_laps) },
+		resolution{ get_resolution(sorted_laps) },
+		noise_floor{
+			std::max(get_median_absolute_deviation(sorted_laps), resolution)
+		}
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(
+			std::is_sorted(sorted_laps.cbegin(), sorted_laps.cend())
+		);
+	}
+
+	/// @returns The smallest non-zero difference between sorted laps
+	[[nodiscard]] static constexpr
+	duration_t get_resolution(const std::vector<duration_t>& v) noexcept
+	{
+		duration_t smallest{};
+		for (std::size_t i{ 1 }; i < v.size(); ++i)
+		{
+			const duration_t difference{ v[i] - v[i - 1] };
+			if (difference > duration_t{}
+				&& (smallest == duration_t{} || difference < smallest))
+				smallest = difference;
+		}
+		return smallest;
+	}
+
+	/// @returns The median absolute deviation from the median of sorted laps
+	[[nodiscard]] static constexpr
+	duration_t get_median_absolute_deviation(const std::vector<duration_t>& v)
+	{
+		const duration_t median{ lap_statistics<duration_t>::get_median(v) };
+		std::vector<duration_t> deviations;
+		deviations.reserve(v.size());
+		for (const duration_t lap : v)
+			deviations.push_back(lap > median ? lap - median : median - lap);
+		std::sort(deviations.begin(), deviations.end());
+		return lap_statistics<duration_t>::get_median(deviations);
+	}
+};
+
+/**
+@brief Statistics from which a measured overhead has been subtracted.
+@details The total, mean, median, minimum, maximum, and percentiles are
+	corrected; each lap is reduced by the overhead, but never below zero.
+	The standard deviation is unaffected by subtracting a constant.
+*/
+template <typename T_duration>
+struct overhead_corrected_statistics : public lap_statistics<T_duration>
+{
+	using duration_t = T_duration;
+
+	/// The overhead which was subtracted from each lap
+	duration_t overhead{};
+
+	/// The noise floor of the overhead measurement
+	duration_t noise_floor{};
+};
+
+/**
+@returns @p stats with the overhead subtracted from every lap.
+@param stats The uncorrected statistics
+@param measured The overhead to subtract, usually obtained from
+	<tt>@ref calibrate_overhead()</tt>
+*/
+template <typename T_duration>
+[[nodiscard]] constexpr overhead_corrected_statistics<T_duration>
+subtract_overhead(
+	const lap_statistics<T_duration>& stats,
+	const stopwatch_overhead<T_duration>& measured)
+{
+	const T_duration overhead{ measured.overhead };
+	const auto correct{
+		[overhead](const T_duration lap) -> T_duration
+		{ return lap > overhead ? lap - overhead : T_duration{}; }
+	};
+	using rep_t = typename T_duration::rep;
+	const T_duration total_overhead{
+		overhead * static_cast<rep_t>(stats.number_of_laps)
+	};
+
+	overhead_corrected_statistics<T_duration> corrected;
+	static_cast<lap_statistics<T_duration>&>(corrected) = stats;
+	corrected.overhead = overhead;
+	corrected.noise_floor = measured.noise_floor;
+	corrected.total_elapsed =
+		stats.total_elapsed > total_overhead
+		? stats.total_elapsed - total_overhead
+		: T_duration{};
+	corrected.mean = correct(stats.mean);
+	if (stats.median)
+		corrected.median = correct(*stats.median);
+	corrected.min = correct(stats.min);
+	corrected.max = correct(stats.max);
+	for (auto& p : corrected.percentiles)
+		p.value = correct(p.value);
+	return corrected;
+}
+
+/**
+@brief Measures the overhead of timing an empty lap with a stopwatch which
+	uses @p T_clock.
+@tparam T_clock The clock to calibrate
+@param samples The number of empty laps to measure
+@param warmup_samples The number of empty laps to discard beforehand
+@returns The measured overhead
+*/
+template <fgl::traits::steady_clock T_clock = std::chrono::steady_clock>
+[[nodiscard]] stopwatch_overhead<typename T_clock::duration>
+calibrate_overhead(
+	const std::size_t samples = 10'000,
+	const std::size_t warmup_samples = 1'000)
+{
+	FGL_DEBUG_CONSTEXPR_ASSERT(samples > 0);
+	generic_stopwatch<T_clock> sw("overhead calibration", samples);
+	for (std::size_t i{}; i < warmup_samples; ++i)
+	{
+		sw.start();
+		sw.stop();
+	}
+	sw.reset();
+	for (std::size_t i{}; i < samples; ++i)
+	{
+		sw.start();
+		sw.stop();
+	}
+	std::vector<typename T_clock::duration> laps(sw.get_all_laps());
+	std::sort(laps.begin(), laps.end());
+	return stopwatch_overhead<typename T_clock::duration>(laps);
+}
+
+///@} group-debug-stopwatch-overhead
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_OVERHEAD_HPP_INCLUDED
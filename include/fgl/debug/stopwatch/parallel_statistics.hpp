@@ -0,0 +1,355 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_PARALLEL_STATISTICS_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_PARALLEL_STATISTICS_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <algorithm> // min, max, sort, lower_bound, nth_element, unique
+#include <cmath> // sqrt
+#include <iterator> // distance
+#include <ranges> // contiguous_range, range_value_t
+#include <span>
+#include <thread> // jthread, hardware_concurrency
+#include <vector>
+
+#include "../../types/traits.hpp"
+#include "../stopwatch.hpp"
+#include "./lap_record.hpp"
+#include "./statistics.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch-statistics
+@{
+*/
+
+/**
+@brief Laps below this number per thread are not worth another thread.
+@details <tt>@ref calculate_parallel_statistics()</tt> uses fewer threads
+	than requested, or none but the calling thread, for smaller records.
+*/
+inline constexpr std::size_t min_laps_per_statistics_thread{ 1 << 16 };
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+
+/**
+@brief Calls <tt>f(i)</tt> for every <tt>i</tt> in <tt>[0, threads)</tt>,
+	each on its own thread, and waits for them all to return.
+@details The calling thread runs <tt>f(0)</tt>. @p f must not throw.
+*/
+template <typename T_function>
+void run_in_parallel(const std::size_t threads, const T_function& f)
+{
+	std::vector<std::jthread> workers;
+	workers.reserve(threads - 1);
+	for (std::size_t i{ 1 }; i < threads; ++i)
+		workers.emplace_back([&f, i]() noexcept { f(i); });
+	f(0);
+} // workers join when destroyed
+
+/// The laps of @p laps which are processed by thread @p i of @p threads
+template <typename T_duration>
+[[nodiscard]] constexpr std::span<const T_duration> parallel_slice(
+	const std::span<const T_duration> laps,
+	const std::size_t i,
+	const std::size_t threads) noexcept
+{
+	const std::size_t first{ laps.size() * i / threads };
+	const std::size_t last{ laps.size() * (i + 1) / threads };
+	return laps.subspan(first, last - first);
+}
+
+} // namespace internal
+///@endcond
+
+/**
+@brief Calculates statistics of a very large number of laps on several
+	threads, without copying or reordering the laps.
+@details The results are identical to those of
+	<tt>@ref lap_statistics::from_unsorted()</tt>, except that the standard
+	deviation may differ by the rounding of a floating-point sum.
+
+	The sum, min, max, and variance are reduced from per-thread partial
+	results. Order statistics are found by sampling: a sorted sample of the
+	laps brackets each requested rank between two lap values, every thread
+	counts its laps between the brackets, and only the laps within the
+	bracket that holds each rank, usually a few percent of them, are
+	gathered and selected from. That requires three passes over the laps,
+	each divided between the threads, rather than a copy and a selection on
+	a single thread.
+@param laps Lap durations in any order, which are only read.
+@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+	included in the statistics.
+@param threads The maximum number of threads to use, including the calling
+	thread. If zero, <tt>std::thread::hardware_concurrency()</tt>. Fewer are
+	used if there are less than
+	<tt>@ref min_laps_per_statistics_thread</tt> laps for each.
+@note Threads are started for each call, so this is only faster than
+	<tt>calculate_statistics()</tt> for millions of laps.
+*/
+template <std::ranges::contiguous_range T_range>
+[[nodiscard]] lap_statistics<std::ranges::range_value_t<T_range>>
+calculate_parallel_statistics(
+	const T_range& laps,
+	const std::span<const double> percentiles = {},
+	std::size_t threads = 0)
+{
+	using duration_t = std::ranges::range_value_t<T_range>;
+	using statistics_t = lap_statistics<duration_t>;
+	using rep_t = typename duration_t::rep;
+	using internal::parallel_slice;
+	using internal::run_in_parallel;
+
+	const std::span<const duration_t> all(laps);
+	const std::size_t n{ all.size() };
+	statistics_t stats;
+	if (n == 0)
+		return stats;
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	threads = std::max(
+		std::min(threads, n / min_laps_per_statistics_thread),
+		std::size_t{ 1 }
+	);
+
+	// first pass: the sum, min, and max
+	struct partial
+	{
+		duration_t total{};
+		duration_t min{};
+		duration_t max{};
+		double sum{};
+		double sum_of_squares{};
+	};
+	std::vector<partial> partials(threads);
+	run_in_parallel(threads, [&](const std::size_t i) noexcept
+	{
+		const auto slice{ parallel_slice(all, i, threads) };
+		partial p{ {}, slice.front(), slice.front(), 0.0, 0.0 };
+		for (const duration_t lap : slice)
+		{
+			p.total += lap;
+			p.sum += static_cast<double>(lap.count());
+			if (lap < p.min)
+				p.min = lap;
+			if (p.max < lap)
+				p.max = lap;
+		}
+		partials[i] = p;
+	});
+	double sum{};
+	stats.min = partials.front().min;
+	stats.max = partials.front().max;
+	for (const partial& p : partials)
+	{
+		stats.total_elapsed += p.total;
+		sum += p.sum;
+		stats.min = std::min(stats.min, p.min);
+		stats.max = std::max(stats.max, p.max);
+	}
+	stats.number_of_laps = n;
+	stats.mean = statistics_t::get_mean(stats.total_elapsed, n);
+	const double mean{ sum / static_cast<double>(n) };
+
+	// unique zero-based indices of every required order statistic
+	const std::size_t mid{ n / 2 };
+	std::vector<std::size_t> indices;
+	indices.reserve(percentiles.size() + 2);
+	if (n % 2 == 0)
+		indices.push_back(mid - 1);
+	indices.push_back(mid);
+	for (const double p : percentiles)
+		indices.push_back(statistics_t::percentile_rank(p, n) - 1);
+	std::ranges::sort(indices);
+	indices.erase(std::ranges::unique(indices).begin(), indices.end());
+
+	// bracket every index between two values of a sorted, evenly strided
+	// sample, wide enough that the index is almost certainly between them
+	const std::size_t sample_size{ std::min(n, std::size_t{ 1 } << 16) };
+	const std::size_t margin{ 4 * static_cast<std::size_t>(
+		std::sqrt(static_cast<double>(sample_size))
+	) };
+	std::vector<duration_t> bounds;
+	{
+		std::vector<duration_t> sample;
+		sample.reserve(sample_size);
+		for (std::size_t i{}; i < sample_size; ++i)
+			sample.push_back(all[i * n / sample_size]);
+		std::ranges::sort(sample);
+		bounds.reserve(indices.size() * 2);
+		for (const std::size_t index : indices)
+		{
+			const std::size_t rank{ index * sample_size / n };
+			bounds.push_back(sample[rank > margin ? rank - margin : 0]);
+			bounds.push_back(
+				sample[std::min(rank + margin, sample_size - 1)]
+			);
+		}
+		std::ranges::sort(bounds);
+		bounds.erase(std::ranges::unique(bounds).begin(), bounds.end());
+	}
+
+	// Laps are divided into slots ordered by value: an odd slot holds laps
+	// equal to a bound, and an even slot holds those between two bounds (or
+	// beyond the first or last).
+	const std::size_t slots{ bounds.size() * 2 + 1 };
+	const auto slot_of{
+		[&bounds](const duration_t lap) noexcept -> std::size_t
+		{
+			const auto it{ std::ranges::lower_bound(bounds, lap) };
+			const auto p{ static_cast<std::size_t>(it - bounds.begin()) };
+			return (it != bounds.end() && !(lap < *it)) ? p * 2 + 1 : p * 2;
+		}
+	};
+
+	// second pass: the variance, and the number of laps in each slot
+	std::vector<std::size_t> counts(threads * slots);
+	run_in_parallel(threads, [&](const std::size_t i) noexcept
+	{
+		std::size_t* const count{ counts.data() + i * slots };
+		double sum_of_squares{};
+		for (const duration_t lap : parallel_slice(all, i, threads))
+		{
+			const double delta{ static_cast<double>(lap.count()) - mean };
+			sum_of_squares += delta * delta;
+			++count[slot_of(lap)];
+		}
+		partials[i].sum_of_squares = sum_of_squares;
+	});
+	double sum_of_squares{};
+	for (const partial& p : partials)
+		sum_of_squares += p.sum_of_squares;
+	stats.standard_deviation = statistics_t::duration_from_variance(
+		sum_of_squares / static_cast<double>(n)
+	);
+
+	// find the slot of each index. Indices within a bound's slot equal that
+	// bound; the laps of any other slot which holds an index are gathered.
+	std::vector<std::size_t> slot_first(slots + 1); // laps before each slot
+	for (std::size_t s{}; s < slots; ++s)
+	{
+		std::size_t total{};
+		for (std::size_t i{}; i < threads; ++i)
+			total += counts[i * slots + s];
+		slot_first[s + 1] = slot_first[s] + total;
+	}
+	std::vector<std::size_t> index_slots;
+	index_slots.reserve(indices.size());
+	std::vector<bool> gathered(slots);
+	for (const std::size_t index : indices)
+	{
+		const auto it{ std::ranges::upper_bound(slot_first, index) };
+		const auto s{ static_cast<std::size_t>(it - slot_first.begin()) - 1 };
+		index_slots.push_back(s);
+		if (s % 2 == 0)
+			gathered[s] = true;
+	}
+
+	// each thread's position for each gathered slot, so that the laps of a
+	// slot are contiguous and in ascending order of slot
+	constexpr std::size_t not_gathered{ ~std::size_t{} };
+	std::vector<std::size_t> cursors(threads * slots, not_gathered);
+	std::vector<std::size_t> gathered_first(slots, not_gathered);
+	std::size_t candidates_size{};
+	for (std::size_t s{}; s < slots; ++s)
+	{
+		if (!gathered[s])
+			continue;
+		gathered_first[s] = candidates_size;
+		for (std::size_t i{}; i < threads; ++i)
+		{
+			cursors[i * slots + s] = candidates_size;
+			candidates_size += counts[i * slots + s];
+		}
+	}
+
+	// third pass: gather the laps of the slots which hold an index
+	std::vector<duration_t> candidates(candidates_size);
+	const auto gather{
+		[&](const std::size_t i) noexcept
+		{
+			std::size_t* const cursor{ cursors.data() + i * slots };
+			for (const duration_t lap : parallel_slice(all, i, threads))
+				if (const std::size_t s{ slot_of(lap) }; s % 2 == 0)
+					if (cursor[s] != not_gathered)
+						candidates[cursor[s]++] = lap;
+		}
+	};
+	if (candidates_size > 0)
+		run_in_parallel(threads, gather);
+
+	// select each index from its slot's laps, in ascending order so that
+	// each selection only needs to consider the laps after the previous one
+	using diff_t = typename std::vector<duration_t>::difference_type;
+	std::vector<duration_t> values;
+	values.reserve(indices.size());
+	auto first{ candidates.begin() };
+	for (std::size_t k{}; k < indices.size(); ++k)
+	{
+		const std::size_t s{ index_slots[k] };
+		if (s % 2 == 1)
+		{
+			values.push_back(bounds[s / 2]);
+			continue;
+		}
+		const std::size_t position{
+			gathered_first[s] + (indices[k] - slot_first[s])
+		};
+		const auto nth{ candidates.begin() + static_cast<diff_t>(position) };
+		const auto slot_begin{
+			candidates.begin() + static_cast<diff_t>(gathered_first[s])
+		};
+		if (std::distance(first, slot_begin) > 0)
+			first = slot_begin;
+		const auto slot_end{ slot_begin + static_cast<diff_t>(
+			slot_first[s + 1] - slot_first[s]
+		) };
+		std::nth_element(first, nth, slot_end);
+		values.push_back(*nth);
+		first = nth + 1;
+	}
+	const auto value_of{
+		[&](const std::size_t index) -> duration_t
+		{
+			const auto it{ std::ranges::lower_bound(indices, index) };
+			return values[static_cast<std::size_t>(it - indices.begin())];
+		}
+	};
+
+	stats.median =
+		(n % 2 == 0)
+		? (value_of(mid - 1) + value_of(mid)) / rep_t{2}
+		: value_of(mid);
+	stats.percentiles.reserve(percentiles.size());
+	for (const double p : percentiles)
+		stats.percentiles.push_back(
+			{ p, value_of(statistics_t::percentile_rank(p, n) - 1) }
+		);
+	return stats;
+}
+
+/**
+@returns The statistics of the laps of @p sw, calculated by
+	<tt>@ref calculate_parallel_statistics()</tt> on up to @p threads
+	threads.
+@note Only available for stopwatches whose lap record retains every lap;
+	records which don't, such as a <tt>@ref streaming_lap_record</tt>,
+	calculate their statistics in constant time.
+*/
+template <fgl::traits::steady_clock T_clock, indexed_lap_record T_record>
+[[nodiscard]] auto calculate_parallel_statistics(
+	const generic_stopwatch<T_clock, T_record>& sw,
+	const std::span<const double> percentiles = {},
+	const std::size_t threads = 0)
+{
+	const auto& laps{ sw.get_all_laps() };
+	return calculate_parallel_statistics(laps, percentiles, threads);
+}
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_PARALLEL_STATISTICS_HPP_INCLUDED
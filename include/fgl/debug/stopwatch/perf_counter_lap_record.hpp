@@ -0,0 +1,312 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_PERF_COUNTER_LAP_RECORD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_PERF_COUNTER_LAP_RECORD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <algorithm> // sort
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <iomanip> // setw
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../constexpr_assert.hpp"
+#include "./statistics.hpp"
+#include "./lap_record.hpp"
+#include "./perf_counters.hpp"
+#include "../stopwatch.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch-lap_records
+@{
+*/
+
+/// The distribution of one counter's per-lap deltas
+struct perf_counter_summary
+{
+	/// The sum of the deltas of every lap
+	std::uint64_t total{};
+
+	/// The smallest delta of a lap
+	std::uint64_t min{};
+
+	/// The largest delta of a lap
+	std::uint64_t max{};
+
+	/// The mean delta per lap
+	double mean{};
+
+	/// The median delta per lap
+	double median{};
+};
+
+/**
+@brief The distributions of the counter deltas of a set of laps.
+@details A counter only has a summary if it was available for every lap.
+*/
+struct perf_counter_statistics
+{
+	/// The number of laps
+	std::size_t number_of_laps{};
+
+	/// Indexed by <tt>@ref perf_counter</tt>
+	std::array<std::optional<perf_counter_summary>, number_of_perf_counters>
+		counters{};
+
+	/// Total instructions per total cycles, if both were available
+	std::optional<double> instructions_per_cycle{};
+
+	[[nodiscard]] constexpr const std::optional<perf_counter_summary>&
+	operator[](const perf_counter counter) const noexcept
+	{ return counters[static_cast<std::size_t>(counter)]; }
+};
+
+/**
+@brief A lap record which retains every lap along with the performance
+	counter deltas of the thread that recorded it.
+@details Behaves like a <tt>@ref vector_lap_record</tt>. The calling
+	thread's counters (see <tt>@ref this_thread_perf_counters()</tt>) are read
+	when the stopwatch is started and every time a lap is recorded, and the
+	difference is retained alongside the lap. The distributions of the deltas
+	are calculated with <tt>@ref calculate_counter_statistics()</tt>.
+@note The counters are read immediately after the stopwatch's clock, so the
+	deltas include a small amount of the stopwatch's own bookkeeping.
+@warning The stopwatch must be started, lapped, and stopped by the same
+	thread, otherwise the deltas are meaningless.
+@tparam T_duration The lap duration type.
+*/
+template <typename T_duration>
+class perf_counter_lap_record
+{
+	public:
+	using duration_t = T_duration;
+	using statistics_t = lap_statistics<duration_t>;
+	using counter_statistics_t = perf_counter_statistics;
+
+	private:
+	vector_lap_record<duration_t> m_laps{};
+	std::vector<perf_counter_values> m_counters{};
+	perf_counter_values m_last{};
+
+	public:
+	/**
+	@brief Opens the calling thread's counters ahead of time, so that the
+		cost of opening them isn't included in the first lap.
+	*/
+	perf_counter_lap_record() noexcept
+	{ [[maybe_unused]] const auto& counters{ this_thread_perf_counters() }; }
+
+	/// Reserves space for @p capacity laps to avoid reallocations
+	constexpr void reserve(const std::size_t capacity)
+	{
+		m_laps.reserve(capacity);
+		m_counters.reserve(capacity);
+	}
+
+	/// Reads the calling thread's counters at the start of a lap
+	void start() noexcept
+	{ m_last = this_thread_perf_counters().read(); }
+
+	/// Stores @p lap and the counter deltas since the previous lap or start
+	void record(const duration_t lap)
+	{
+		const perf_counter_values now{ this_thread_perf_counters().read() };
+		record(lap, now - m_last);
+		m_last = now;
+	}
+
+	/// Stores @p lap along with the given counter @p deltas
+	constexpr void record(
+		const duration_t lap,
+		const perf_counter_values& deltas)
+	{
+		m_counters.push_back(deltas);
+		m_laps.record(lap);
+	}
+
+	/// Discards all laps
+	constexpr void clear() noexcept
+	{
+		m_laps.clear();
+		m_counters.clear();
+	}
+
+	/// @returns The number of recorded laps
+	[[nodiscard]] constexpr std::size_t size() const noexcept
+	{ return m_laps.size(); }
+
+	/// @returns The duration of lap number @p index
+	[[nodiscard]] constexpr duration_t at(const std::size_t index) const
+	{ return m_laps.at(index); }
+
+	/// @returns The counter deltas of lap number @p index
+	[[nodiscard]] constexpr const perf_counter_values& counters_at(
+		const std::size_t index) const
+	{ return m_counters.at(index); }
+
+	/// @returns The most recently recorded lap
+	[[nodiscard]] constexpr duration_t back() const
+	{ return m_laps.back(); }
+
+	/// @returns A <tt>const</tt> reference to the vector of laps
+	[[nodiscard]] constexpr const std::vector<duration_t>& laps() const noexcept
+	{ return m_laps.laps(); }
+
+	/// @returns A <tt>const</tt> reference to the vector of counter deltas
+	[[nodiscard]] constexpr const std::vector<perf_counter_values>& counters()
+	const noexcept
+	{ return m_counters; }
+
+	/// @returns The sum of laps [<tt>start_lap</tt>, <tt>end_lap</tt>)
+	[[nodiscard]] constexpr duration_t total_between(
+		const std::size_t start_lap,
+		const std::size_t end_lap) const
+	{ return m_laps.total_between(start_lap, end_lap); }
+
+	/// @returns The sum of all recorded laps
+	[[nodiscard]] constexpr duration_t total() const
+	{ return m_laps.total(); }
+
+	/**
+	@returns Exact statistics calculated by selection from a copy of the laps
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles = {}) const
+	{ return m_laps.calculate_statistics(percentiles); }
+
+	/**
+	@returns Exact statistics calculated in a reusable @p scratch buffer
+	@see <tt>@ref vector_lap_record::calculate_statistics()</tt>
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles,
+		std::vector<duration_t>& scratch) const
+	{ return m_laps.calculate_statistics(percentiles, scratch); }
+
+	/// @returns The distributions of the per-lap counter deltas
+	[[nodiscard]] counter_statistics_t calculate_counter_statistics() const
+	{
+		counter_statistics_t stats;
+		stats.number_of_laps = size();
+		if (m_counters.empty())
+			return stats;
+
+		std::bitset<number_of_perf_counters> available;
+		available.set();
+		for (const perf_counter_values& deltas : m_counters)
+			available &= deltas.available;
+
+		std::vector<std::uint64_t> sorted(m_counters.size());
+		for (std::size_t c{}; c < number_of_perf_counters; ++c)
+		{
+			if (!available.test(c))
+				continue;
+			perf_counter_summary summary;
+			for (std::size_t i{}; i < m_counters.size(); ++i)
+			{
+				sorted[i] = m_counters[i].values[c];
+				summary.total += sorted[i];
+			}
+			std::ranges::sort(sorted);
+			const std::size_t n{ sorted.size() };
+			summary.min = sorted.front();
+			summary.max = sorted.back();
+			summary.mean =
+				static_cast<double>(summary.total) / static_cast<double>(n);
+			summary.median =
+				n % 2 == 0
+				? (
+					static_cast<double>(sorted[n / 2 - 1])
+					+ static_cast<double>(sorted[n / 2])
+				) / 2.0
+				: static_cast<double>(sorted[n / 2]);
+			stats.counters[c] = summary;
+		}
+
+		const auto& cycles{ stats[perf_counter::cycles] };
+		const auto& instructions{ stats[perf_counter::instructions] };
+		if (cycles && instructions && cycles->total != 0)
+			stats.instructions_per_cycle =
+				static_cast<double>(instructions->total)
+				/ static_cast<double>(cycles->total);
+		return stats;
+	}
+};
+
+static_assert(
+	started_lap_record<perf_counter_lap_record<std::chrono::nanoseconds>>
+);
+static_assert(
+	indexed_lap_record<perf_counter_lap_record<std::chrono::nanoseconds>>
+);
+static_assert(
+	!timestamped_lap_record<perf_counter_lap_record<std::chrono::nanoseconds>>
+);
+
+/**
+@brief A convenient alias for a <tt>std::chrono::steady_clock</tt> stopwatch
+	which retains every lap along with the calling thread's performance
+	counter deltas.
+*/
+using perf_stopwatch = generic_stopwatch<
+	std::chrono::steady_clock,
+	perf_counter_lap_record<std::chrono::steady_clock::duration>
+>;
+
+/**
+@brief Appends the mean and median per-lap deltas of every available
+	performance counter, and the instructions per cycle, to the output of
+	stopwatches which use a <tt>@ref perf_counter_lap_record</tt>.
+*/
+template <typename T_duration>
+struct lap_record_output_section<perf_counter_lap_record<T_duration>>
+{
+	template <typename T_clock>
+	[[nodiscard]] static std::string format(const generic_stopwatch<
+		T_clock,
+		perf_counter_lap_record<T_duration>
+	>& sw)
+	{
+		const perf_counter_statistics stats{
+			sw.calculate_counter_statistics()
+		};
+		std::stringstream ss;
+		ss << "\tIPC:            ";
+		if (stats.instructions_per_cycle)
+			ss << *stats.instructions_per_cycle;
+		else
+			ss << "unavailable";
+		for (std::size_t c{}; c < number_of_perf_counters; ++c)
+		{
+			const auto counter{ static_cast<perf_counter>(c) };
+			std::string label(perf_counter_name(counter));
+			label += ':';
+			ss << "\n\t" << std::left << std::setw(16) << label;
+			if (const auto& summary{ stats[counter] }; summary)
+				ss
+					<< summary->mean << " mean, " << summary->median
+					<< " median per lap";
+			else
+				ss << "unavailable";
+		}
+		return ss.str();
+	}
+};
+
+static_assert(output_handler<output_config<perf_stopwatch>, perf_stopwatch>);
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_PERF_COUNTER_LAP_RECORD_HPP_INCLUDED
@@ -0,0 +1,337 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_PERF_COUNTERS_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_PERF_COUNTERS_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <array>
+#include <bitset>
+#include <span>
+#include <string_view>
+
+#if defined(__linux__)
+	#include <linux/perf_event.h> // perf_event_attr, PERF_*
+	#include <sys/syscall.h> // SYS_perf_event_open
+	#include <unistd.h> // syscall, read, close
+#endif
+
+namespace fgl::debug {
+
+/**
+@file
+
+@defgroup group-debug-stopwatch-perf_counters Performance Counters
+
+@ingroup group-debug-stopwatch
+
+@brief Per-thread hardware and software performance counters
+
+@details
+	Elapsed time alone doesn't explain why a lap was slow. On Linux,
+	<tt>@ref fgl::debug::perf_counter_group</tt> opens
+	<tt>perf_event_open</tt> counters for the calling thread: CPU cycles,
+	retired instructions, cache misses, and branch misses, along with the
+	task-clock and page-fault software counters. Only user-space events are
+	counted, which is permitted by the default
+	<tt>perf_event_paranoid</tt> setting.
+
+	Hardware counters are often unavailable, such as in virtual machines or
+	containers, or if access to the PMU is restricted. Every counter which
+	couldn't be opened is reported as unavailable rather than as an error, so
+	the software counters remain usable as a fallback. On other platforms no
+	counters are available.
+
+	<tt>@ref fgl::debug::perf_counter_lap_record</tt> uses these counters to
+	record the counter deltas of every lap of a stopwatch.
+
+	@note Counters are read with one system call per counter group, which
+		costs on the order of a microsecond. They're best suited for laps
+		which are much longer than that.
+@{
+*/
+
+/// <tt>true</tt> if the target platform provides <tt>perf_event_open</tt>
+[[maybe_unused]] inline constexpr bool perf_counters_platform_support{
+#if defined(__linux__)
+	true
+#else
+	false
+#endif
+};
+
+/// The counters which are opened by a <tt>@ref perf_counter_group</tt>
+enum class perf_counter : std::size_t
+{
+	cycles, ///< CPU cycles (hardware)
+	instructions, ///< Retired instructions (hardware)
+	cache_misses, ///< Last level cache misses (hardware)
+	branch_misses, ///< Mispredicted branches (hardware)
+	task_clock, ///< Nanoseconds the thread was running (software)
+	page_faults ///< Page faults (software)
+};
+
+/// The number of enumerators of <tt>@ref perf_counter</tt>
+inline constexpr std::size_t number_of_perf_counters{ 6 };
+
+/// @returns The name of @p counter, such as <tt>"cache misses"</tt>
+[[nodiscard]] constexpr std::string_view perf_counter_name(
+	const perf_counter counter) noexcept
+{
+	switch (counter)
+	{
+		case perf_counter::cycles: return "cycles";
+		case perf_counter::instructions: return "instructions";
+		case perf_counter::cache_misses: return "cache misses";
+		case perf_counter::branch_misses: return "branch misses";
+		case perf_counter::task_clock: return "task-clock";
+		case perf_counter::page_faults: return "page faults";
+		default: return "unknown";
+	}
+}
+
+/**
+@brief A value for each <tt>@ref perf_counter</tt>, and which of them are
+	available.
+@details Used both for the absolute values read from a
+	<tt>@ref perf_counter_group</tt> and for the deltas between two reads.
+*/
+struct perf_counter_values
+{
+	/// Indexed by <tt>@ref perf_counter</tt>
+	std::array<std::uint64_t, number_of_perf_counters> values{};
+
+	/// Which counters have a meaningful value
+	std::bitset<number_of_perf_counters> available{};
+
+	[[nodiscard]] constexpr std::uint64_t operator[](
+		const perf_counter counter) const noexcept
+	{ return values[static_cast<std::size_t>(counter)]; }
+
+	[[nodiscard]] constexpr std::uint64_t& operator[](
+		const perf_counter counter) noexcept
+	{ return values[static_cast<std::size_t>(counter)]; }
+
+	/// @returns <tt>true</tt> if @p counter has a meaningful value
+	[[nodiscard]] bool is_available(const perf_counter counter)
+	const noexcept
+	{ return available.test(static_cast<std::size_t>(counter)); }
+
+	/**
+	@returns The counts between @p earlier and @p later, which are only
+		available if they're available in both.
+	@note A multiplexed counter's value is an estimate which can decrease
+		slightly; such deltas are clamped to zero.
+	*/
+	[[nodiscard]] friend perf_counter_values operator-(
+		const perf_counter_values& later,
+		const perf_counter_values& earlier) noexcept
+	{
+		perf_counter_values delta;
+		delta.available = later.available & earlier.available;
+		for (std::size_t i{}; i < number_of_perf_counters; ++i)
+			if (delta.available.test(i) && later.values[i] > earlier.values[i])
+				delta.values[i] = later.values[i] - earlier.values[i];
+		return delta;
+	}
+};
+
+/**
+@brief Opens performance counters which count the events of the thread that
+	constructed it.
+@details Hardware and software counters are opened as two separate groups,
+	so that each can be read with a single system call. Counters which can't
+	be opened are unavailable.
+@warning Reading the counters from a different thread than the one which
+	constructed the group reads the constructing thread's counters. Use
+	<tt>@ref this_thread_perf_counters()</tt> to get the calling thread's
+	group.
+*/
+class perf_counter_group final
+{
+	/// A leader and its members, which are scheduled onto the PMU together
+	struct group
+	{
+		std::array<perf_counter, number_of_perf_counters> members{};
+		std::array<int, number_of_perf_counters> descriptors{};
+		std::size_t size{};
+
+		/// @returns The leader's descriptor, or <tt>-1</tt> if there isn't one
+		[[nodiscard]] int leader() const noexcept
+		{ return size == 0 ? -1 : descriptors[0]; }
+	};
+
+	group m_hardware{};
+	group m_software{};
+	std::bitset<number_of_perf_counters> m_available{};
+
+	#if defined(__linux__)
+	/// @returns A file descriptor, or <tt>-1</tt> if @p counter couldn't be
+	/// opened
+	[[nodiscard]] static int open_counter(
+		const perf_counter counter,
+		const int leader) noexcept
+	{
+		perf_event_attr attr{};
+		attr.size = sizeof(attr);
+		switch (counter)
+		{
+			case perf_counter::cycles:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_CPU_CYCLES;
+				break;
+			case perf_counter::instructions:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+				break;
+			case perf_counter::cache_misses:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_CACHE_MISSES;
+				break;
+			case perf_counter::branch_misses:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+				break;
+			case perf_counter::task_clock:
+				attr.type = PERF_TYPE_SOFTWARE;
+				attr.config = PERF_COUNT_SW_TASK_CLOCK;
+				break;
+			case perf_counter::page_faults:
+				attr.type = PERF_TYPE_SOFTWARE;
+				attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+				break;
+			default: return -1;
+		}
+		attr.read_format =
+			PERF_FORMAT_GROUP
+			| PERF_FORMAT_TOTAL_TIME_ENABLED
+			| PERF_FORMAT_TOTAL_TIME_RUNNING;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		// the calling thread, on any CPU
+		return static_cast<int>(
+			syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0UL)
+		);
+	}
+
+	/**
+	@brief Opens @p counters as a group, skipping those which can't be
+		opened. The first counter which opens becomes the group's leader.
+	*/
+	void open_group(group& g, const std::span<const perf_counter> counters)
+	noexcept
+	{
+		for (const perf_counter counter : counters)
+		{
+			const int fd{ open_counter(counter, g.leader()) };
+			if (fd < 0)
+				continue;
+			g.members[g.size] = counter;
+			g.descriptors[g.size] = fd;
+			++g.size;
+			m_available.set(static_cast<std::size_t>(counter));
+		}
+	}
+
+	/// Reads the members of @p g into @p out, scaled for multiplexing
+	static void read_group(const group& g, perf_counter_values& out) noexcept
+	{
+		if (g.size == 0)
+			return;
+		// nr, time_enabled, time_running, and a value per member
+		std::array<std::uint64_t, 3 + number_of_perf_counters> buffer{};
+		const auto bytes{ ::read(g.leader(), buffer.data(), sizeof(buffer)) };
+		if (bytes < 0 || buffer[0] != g.size)
+			return;
+		const std::uint64_t enabled{ buffer[1] };
+		const std::uint64_t running{ buffer[2] };
+		for (std::size_t i{}; i < g.size; ++i)
+		{
+			std::uint64_t value{ buffer[3 + i] };
+			if (running != 0 && running < enabled)
+				value = static_cast<std::uint64_t>(
+					static_cast<long double>(value)
+					* static_cast<long double>(enabled)
+					/ static_cast<long double>(running)
+				);
+			const auto index{ static_cast<std::size_t>(g.members[i]) };
+			out.values[index] = value;
+			out.available.set(index);
+		}
+	}
+
+	/// Closes every counter of @p g
+	static void close_group(group& g) noexcept
+	{
+		// members first, so that the leader is closed last
+		while (g.size != 0)
+			::close(g.descriptors[--g.size]);
+	}
+	#endif // __linux__
+
+	public:
+	/// Opens every counter which is available to the calling thread
+	perf_counter_group() noexcept
+	{
+		#if defined(__linux__)
+		static constexpr std::array hardware{
+			perf_counter::cycles,
+			perf_counter::instructions,
+			perf_counter::cache_misses,
+			perf_counter::branch_misses
+		};
+		static constexpr std::array software{
+			perf_counter::task_clock,
+			perf_counter::page_faults
+		};
+		open_group(m_hardware, hardware);
+		open_group(m_software, software);
+		#endif // __linux__
+	}
+
+	perf_counter_group(const perf_counter_group&) = delete;
+	perf_counter_group& operator=(const perf_counter_group&) = delete;
+
+	~perf_counter_group()
+	{
+		#if defined(__linux__)
+		close_group(m_hardware);
+		close_group(m_software);
+		#endif // __linux__
+	}
+
+	/// @returns <tt>true</tt> if @p counter was opened
+	[[nodiscard]] bool is_available(const perf_counter counter) const noexcept
+	{ return m_available.test(static_cast<std::size_t>(counter)); }
+
+	/// @returns Which counters were opened
+	[[nodiscard]] std::bitset<number_of_perf_counters> available()
+	const noexcept
+	{ return m_available; }
+
+	/// @returns The current value of every available counter
+	[[nodiscard]] perf_counter_values read() const noexcept
+	{
+		perf_counter_values values;
+		#if defined(__linux__)
+		read_group(m_hardware, values);
+		read_group(m_software, values);
+		#endif // __linux__
+		return values;
+	}
+};
+
+/**
+@returns The calling thread's counters, which are opened the first time this
+	is called by each thread and closed when the thread exits.
+*/
+[[nodiscard]] inline perf_counter_group& this_thread_perf_counters() noexcept
+{
+	thread_local perf_counter_group counters;
+	return counters;
+}
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_PERF_COUNTERS_HPP_INCLUDED
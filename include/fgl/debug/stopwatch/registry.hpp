@@ -0,0 +1,342 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_REGISTRY_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_REGISTRY_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <algorithm> // sort
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../types/string_literal.hpp"
+#include "../output.hpp"
+#include "../stopwatch.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+
+@defgroup group-debug-stopwatch-registry Stopwatch Registry
+
+@ingroup group-debug-stopwatch
+
+@brief Named stopwatches which are shared by every translation unit, and an
+	aggregated report of where the time went
+
+@details
+	<tt>@ref fgl::debug::named_stopwatch()</tt> returns the stopwatch which is
+	named by a compile-time string. Every use of the same name and stopwatch
+	type, in any translation unit, refers to the same stopwatch, which is an
+	<tt>inline</tt> variable template: its address is resolved by the linker,
+	so there's no lookup at run time.
+
+	@code
+	void parse()
+	{
+		auto& sw{ fgl::debug::named_stopwatch<"parse">() };
+		sw.start();
+		// ...
+		sw.stop();
+	}
+	@endcode
+
+	Every named stopwatch is registered with the
+	<tt>@ref fgl::debug::stopwatch_registry</tt>, which produces a
+	<tt>@ref fgl::debug::stopwatch_report</tt> of every stopwatch's laps and
+	total time, sorted by total time. The report can be sent to
+	@ref group-debug-output on demand, and is sent automatically when the
+	program exits unless that's disabled with
+	<tt>@ref fgl::debug::stopwatch_registry::report_at_exit()</tt>.
+
+	@note Named stopwatches are constructed during the dynamic
+		initialization of the program, so they mustn't be used by the
+		constructors of other static objects.
+@{
+*/
+
+/// A summary of a stopwatch's laps, as reported by the registry
+struct stopwatch_summary
+{
+	/// The name of the stopwatch
+	std::string name{};
+
+	/// The number of recorded laps
+	std::size_t number_of_laps{};
+
+	/// The sum of every recorded lap
+	std::chrono::nanoseconds total{};
+
+	/// The mean duration of a lap
+	std::chrono::nanoseconds mean{};
+};
+
+/// The summaries of every registered stopwatch
+struct stopwatch_report
+{
+	/// Sorted by total time, longest first
+	std::vector<stopwatch_summary> stopwatches{};
+
+	/// The sum of the total times of every stopwatch
+	std::chrono::nanoseconds total{};
+};
+
+/**
+@brief The registry of every <tt>@ref named_stopwatch()</tt>.
+@details Stopwatches are registered when they're constructed. When one is
+	destroyed, its summary is retained so that it's still reported.
+	Registration and reporting are thread-safe, but a report mustn't be
+	made while a registered stopwatch is recording a lap.
+*/
+class stopwatch_registry final
+{
+	/// Produces the summary of a type-erased stopwatch
+	using summarize_t = stopwatch_summary (*)(const void*);
+
+	struct entry
+	{
+		/// The registered stopwatch, or <tt>nullptr</tt> once destroyed
+		const void* stopwatch;
+		summarize_t summarize;
+		std::optional<stopwatch_summary> retired_summary;
+	};
+
+	mutable std::mutex m_mutex{};
+	std::vector<entry> m_entries{};
+	bool m_report_at_exit{ true };
+
+	stopwatch_registry() = default;
+
+	public:
+	stopwatch_registry(const stopwatch_registry&) = delete;
+	stopwatch_registry& operator=(const stopwatch_registry&) = delete;
+
+	/// Sends the report to @ref group-debug-output, if enabled
+	~stopwatch_registry();
+
+	/**
+	@returns The registry. It's constructed by the first stopwatch to be
+		registered, so it's destroyed after every registered stopwatch.
+	*/
+	[[nodiscard]] static stopwatch_registry& instance()
+	{
+		static stopwatch_registry registry;
+		return registry;
+	}
+
+	/**
+	@brief Registers a stopwatch.
+	@param sw The stopwatch, which must be unregistered with
+		<tt>@ref retire()</tt> before it's destroyed.
+	@param summarize Produces the summary of @p sw
+	@returns The key to pass to <tt>@ref retire()</tt>
+	*/
+	[[nodiscard]] std::size_t add(
+		const void* const sw,
+		const summarize_t summarize)
+	{
+		const std::scoped_lock lock(m_mutex);
+		m_entries.push_back({ sw, summarize, std::nullopt });
+		return m_entries.size() - 1;
+	}
+
+	/// Retains the summary of the stopwatch registered as @p key
+	void retire(const std::size_t key)
+	{
+		const std::scoped_lock lock(m_mutex);
+		entry& e{ m_entries.at(key) };
+		e.retired_summary = e.summarize(e.stopwatch);
+		e.stopwatch = nullptr;
+	}
+
+	/// Enables or disables sending the report to output when the program exits
+	void report_at_exit(const bool enable) noexcept
+	{
+		const std::scoped_lock lock(m_mutex);
+		m_report_at_exit = enable;
+	}
+
+	/// @returns The summaries of every registered stopwatch
+	[[nodiscard]] stopwatch_report report() const
+	{
+		stopwatch_report r;
+		{
+			const std::scoped_lock lock(m_mutex);
+			r.stopwatches.reserve(m_entries.size());
+			for (const entry& e : m_entries)
+				r.stopwatches.push_back(
+					e.retired_summary
+						? *e.retired_summary
+						: e.summarize(e.stopwatch)
+				);
+		}
+		std::ranges::sort(
+			r.stopwatches,
+			[](const stopwatch_summary& a, const stopwatch_summary& b)
+			{
+				if (a.total != b.total)
+					return a.total > b.total;
+				return a.name < b.name;
+			}
+		);
+		for (const stopwatch_summary& s : r.stopwatches)
+			r.total += s.total;
+		return r;
+	}
+};
+
+/**
+@brief A stopwatch which is registered with the
+	<tt>@ref stopwatch_registry</tt> for its lifetime.
+@tparam T_stopwatch A <tt>@ref generic_stopwatch</tt>.
+*/
+template <typename T_stopwatch>
+class registered_stopwatch final
+{
+	T_stopwatch m_stopwatch;
+	std::size_t m_key;
+
+	[[nodiscard]] static stopwatch_summary summarize(const void* const p)
+	{
+		const auto& sw{ *static_cast<const T_stopwatch*>(p) };
+		stopwatch_summary s;
+		s.name = sw.name;
+		s.number_of_laps = sw.number_of_laps();
+		if (s.number_of_laps == 0)
+			return s;
+		s.total = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			sw.elapsed()
+		);
+		s.mean = s.total / s.number_of_laps;
+		return s;
+	}
+
+	public:
+	/// Constructs and registers a stopwatch named @p name
+	[[nodiscard]] explicit registered_stopwatch(const std::string_view name)
+	:
+		m_stopwatch(std::string(name)),
+		m_key(stopwatch_registry::instance().add(&m_stopwatch, summarize))
+	{}
+
+	registered_stopwatch(const registered_stopwatch&) = delete;
+	registered_stopwatch& operator=(const registered_stopwatch&) = delete;
+
+	/// Retains the stopwatch's summary in the registry
+	~registered_stopwatch()
+	{ stopwatch_registry::instance().retire(m_key); }
+
+	[[nodiscard]] T_stopwatch& get() noexcept
+	{ return m_stopwatch; }
+};
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+template <fgl::string_literal T_name, typename T_stopwatch>
+inline registered_stopwatch<T_stopwatch> named_stopwatch_v{ T_name };
+} // namespace internal
+///@endcond
+
+/**
+@returns The stopwatch named @p T_name, which is shared by every translation
+	unit.
+@tparam T_name The name of the stopwatch
+@tparam T_stopwatch The type of the stopwatch. Different types with the same
+	name are different stopwatches.
+*/
+template <fgl::string_literal T_name, typename T_stopwatch = stopwatch>
+[[nodiscard]] inline T_stopwatch& named_stopwatch() noexcept
+{ return internal::named_stopwatch_v<T_name, T_stopwatch>.get(); }
+
+/**
+@brief An <tt>fgl::debug::output_handler</tt> specialization for sending
+	stopwatch reports to libFGL's @ref group-debug-output.
+@details Shares the stopwatch output channel. Every stopwatch is formatted
+	on its own line with its total time, its share of the report's total
+	time, its number of laps, and its mean lap.
+@see @ref group-debug-output and <tt>@ref fgl::debug::output::operator()()</tt>
+*/
+template <>
+class output_config<stopwatch_report>
+: public simple_output_channel
+	<
+		true,
+		priority::info,
+		internal::stopwatch_cname,
+		output_config<stopwatch_report>
+	>
+{
+	output_config(auto&&...) = delete; ///< should never be instantiated
+	public:
+	using channel_t = simple_output_channel
+	<
+		true,
+		priority::info,
+		internal::stopwatch_cname,
+		output_config<stopwatch_report>
+	>;
+
+	/// @returns <tt>true</tt> if the channel and stopwatch output are enabled
+	[[nodiscard]] static bool enabled() noexcept
+	{ return channel_t::enabled() && !disable_stopwatch_output_channels; }
+
+	/**
+	@brief Report formatter method to satisfy
+		<tt>fgl::debug::output_formatter</tt>
+	@note Doesn't use any configurable formatter, as it may be used while the
+		program exits.
+	*/
+	[[nodiscard]] static std::string format(const stopwatch_report& report)
+	{
+		using config = output_config<stopwatch>;
+		const auto format_duration{
+			[](const std::chrono::nanoseconds d) -> std::string
+			{
+				std::string s{ config::default_duration_formatter(d) };
+				if (!s.empty() && s.back() == ' ')
+					s.pop_back();
+				return s;
+			}
+		};
+		std::ostringstream oss;
+		oss
+			<< "Report: " << report.stopwatches.size() << " stopwatches, "
+			<< format_duration(report.total);
+		for (const stopwatch_summary& s : report.stopwatches)
+		{
+			const double share{
+				report.total.count() == 0
+					? 0.0
+					: 100.0 * static_cast<double>(s.total.count())
+						/ static_cast<double>(report.total.count())
+			};
+			oss
+				<< "\n\t" << s.name << ": " << format_duration(s.total)
+				<< " (" << share << "%), " << s.number_of_laps << " lap"
+				<< (s.number_of_laps == 1 ? "" : "s");
+			if (s.number_of_laps != 0)
+				oss << ", mean " << format_duration(s.mean);
+		}
+		return output::default_fmt_msg(oss.str());
+	}
+};
+
+static_assert(
+	output_handler<output_config<stopwatch_report>, stopwatch_report>
+);
+
+inline stopwatch_registry::~stopwatch_registry()
+{
+	if (m_report_at_exit && !m_entries.empty())
+		fgl::debug::output(report());
+}
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_REGISTRY_HPP_INCLUDED
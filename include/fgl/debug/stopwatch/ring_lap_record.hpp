@@ -0,0 +1,218 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_RING_LAP_RECORD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_RING_LAP_RECORD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <algorithm> // max, min
+#include <chrono>
+#include <span>
+#include <utility> // move
+#include <vector>
+
+#include "../constexpr_assert.hpp"
+#include "./statistics.hpp"
+#include "./lap_record.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch-lap_records
+@{
+*/
+
+/**
+@brief A lap record which retains only the most recent laps, in a ring of
+	fixed capacity.
+@details Storage for every lap is allocated up front, so recording a lap
+	never reallocates. Once the ring is full, each new lap overwrites the
+	oldest one. Lap indices, totals, and statistics all refer to the retained
+	window of laps, where index <tt>0</tt> is the oldest retained lap. The
+	sum of the retained laps is maintained as laps are recorded, so
+	<tt>@ref total()</tt> doesn't need to visit every lap.
+@note The capacity is set by <tt>@ref reserve()</tt>, which the stopwatch
+	calls with its <tt>reserve</tt> constructor argument; for example,
+	<tt>ring_stopwatch sw("requests", 10'000)</tt> retains the last 10,000
+	laps.
+@tparam T_duration The lap duration type.
+*/
+template <typename T_duration>
+class ring_lap_record
+{
+	public:
+	using duration_t = T_duration;
+	using statistics_t = lap_statistics<duration_t>;
+
+	private:
+	/// Grows until it reaches the capacity, then is overwritten in place
+	std::vector<duration_t> m_ring{};
+
+	/// The maximum number of retained laps, at least one
+	std::size_t m_capacity{ 1 };
+
+	/// The position of the oldest lap, once the ring is full
+	std::size_t m_oldest{};
+
+	/// The number of laps which were overwritten
+	std::size_t m_overwritten{};
+
+	/// The sum of the retained laps
+	duration_t m_total{};
+
+	/// @returns The position in the ring of lap number @p index
+	[[nodiscard]] constexpr std::size_t position(const std::size_t index)
+	const noexcept
+	{
+		const std::size_t p{ m_oldest + index };
+		return p < m_ring.size() ? p : p - m_ring.size();
+	}
+
+	public:
+	/// Constructs a record which retains only the most recent lap
+	[[nodiscard]] constexpr ring_lap_record() noexcept = default;
+
+	/**
+	@brief Constructs a record which retains the most recent @p capacity
+		laps, or only the most recent lap if @p capacity is zero.
+	*/
+	[[nodiscard]] constexpr explicit ring_lap_record(const std::size_t capacity)
+	{ reserve(capacity); }
+
+	/**
+	@brief Sets the number of laps which are retained, and allocates them.
+	@details If more laps are retained than the new capacity, the oldest of
+		them are discarded. A capacity of zero is treated as one, because
+		the most recent lap is always retained.
+	*/
+	constexpr void reserve(std::size_t capacity)
+	{
+		capacity = std::max(capacity, std::size_t{ 1 });
+		std::vector<duration_t> ring;
+		ring.reserve(capacity);
+		const std::size_t keep{ std::min(size(), capacity) };
+		for (std::size_t i{ size() - keep }; i < size(); ++i)
+			ring.push_back(at(i));
+		for (std::size_t i{}; i < size() - keep; ++i)
+			m_total -= at(i);
+		m_overwritten += size() - keep;
+		m_ring = std::move(ring);
+		m_capacity = capacity;
+		m_oldest = 0;
+	}
+
+	/// Stores @p lap, overwriting the oldest lap if the ring is full
+	constexpr void record(const duration_t lap)
+	{
+		m_total += lap;
+		if (m_ring.size() < m_capacity)
+		{
+			m_ring.push_back(lap); // never reallocates; see reserve()
+			return;
+		}
+		duration_t& oldest{ m_ring[m_oldest] };
+		m_total -= oldest;
+		oldest = lap;
+		++m_overwritten;
+		if (++m_oldest == m_capacity)
+			m_oldest = 0;
+	}
+
+	/// Discards all laps, but retains the capacity
+	constexpr void clear() noexcept
+	{
+		m_ring.clear();
+		m_oldest = 0;
+		m_overwritten = 0;
+		m_total = duration_t{};
+	}
+
+	/// @returns The number of retained laps
+	[[nodiscard]] constexpr std::size_t size() const noexcept
+	{ return m_ring.size(); }
+
+	/// @returns The maximum number of retained laps
+	[[nodiscard]] constexpr std::size_t capacity() const noexcept
+	{ return m_capacity; }
+
+	/// @returns The number of laps which were overwritten by newer laps
+	[[nodiscard]] constexpr std::size_t overwritten() const noexcept
+	{ return m_overwritten; }
+
+	/// @returns The duration of retained lap number @p index (oldest first)
+	[[nodiscard]] constexpr duration_t at(const std::size_t index) const
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(index < size());
+		return m_ring[position(index)];
+	}
+
+	/// @returns The most recently recorded lap
+	[[nodiscard]] constexpr duration_t back() const
+	{ return at(size() - 1); }
+
+	/// @returns A copy of the retained laps, oldest first
+	[[nodiscard]] constexpr std::vector<duration_t> laps() const
+	{
+		std::vector<duration_t> v;
+		v.reserve(size());
+		for (std::size_t i{}; i < size(); ++i)
+			v.push_back(at(i));
+		return v;
+	}
+
+	/// @returns The sum of retained laps [<tt>start_lap</tt>, <tt>end_lap</tt>)
+	[[nodiscard]] constexpr duration_t total_between(
+		const std::size_t start_lap,
+		const std::size_t end_lap) const
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(start_lap <= end_lap);
+		FGL_DEBUG_CONSTEXPR_ASSERT(end_lap <= size());
+		duration_t sum{};
+		for (std::size_t i{ start_lap }; i < end_lap; ++i)
+			sum += at(i);
+		return sum;
+	}
+
+	/// @returns The sum of the retained laps
+	[[nodiscard]] constexpr duration_t total() const noexcept
+	{ return m_total; }
+
+	/**
+	@returns Exact statistics calculated by selection from a copy of the
+		retained laps
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles = {}) const
+	{
+		std::vector<duration_t> scratch;
+		return calculate_statistics(percentiles, scratch);
+	}
+
+	/**
+	@returns Exact statistics calculated by selection from a copy of the
+		retained laps in @p scratch, which only allocates if it has less
+		capacity than the number of retained laps.
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	@param scratch A buffer which can be reused between calls.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles,
+		std::vector<duration_t>& scratch) const
+	{
+		scratch.assign(m_ring.cbegin(), m_ring.cend());
+		return statistics_t::from_unsorted(scratch, percentiles);
+	}
+};
+
+static_assert(indexed_lap_record<ring_lap_record<std::chrono::nanoseconds>>);
+static_assert(
+	scratch_lap_record<ring_lap_record<std::chrono::nanoseconds>>
+);
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_RING_LAP_RECORD_HPP_INCLUDED
@@ -0,0 +1,429 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_SAMPLED_LAP_RECORD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_SAMPLED_LAP_RECORD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <chrono>
+#include <span>
+#include <utility> // move
+#include <vector>
+
+#include "../constexpr_assert.hpp"
+#include "./statistics.hpp"
+#include "./lap_record.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch-lap_records
+@{
+*/
+
+/**
+@brief How many of the laps which ended were sampled by a sampling lap
+	record.
+@details The statistics of a sampled record describe only the sampled laps;
+	these describe how representative they are.
+*/
+struct sampling_statistics
+{
+	/// The number of laps which ended, whether or not they were sampled
+	std::size_t observed_laps{};
+
+	/// The number of laps which are described by the statistics
+	std::size_t sampled_laps{};
+
+	/// @returns The fraction of the observed laps which were sampled
+	[[nodiscard]] constexpr double rate() const noexcept
+	{
+		if (observed_laps == 0)
+			return 1.0;
+		return
+			static_cast<double>(sampled_laps)
+			/ static_cast<double>(observed_laps);
+	}
+};
+
+/**
+@brief A lap record which only times and records one of every
+	<tt>N</tt> laps, in another lap record.
+@details The first lap is sampled, and then every <tt>N</tt>th lap after it.
+	Because which laps are sampled is known in advance, the stopwatch's
+	<tt>start()</tt>, <tt>lap()</tt>, and <tt>stop()</tt> overloads which
+	read the clock themselves skip reading it when neither the lap that
+	ends nor the lap that begins is sampled (see
+	<tt>@ref sampling_lap_record</tt>). For <tt>start()</tt> and
+	<tt>stop()</tt> pairs, the clock is read twice every <tt>N</tt> laps.
+
+	The number of laps, totals, and statistics of the stopwatch all refer to
+	the sampled laps; <tt>@ref calculate_sampling_statistics()</tt> reports
+	how many laps were observed.
+@warning Deterministic sampling is biased if the laps are periodic with a
+	period that shares a factor with <tt>N</tt>. Use a
+	<tt>@ref reservoir_lap_record</tt> for a uniform sample.
+@tparam T_record The lap record which records the sampled laps.
+*/
+template <lap_record T_record = vector_lap_record<std::chrono::nanoseconds>>
+class sampled_lap_record
+{
+	public:
+	using record_t = T_record;
+	using duration_t = typename record_t::duration_t;
+	using statistics_t = typename record_t::statistics_t;
+
+	/// The sampling period of a default constructed record
+	static constexpr std::size_t default_period{ 100 };
+
+	private:
+	record_t m_record{};
+	std::size_t m_period{ default_period };
+
+	/// The number of laps until the next sampled lap after the current one
+	std::size_t m_countdown{};
+
+	/// Whether the current (or next, if stopped) lap is sampled
+	bool m_current{ true };
+
+	std::size_t m_observed{};
+
+	/// Decides whether the lap after the current one is sampled
+	constexpr void advance() noexcept
+	{
+		m_current = m_countdown == 0;
+		m_countdown = m_current ? m_period - 1 : m_countdown - 1;
+	}
+
+	public:
+	/// Constructs a record which samples one of every 100 laps
+	[[nodiscard]] constexpr sampled_lap_record()
+	{ advance(); }
+
+	/**
+	@brief Constructs a record which samples one of every @p period laps,
+		recorded in @p record.
+	@param period The sampling period. <tt>1</tt> samples every lap.
+	@param record A pre-configured lap record for the sampled laps.
+	*/
+	[[nodiscard]] constexpr explicit sampled_lap_record(
+		const std::size_t period,
+		record_t&& record = record_t{})
+	:
+		m_record(std::move(record)),
+		m_period(period)
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(period > 0);
+		advance();
+	}
+
+	/// Forwards the reserve hint to the record of sampled laps
+	constexpr void reserve(const std::size_t capacity)
+	{
+		if constexpr (requires { m_record.reserve(capacity); })
+			m_record.reserve(capacity);
+	}
+
+	/// @returns The sampling period
+	[[nodiscard]] constexpr std::size_t period() const noexcept
+	{ return m_period; }
+
+	/// @returns <tt>true</tt> if the current lap is sampled
+	[[nodiscard]] constexpr bool samples_this_lap() const noexcept
+	{ return m_current; }
+
+	/// @returns <tt>true</tt> if the lap after the current one is sampled
+	[[nodiscard]] constexpr bool samples_next_lap() const noexcept
+	{ return m_countdown == 0; }
+
+	/// Forwards the start of a sampled lap to the record, if it's notified
+	constexpr void start()
+	requires started_lap_record<record_t>
+	{
+		if (m_current)
+			m_record.start();
+	}
+
+	/// Records @p lap if the current lap is sampled, and ends it
+	constexpr void record(const duration_t lap)
+	{
+		if (m_current)
+			m_record.record(lap);
+		++m_observed;
+		advance();
+	}
+
+	/// Records @p lap and its @p start if the current lap is sampled
+	constexpr void record(const duration_t start, const duration_t lap)
+	requires timestamped_lap_record<record_t>
+	{
+		if (m_current)
+			m_record.record(start, lap);
+		++m_observed;
+		advance();
+	}
+
+	/// Discards all laps, and restarts sampling from the next lap
+	constexpr void clear()
+	{
+		m_record.clear();
+		m_countdown = 0;
+		m_observed = 0;
+		advance();
+	}
+
+	/// @returns The record of sampled laps
+	[[nodiscard]] constexpr const record_t& sampled() const noexcept
+	{ return m_record; }
+
+	/// @returns The number of sampled laps
+	[[nodiscard]] constexpr std::size_t size() const
+	{ return m_record.size(); }
+
+	/// @returns The number of laps which ended, including unsampled laps
+	[[nodiscard]] constexpr std::size_t observed() const noexcept
+	{ return m_observed; }
+
+	/// @returns The duration of sampled lap number @p index
+	[[nodiscard]] constexpr duration_t at(const std::size_t index) const
+	requires indexed_lap_record<record_t>
+	{ return m_record.at(index); }
+
+	/// @returns The most recently sampled lap
+	[[nodiscard]] constexpr duration_t back() const
+	requires requires (const record_t& r) { r.back(); }
+	{ return m_record.back(); }
+
+	/// @returns The sampled laps
+	[[nodiscard]] constexpr decltype(auto) laps() const
+	requires indexed_lap_record<record_t>
+	{ return m_record.laps(); }
+
+	/// @returns The sum of sampled laps [<tt>start_lap</tt>, <tt>end_lap</tt>)
+	[[nodiscard]] constexpr duration_t total_between(
+		const std::size_t start_lap,
+		const std::size_t end_lap) const
+	requires indexed_lap_record<record_t>
+	{ return m_record.total_between(start_lap, end_lap); }
+
+	/// @returns The sum of the sampled laps
+	[[nodiscard]] constexpr duration_t total() const
+	{ return m_record.total(); }
+
+	/// @returns The statistics of the sampled laps
+	[[nodiscard]] constexpr statistics_t calculate_statistics() const
+	{ return m_record.calculate_statistics(); }
+
+	/// @returns The statistics of the sampled laps, including @p percentiles
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles) const
+	requires percentile_lap_record<record_t>
+	{ return m_record.calculate_statistics(percentiles); }
+
+	/// @returns The statistics of the sampled laps, calculated in @p scratch
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles,
+		std::vector<duration_t>& scratch) const
+	requires scratch_lap_record<record_t>
+	{ return m_record.calculate_statistics(percentiles, scratch); }
+
+	/**
+	@returns How many laps were observed and sampled. If the record of
+		sampled laps also samples, such as a
+		<tt>@ref reservoir_lap_record</tt>, only the laps it retains are
+		counted as sampled.
+	*/
+	[[nodiscard]] constexpr sampling_statistics calculate_sampling_statistics()
+	const noexcept
+	{ return { m_observed, m_record.size() }; }
+};
+
+static_assert(sampling_lap_record<sampled_lap_record<>>);
+static_assert(scratch_lap_record<sampled_lap_record<>>);
+static_assert(indexed_lap_record<sampled_lap_record<>>);
+
+/**
+@brief A lap record which retains a uniform random sample of a fixed number
+	of laps.
+@details Every lap is offered to the sample (Vitter's algorithm R), so that
+	after any number of laps each of them is equally likely to be retained.
+	Storage for the sample is allocated up front, so recording a lap never
+	reallocates, and percentiles remain meaningful however many laps are
+	recorded. The sample is drawn with a deterministic pseudo-random
+	generator, so the same laps produce the same sample.
+
+	The number of laps, totals, and statistics of the stopwatch all refer to
+	the retained sample; <tt>@ref calculate_sampling_statistics()</tt>
+	reports how many laps were observed.
+@note The capacity is set by <tt>@ref reserve()</tt>, which the stopwatch
+	calls with its <tt>reserve</tt> constructor argument.
+@note Every lap is still timed. To also avoid reading the clock, use it as
+	the record of a <tt>@ref sampled_lap_record</tt>.
+@tparam T_duration The lap duration type.
+*/
+template <typename T_duration>
+class reservoir_lap_record
+{
+	public:
+	using duration_t = T_duration;
+	using statistics_t = lap_statistics<duration_t>;
+
+	/// The seed of a default constructed record's generator
+	static constexpr std::uint64_t default_seed{ 0x9E3779B97F4A7C15 };
+
+	private:
+	std::vector<duration_t> m_sample{};
+	std::size_t m_capacity{};
+	std::size_t m_observed{};
+	std::uint64_t m_seed{ default_seed };
+	std::uint64_t m_state{ default_seed };
+	duration_t m_total{};
+
+	/// @returns The next value of a SplitMix64 generator
+	[[nodiscard]] constexpr std::uint64_t next_random() noexcept
+	{
+		std::uint64_t z{ m_state += 0x9E3779B97F4A7C15 };
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+		return z ^ (z >> 31);
+	}
+
+	public:
+	/// Constructs a record which must be given a capacity before recording
+	[[nodiscard]] constexpr reservoir_lap_record() noexcept = default;
+
+	/**
+	@brief Constructs a record which retains a sample of @p capacity laps.
+	@param capacity The number of laps in the sample.
+	@param seed The seed of the pseudo-random generator.
+	*/
+	[[nodiscard]] constexpr explicit reservoir_lap_record(
+		const std::size_t capacity,
+		const std::uint64_t seed = default_seed)
+	:
+		m_seed(seed),
+		m_state(seed)
+	{ reserve(capacity); }
+
+	/// Sets the number of laps in the sample, and allocates them
+	constexpr void reserve(const std::size_t capacity)
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(capacity >= m_sample.size());
+		m_sample.reserve(capacity);
+		m_capacity = capacity;
+	}
+
+	/// Offers @p lap to the sample
+	constexpr void record(const duration_t lap)
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(m_capacity > 0);
+		++m_observed;
+		if (m_sample.size() < m_capacity)
+		{
+			m_sample.push_back(lap); // never reallocates; see reserve()
+			m_total += lap;
+			return;
+		}
+		const std::uint64_t i{ next_random() % m_observed };
+		if (i < m_capacity)
+		{
+			duration_t& replaced{ m_sample[static_cast<std::size_t>(i)] };
+			m_total += lap - replaced;
+			replaced = lap;
+		}
+	}
+
+	/// Discards all laps, restarts the generator, and retains the capacity
+	constexpr void clear() noexcept
+	{
+		m_sample.clear();
+		m_observed = 0;
+		m_state = m_seed;
+		m_total = duration_t{};
+	}
+
+	/// @returns The number of laps in the sample
+	[[nodiscard]] constexpr std::size_t size() const noexcept
+	{ return m_sample.size(); }
+
+	/// @returns The maximum number of laps in the sample
+	[[nodiscard]] constexpr std::size_t capacity() const noexcept
+	{ return m_capacity; }
+
+	/// @returns The number of laps which were offered to the sample
+	[[nodiscard]] constexpr std::size_t observed() const noexcept
+	{ return m_observed; }
+
+	/// @returns The duration of sampled lap number @p index, in no order
+	[[nodiscard]] constexpr duration_t at(const std::size_t index) const
+	{ return m_sample.at(index); }
+
+	/// @returns A <tt>const</tt> reference to the sample, in no order
+	[[nodiscard]] constexpr const std::vector<duration_t>& laps()
+	const noexcept
+	{ return m_sample; }
+
+	/// @returns The sum of sampled laps [<tt>start_lap</tt>, <tt>end_lap</tt>)
+	[[nodiscard]] constexpr duration_t total_between(
+		const std::size_t start_lap,
+		const std::size_t end_lap) const
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(start_lap <= end_lap);
+		FGL_DEBUG_CONSTEXPR_ASSERT(end_lap <= m_sample.size());
+		duration_t sum{};
+		for (std::size_t i{ start_lap }; i < end_lap; ++i)
+			sum += m_sample[i];
+		return sum;
+	}
+
+	/// @returns The sum of the sampled laps
+	[[nodiscard]] constexpr duration_t total() const noexcept
+	{ return m_total; }
+
+	/**
+	@returns Exact statistics of the sample, calculated by selection from a
+		copy of it
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles = {}) const
+	{
+		std::vector<duration_t> scratch;
+		return calculate_statistics(percentiles, scratch);
+	}
+
+	/**
+	@returns Exact statistics of the sample, calculated by selection from a
+		copy of it in a reusable @p scratch buffer
+	@see <tt>@ref vector_lap_record::calculate_statistics()</tt>
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles,
+		std::vector<duration_t>& scratch) const
+	{
+		scratch.assign(m_sample.cbegin(), m_sample.cend());
+		return statistics_t::from_unsorted(scratch, percentiles);
+	}
+
+	/// @returns How many laps were observed and retained in the sample
+	[[nodiscard]] constexpr sampling_statistics calculate_sampling_statistics()
+	const noexcept
+	{ return { m_observed, m_sample.size() }; }
+};
+
+static_assert(
+	indexed_lap_record<reservoir_lap_record<std::chrono::nanoseconds>>
+);
+static_assert(
+	scratch_lap_record<reservoir_lap_record<std::chrono::nanoseconds>>
+);
+static_assert(
+	!sampling_lap_record<reservoir_lap_record<std::chrono::nanoseconds>>
+);
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_SAMPLED_LAP_RECORD_HPP_INCLUDED
@@ -0,0 +1,313 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_STATISTICS_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_STATISTICS_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cmath> // sqrt
+#include <algorithm> // clamp, is_sorted, max, min, nth_element
+#include <numeric> // reduce
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "../constexpr_assert.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+
+@defgroup group-debug-stopwatch-statistics Stopwatch Statistics
+
+@ingroup group-debug-stopwatch
+
+@brief Statistics produced from the lap durations recorded by a stopwatch
+
+@details
+	<tt>@ref fgl::debug::lap_statistics</tt> is the common statistics type
+	produced by every @ref group-debug-stopwatch-lap_records "lap record".
+	Values which a record is unable to provide, such as the median of a record
+	which doesn't retain individual laps, are left empty.
+
+	Records which retain every lap calculate order statistics by selection
+	(see <tt>@ref fgl::debug::lap_statistics::from_unsorted()</tt>) rather
+	than by sorting a copy of the laps, and can reuse a caller-provided
+	scratch buffer for the copy so that no allocation is proportional to the
+	number of laps.
+
+	Percentiles use the nearest-rank method: the <i>p</i>th percentile of
+	<i>N</i> laps is the lap at rank <tt>ceil(p / 100 * N)</tt> in ascending
+	order. Records which retain every lap produce exact percentiles, while
+	<tt>@ref fgl::debug::histogram_lap_record</tt> produces approximations
+	with a bounded relative error.
+@{
+*/
+
+/**
+@brief The statistics of a set of lap durations.
+@tparam T_duration The <tt>std::chrono::duration</tt> type of the laps.
+*/
+template <typename T_duration>
+struct lap_statistics
+{
+	using duration_t = T_duration;
+
+	/// A percentile and the lap duration at that percentile
+	struct percentile_value
+	{
+		/// The requested percentile in the range <tt>[0, 100]</tt>
+		double percentile;
+
+		/// The lap duration at the percentile
+		duration_t value;
+	};
+
+	/// The number of laps which the statistics represent
+	std::size_t number_of_laps{};
+
+	/// The sum of all lap durations
+	duration_t total_elapsed{};
+
+	/// The mean lap duration
+	duration_t mean{};
+
+	/// The median lap duration, if the lap record is able to provide it
+	std::optional<duration_t> median{};
+
+	/// The shortest lap duration
+	duration_t min{};
+
+	/// The longest lap duration
+	duration_t max{};
+
+	/// The population standard deviation of the lap durations
+	duration_t standard_deviation{};
+
+	/// Requested percentiles, in the order they were requested
+	std::vector<percentile_value> percentiles{};
+
+	/**
+	@{ @name Constructors
+	@note To generate statistics for a stopwatch, use the the stopwatch's
+		<tt>calculate_statistics()</tt> factory method.
+	*/
+
+	/// Constructs empty statistics, representing zero laps.
+	[[nodiscard]] constexpr lap_statistics() noexcept = default;
+
+	/**
+	@param[in] sorted_laps A vector of lap durations, sorted in ascending
+		order, which will be used to produce the statistics.
+	@param[in] requested_percentiles Percentiles in the range
+		<tt>[0, 100]</tt> to be calculated from @p sorted_laps.
+	*/
+	[[nodiscard]] explicit constexpr lap_statistics(
+		const std::vector<duration_t>& sorted_laps,
+		const std::span<const double> requested_percentiles = {})
+	:
+		number_of_laps{ sorted_laps.size() },
+		total_elapsed{
+			std::reduce(sorted_laps.cbegin(), sorted_laps.cend(), duration_t{})
+		},
+		mean{ get_mean(total_elapsed, number_of_laps) },
+		median{ get_median(sorted_laps) },
+		min{ sorted_laps.empty() ? duration_t{} : sorted_laps.front() },
+		max{ sorted_laps.empty() ? duration_t{} : sorted_laps.back() },
+		standard_deviation{ get_standard_deviation(sorted_laps) }
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(
+			std::is_sorted(sorted_laps.cbegin(), sorted_laps.cend())
+		);
+		if (sorted_laps.empty())
+			return;
+		percentiles.reserve(requested_percentiles.size());
+		for (const double p : requested_percentiles)
+		{
+			const std::size_t rank{ percentile_rank(p, number_of_laps) };
+			percentiles.push_back({ p, sorted_laps[rank - 1] });
+		}
+	}
+	///@} Constructors
+
+	/**
+	@brief Calculates statistics without sorting the laps.
+	@details The sum, min, and max are found in a single pass, and the median
+		and percentiles are found by selection with
+		<tt>std::nth_element</tt>, which is <tt>O(n)</tt> on average rather
+		than <tt>O(n log n)</tt>. Each percentile is selected from only the
+		laps between those already selected. The results are identical to
+		those of the constructor which requires sorted laps, and nothing is
+		allocated other than the requested percentiles.
+	@param[in,out] laps Lap durations in any order, which will be partially
+		reordered.
+	@param[in] requested_percentiles Percentiles in the range
+		<tt>[0, 100]</tt> to be calculated from @p laps.
+	*/
+	[[nodiscard]] static constexpr lap_statistics from_unsorted(
+		const std::span<duration_t> laps,
+		const std::span<const double> requested_percentiles = {})
+	{
+		lap_statistics stats;
+		const std::size_t n{ laps.size() };
+		if (n == 0)
+			return stats;
+
+		duration_t total{};
+		duration_t shortest{ laps.front() };
+		duration_t longest{ laps.front() };
+		for (const duration_t lap : laps)
+		{
+			total += lap;
+			if (lap < shortest)
+				shortest = lap;
+			if (longest < lap)
+				longest = lap;
+		}
+		stats.number_of_laps = n;
+		stats.total_elapsed = total;
+		stats.mean = get_mean(total, n);
+		stats.min = shortest;
+		stats.max = longest;
+		stats.standard_deviation = get_standard_deviation(laps);
+
+		// each selection partitions the laps, so later selections only need
+		// to consider the laps between the nearest indices already selected
+		using diff_t = typename std::span<duration_t>::difference_type;
+		const auto at{
+			[&laps](const std::size_t index) constexpr
+			{ return laps.begin() + static_cast<diff_t>(index); }
+		};
+		const std::size_t mid{ n / 2 };
+		using rep_t = typename duration_t::rep;
+		if (n % 2 == 0)
+		{
+			std::nth_element(laps.begin(), at(mid - 1), laps.end());
+			std::nth_element(at(mid), at(mid), laps.end());
+			stats.median = (laps[mid - 1] + laps[mid]) / rep_t{2};
+		}
+		else
+		{
+			std::nth_element(laps.begin(), at(mid), laps.end());
+			stats.median = laps[mid];
+		}
+
+		stats.percentiles.reserve(requested_percentiles.size());
+		for (const double p : requested_percentiles)
+		{
+			const std::size_t index{ percentile_rank(p, n) - 1 };
+			std::size_t first{ 0 };
+			std::size_t last{ n };
+			bool selected{ false };
+			const auto bound{
+				[&](const std::size_t other) constexpr
+				{
+					if (other == index)
+						selected = true;
+					else if (other < index)
+						first = std::max(first, other + 1);
+					else
+						last = std::min(last, other);
+				}
+			};
+			if (n % 2 == 0)
+				bound(mid - 1);
+			bound(mid);
+			for (const percentile_value& previous : stats.percentiles)
+				bound(percentile_rank(previous.percentile, n) - 1);
+			if (!selected)
+				std::nth_element(at(first), at(index), at(last));
+			stats.percentiles.push_back({ p, laps[index] });
+		}
+		return stats;
+	}
+
+	/**
+	@returns The one-based nearest rank of @p percentile within @p count
+		ordered laps. Always within <tt>[1, count]</tt> if @p count isn't
+		zero.
+	@param percentile A percentile in the range <tt>[0, 100]</tt>
+	@param count The number of ordered laps
+	*/
+	[[nodiscard]] static constexpr std::size_t percentile_rank(
+		const double percentile,
+		const std::size_t count) noexcept
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(percentile >= 0.0 && percentile <= 100.0);
+		const double exact{ percentile / 100.0 * static_cast<double>(count) };
+		auto rank{ static_cast<std::size_t>(exact) };
+		if (static_cast<double>(rank) < exact)
+			++rank; // ceil
+		return std::clamp(rank, std::size_t{ 1 }, count);
+	}
+
+	/// @returns The mean of @p count laps which sum to @p total
+	[[nodiscard]] static constexpr
+	duration_t get_mean(const duration_t total, const std::size_t count)
+	noexcept
+	{
+		using rep_t = typename duration_t::rep;
+		return (count != 0)
+			? total / static_cast<rep_t>(count)
+			: duration_t{};
+	}
+
+	/// @returns The median from a sorted vector of durations
+	[[nodiscard]] static constexpr
+	duration_t get_median(const std::vector<duration_t>& v) noexcept
+	{
+		using rep_t = typename duration_t::rep;
+		const std::size_t size{ v.size() };
+		switch (size)
+		{
+		break; case 0: return {};
+		break; case 1: return { v[0] };
+		break; case 2: return { (v[0] + v[1]) / rep_t{2} };
+		break; default:
+			const std::size_t mid{ size / 2 };
+			return {
+				(size % 2 == 0)
+				? (v[mid-1] + v[mid]) / rep_t{2}
+				: v[mid]
+			};
+		}
+	}
+
+	/**
+	@returns A duration representing the square root of @p variance, which
+		must be in units of <tt>duration_t::rep</tt> squared.
+	*/
+	[[nodiscard]] static constexpr
+	duration_t duration_from_variance(const double variance) noexcept
+	{
+		using rep_t = typename duration_t::rep;
+		return duration_t{ static_cast<rep_t>(std::sqrt(variance)) };
+	}
+
+	/// @returns The population standard deviation of a range of durations
+	[[nodiscard]] static constexpr
+	duration_t get_standard_deviation(const std::span<const duration_t> v)
+	noexcept
+	{
+		if (v.empty())
+			return {};
+		double m{};
+		for (const duration_t lap : v)
+			m += static_cast<double>(lap.count());
+		m /= static_cast<double>(v.size());
+		double sum_of_squares{};
+		for (const duration_t lap : v)
+		{
+			const double delta{ static_cast<double>(lap.count()) - m };
+			sum_of_squares += delta * delta;
+		}
+		return duration_from_variance(
+			sum_of_squares / static_cast<double>(v.size())
+		);
+	}
+};
+
+///@} group-debug-stopwatch-statistics
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_STATISTICS_HPP_INCLUDED
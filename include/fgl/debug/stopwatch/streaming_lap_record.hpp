@@ -0,0 +1,162 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_STREAMING_LAP_RECORD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_STREAMING_LAP_RECORD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <algorithm> // min, max
+#include <chrono>
+
+#include "./statistics.hpp"
+#include "./lap_record.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch-lap_records
+@{
+*/
+
+/**
+@brief A constant-memory lap record which only retains running aggregates.
+@details Maintains the count, sum, minimum, maximum, and a Welford running
+	mean and variance of the recorded laps. Recording a lap is <tt>O(1)</tt>
+	and the footprint of the record never grows, which makes it suitable for
+	long-running probes. Individual laps aren't retained, so the median of the
+	produced statistics is always empty.
+@tparam T_duration The lap duration type.
+*/
+template <typename T_duration>
+class streaming_lap_record
+{
+	public:
+	using duration_t = T_duration;
+	using statistics_t = lap_statistics<duration_t>;
+
+	private:
+	std::size_t m_count{};
+	duration_t m_total{};
+	duration_t m_min{};
+	duration_t m_max{};
+	duration_t m_last{};
+	double m_mean{}; ///< Welford running mean, in units of the duration rep
+	double m_m2{}; ///< Welford sum of squared differences from the mean
+
+	public:
+	/// The running aggregates which make up a streaming lap record
+	struct aggregates
+	{
+		std::size_t count{};
+		duration_t total{};
+		duration_t min{};
+		duration_t max{};
+		duration_t last{};
+		double mean{};
+		double m2{};
+	};
+
+	/// Constructs an empty record
+	[[nodiscard]] constexpr streaming_lap_record() noexcept = default;
+
+	/// Constructs a record from previously obtained running aggregates
+	[[nodiscard]] explicit constexpr
+	streaming_lap_record(const aggregates& a) noexcept
+	:
+		m_count{ a.count },
+		m_total{ a.total },
+		m_min{ a.min },
+		m_max{ a.max },
+		m_last{ a.last },
+		m_mean{ a.mean },
+		m_m2{ a.m2 }
+	{}
+
+	/// @returns A copy of the running aggregates
+	[[nodiscard]] constexpr aggregates get_aggregates() const noexcept
+	{ return { m_count, m_total, m_min, m_max, m_last, m_mean, m_m2 }; }
+
+	/// Accumulates @p lap into the running aggregates
+	constexpr void record(const duration_t lap) noexcept
+	{
+		m_min = (m_count == 0) ? lap : std::min(m_min, lap);
+		m_max = (m_count == 0) ? lap : std::max(m_max, lap);
+		++m_count;
+		m_total += lap;
+		m_last = lap;
+		const double x{ static_cast<double>(lap.count()) };
+		const double delta{ x - m_mean };
+		m_mean += delta / static_cast<double>(m_count);
+		m_m2 += delta * (x - m_mean);
+	}
+
+	/**
+	@brief Combines the aggregates of @p other into this record, as if every
+		lap recorded by @p other had been recorded by this record.
+	@details Uses the parallel variance algorithm of Chan et al.
+	@note The most recently recorded lap is unaffected.
+	*/
+	constexpr void merge(const streaming_lap_record& other) noexcept
+	{
+		if (other.m_count == 0)
+			return;
+		if (m_count == 0)
+		{
+			const duration_t last{ m_last };
+			*this = other;
+			m_last = last;
+			return;
+		}
+		const double n_a{ static_cast<double>(m_count) };
+		const double n_b{ static_cast<double>(other.m_count) };
+		const double n{ n_a + n_b };
+		const double delta{ other.m_mean - m_mean };
+		m_mean += delta * n_b / n;
+		m_m2 += other.m_m2 + delta * delta * n_a * n_b / n;
+		m_count += other.m_count;
+		m_total += other.m_total;
+		m_min = std::min(m_min, other.m_min);
+		m_max = std::max(m_max, other.m_max);
+	}
+
+	/// Discards all aggregates
+	constexpr void clear() noexcept
+	{ *this = streaming_lap_record{}; }
+
+	/// @returns The number of recorded laps
+	[[nodiscard]] constexpr std::size_t size() const noexcept
+	{ return m_count; }
+
+	/// @returns The most recently recorded lap
+	[[nodiscard]] constexpr duration_t back() const noexcept
+	{ return m_last; }
+
+	/// @returns The sum of all recorded laps
+	[[nodiscard]] constexpr duration_t total() const noexcept
+	{ return m_total; }
+
+	/// @returns The population variance, in units of the duration rep squared
+	[[nodiscard]] constexpr double variance() const noexcept
+	{ return (m_count != 0) ? m_m2 / static_cast<double>(m_count) : 0.0; }
+
+	/// @returns Statistics from the running aggregates. The median is empty.
+	[[nodiscard]] constexpr statistics_t calculate_statistics() const noexcept
+	{
+		statistics_t stats;
+		stats.number_of_laps = m_count;
+		stats.total_elapsed = m_total;
+		stats.mean = statistics_t::get_mean(m_total, m_count);
+		stats.min = m_min;
+		stats.max = m_max;
+		stats.standard_deviation =
+			statistics_t::duration_from_variance(variance());
+		return stats;
+	}
+};
+
+static_assert(lap_record<streaming_lap_record<std::chrono::nanoseconds>>);
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_STREAMING_LAP_RECORD_HPP_INCLUDED
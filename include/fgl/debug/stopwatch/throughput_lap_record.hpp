@@ -0,0 +1,320 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_THROUGHPUT_LAP_RECORD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_THROUGHPUT_LAP_RECORD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <algorithm> // sort
+#include <chrono>
+#include <cmath> // sqrt
+#include <concepts> // same_as
+#include <span>
+#include <type_traits> // is_arithmetic_v
+#include <vector>
+
+#include "../../_experimental/units/data_rate.hpp"
+#include "../constexpr_assert.hpp"
+#include "./statistics.hpp"
+#include "./lap_record.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch-lap_records
+@{
+*/
+
+/**
+@brief Satisfied if @p T can be used as the work quantity of a
+	<tt>@ref throughput_lap_record</tt>: an arithmetic count of items, or a
+	<tt>fgl::units::data_size</tt>.
+*/
+template <typename T>
+concept work_quantity =
+	std::is_arithmetic_v<T> || fgl::units::data_size_type<T>;
+
+namespace internal {
+
+template <typename T_quantity>
+struct throughput_type
+{ using type = double; };
+
+template <fgl::units::data_size_type T_quantity>
+struct throughput_type<T_quantity>
+{
+	using type =
+		fgl::units::data_rate<double, T_quantity, std::chrono::seconds>;
+};
+
+} // namespace internal
+
+/**
+@brief The throughput of work per second.
+@details A <tt>fgl::units::data_rate</tt> per second if @p T_quantity is a
+	data size, otherwise a <tt>double</tt> number of items per second.
+*/
+template <work_quantity T_quantity>
+using throughput_t = typename internal::throughput_type<T_quantity>::type;
+
+/**
+@brief The distribution of the per-lap throughputs of a set of laps.
+@details Laps with a zero duration have no meaningful throughput, and are
+	excluded from the distribution but not from the totals.
+@tparam T_quantity The <tt>@ref work_quantity</tt> type of the laps.
+*/
+template <work_quantity T_quantity>
+struct throughput_statistics
+{
+	using quantity_t = T_quantity;
+	using rate_t = throughput_t<T_quantity>;
+
+	/// A percentile and the throughput at that percentile
+	struct percentile_value
+	{
+		/// The requested percentile in the range <tt>[0, 100]</tt>
+		double percentile;
+
+		/// The throughput at the percentile
+		rate_t value;
+	};
+
+	/// The number of laps which have a throughput
+	std::size_t number_of_laps{};
+
+	/// The sum of the work of all laps
+	quantity_t total_quantity{};
+
+	/// The total work divided by the total elapsed time of all laps
+	rate_t overall{};
+
+	/// The mean per-lap throughput
+	rate_t mean{};
+
+	/// The median per-lap throughput
+	rate_t median{};
+
+	/// The lowest per-lap throughput
+	rate_t min{};
+
+	/// The highest per-lap throughput
+	rate_t max{};
+
+	/// The population standard deviation of the per-lap throughputs
+	rate_t standard_deviation{};
+
+	/// Requested percentiles, in the order they were requested
+	std::vector<percentile_value> percentiles{};
+
+	/// @returns The amount of work represented by @p quantity, as a double
+	[[nodiscard]] static constexpr double count(const quantity_t quantity)
+	noexcept
+	{
+		const auto as_double{
+			[]<typename T>(const T value) constexpr noexcept -> double
+			{
+				if constexpr (std::same_as<T, double>)
+					return value;
+				else
+					return static_cast<double>(value);
+			}
+		};
+		if constexpr (fgl::units::data_size_type<quantity_t>)
+			return as_double(quantity.count());
+		else
+			return as_double(quantity);
+	}
+
+	/// @returns The amount of work @p per_second as a <tt>rate_t</tt>
+	[[nodiscard]] static constexpr rate_t make_rate(const double per_second)
+	noexcept
+	{ return rate_t{ per_second }; }
+};
+
+/**
+@brief A lap record which retains every lap along with the quantity of work
+	it performed.
+@details Behaves like a <tt>@ref vector_lap_record</tt>, but also retains
+	the work performed during each lap, such as a number of items or bytes,
+	so that the distribution of throughputs can be calculated with
+	<tt>@ref calculate_throughput_statistics()</tt>.
+@note A lap recorded without a quantity performed no work.
+@tparam T_duration The lap duration type.
+@tparam T_quantity The <tt>@ref work_quantity</tt> type. A number of items
+	by default.
+*/
+template <typename T_duration, work_quantity T_quantity = std::uint64_t>
+class throughput_lap_record
+{
+	public:
+	using duration_t = T_duration;
+	using statistics_t = lap_statistics<duration_t>;
+	using quantity_t = T_quantity;
+	using throughput_statistics_t = throughput_statistics<quantity_t>;
+
+	private:
+	vector_lap_record<duration_t> m_laps{};
+	std::vector<quantity_t> m_quantities{};
+
+	public:
+	/// Reserves space for @p capacity laps to avoid reallocations
+	constexpr void reserve(const std::size_t capacity)
+	{
+		m_laps.reserve(capacity);
+		m_quantities.reserve(capacity);
+	}
+
+	/// Stores @p lap, during which @p quantity work was performed
+	constexpr void record(const duration_t lap, const quantity_t quantity)
+	{
+		m_quantities.push_back(quantity);
+		m_laps.record(lap);
+	}
+
+	/// Stores @p lap, during which no work was performed
+	constexpr void record(const duration_t lap)
+	{ record(lap, quantity_t{}); }
+
+	/// Discards all laps
+	constexpr void clear() noexcept
+	{
+		m_laps.clear();
+		m_quantities.clear();
+	}
+
+	/// @returns The number of recorded laps
+	[[nodiscard]] constexpr std::size_t size() const noexcept
+	{ return m_laps.size(); }
+
+	/// @returns The duration of lap number @p index
+	[[nodiscard]] constexpr duration_t at(const std::size_t index) const
+	{ return m_laps.at(index); }
+
+	/// @returns The work performed during lap number @p index
+	[[nodiscard]] constexpr quantity_t quantity_at(const std::size_t index)
+	const
+	{ return m_quantities.at(index); }
+
+	/// @returns The most recently recorded lap
+	[[nodiscard]] constexpr duration_t back() const
+	{ return m_laps.back(); }
+
+	/// @returns A <tt>const</tt> reference to the vector of laps
+	[[nodiscard]] constexpr const std::vector<duration_t>& laps() const noexcept
+	{ return m_laps.laps(); }
+
+	/// @returns A <tt>const</tt> reference to the vector of quantities
+	[[nodiscard]] constexpr const std::vector<quantity_t>& quantities()
+	const noexcept
+	{ return m_quantities; }
+
+	/// @returns The sum of laps [<tt>start_lap</tt>, <tt>end_lap</tt>)
+	[[nodiscard]] constexpr duration_t total_between(
+		const std::size_t start_lap,
+		const std::size_t end_lap) const
+	{ return m_laps.total_between(start_lap, end_lap); }
+
+	/// @returns The sum of all recorded laps
+	[[nodiscard]] constexpr duration_t total() const
+	{ return m_laps.total(); }
+
+	/**
+	@returns Exact statistics calculated by selection from a copy of the laps
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles = {}) const
+	{ return m_laps.calculate_statistics(percentiles); }
+
+	/**
+	@returns Exact statistics calculated in a reusable @p scratch buffer
+	@see <tt>@ref vector_lap_record::calculate_statistics()</tt>
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles,
+		std::vector<duration_t>& scratch) const
+	{ return m_laps.calculate_statistics(percentiles, scratch); }
+
+	/**
+	@returns The distribution of the per-lap throughputs
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics, using the nearest-rank method on the
+		throughputs in ascending order.
+	*/
+	[[nodiscard]] constexpr throughput_statistics_t
+	calculate_throughput_statistics(
+		const std::span<const double> percentiles = {}) const
+	{
+		using seconds_t = std::chrono::duration<double>;
+		using stats_t = throughput_statistics_t;
+		stats_t stats;
+
+		double total_work{};
+		std::vector<double> rates;
+		rates.reserve(size());
+		for (std::size_t i{}; i < size(); ++i)
+		{
+			stats.total_quantity += m_quantities[i];
+			const double work{ stats_t::count(m_quantities[i]) };
+			total_work += work;
+			const double seconds{ seconds_t(m_laps.at(i)).count() };
+			if (seconds > 0.0)
+				rates.push_back(work / seconds);
+		}
+
+		const double elapsed{ seconds_t(total()).count() };
+		if (elapsed > 0.0)
+			stats.overall = stats_t::make_rate(total_work / elapsed);
+		if (rates.empty())
+			return stats;
+
+		std::ranges::sort(rates);
+		const std::size_t n{ rates.size() };
+		double sum{};
+		for (const double r : rates)
+			sum += r;
+		const double mean{ sum / static_cast<double>(n) };
+		double sum_of_squares{};
+		for (const double r : rates)
+			sum_of_squares += (r - mean) * (r - mean);
+
+		stats.number_of_laps = n;
+		stats.mean = stats_t::make_rate(mean);
+		stats.median = stats_t::make_rate(
+			n % 2 == 0
+			? (rates[n / 2 - 1] + rates[n / 2]) / 2.0
+			: rates[n / 2]
+		);
+		stats.min = stats_t::make_rate(rates.front());
+		stats.max = stats_t::make_rate(rates.back());
+		stats.standard_deviation = stats_t::make_rate(
+			std::sqrt(sum_of_squares / static_cast<double>(n))
+		);
+		stats.percentiles.reserve(percentiles.size());
+		for (const double p : percentiles)
+		{
+			const std::size_t rank{ statistics_t::percentile_rank(p, n) };
+			stats.percentiles.push_back(
+				{ p, stats_t::make_rate(rates[rank - 1]) }
+			);
+		}
+		return stats;
+	}
+};
+
+static_assert(
+	quantified_lap_record<throughput_lap_record<std::chrono::nanoseconds>>
+);
+static_assert(
+	indexed_lap_record<throughput_lap_record<std::chrono::nanoseconds>>
+);
+static_assert(
+	!timestamped_lap_record<throughput_lap_record<std::chrono::nanoseconds>>
+);
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_THROUGHPUT_LAP_RECORD_HPP_INCLUDED
@@ -0,0 +1,138 @@
+#pragma once
+#ifndef FGL_DEBUG_STOPWATCH_TIMELINE_LAP_RECORD_HPP_INCLUDED
+#define FGL_DEBUG_STOPWATCH_TIMELINE_LAP_RECORD_HPP_INCLUDED
+#include "../../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <chrono>
+#include <span>
+#include <vector>
+
+#include "./statistics.hpp"
+#include "./lap_record.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+@ingroup group-debug-stopwatch-lap_records
+@{
+*/
+
+/**
+@brief A lap record which retains every lap along with when it started.
+@details Behaves like a <tt>@ref vector_lap_record</tt>, but also retains
+	the start of every lap as a duration since the clock's epoch. This allows
+	the laps to be placed on a timeline, such as an exported trace.
+@note A lap recorded without a start is assumed to have started when the
+	previous lap ended, or at the clock's epoch if it's the first lap.
+@tparam T_duration The lap duration type.
+*/
+template <typename T_duration>
+class timeline_lap_record
+{
+	public:
+	using duration_t = T_duration;
+	using statistics_t = lap_statistics<duration_t>;
+
+	private:
+	vector_lap_record<duration_t> m_laps{};
+	std::vector<duration_t> m_starts{};
+
+	public:
+	/// Reserves space for @p capacity laps to avoid reallocations
+	constexpr void reserve(const std::size_t capacity)
+	{
+		m_laps.reserve(capacity);
+		m_starts.reserve(capacity);
+	}
+
+	/**
+	@brief Stores @p lap and when it started
+	@param start The start of the lap as a duration since the clock's epoch
+	@param lap The duration of the lap
+	*/
+	constexpr void record(const duration_t start, const duration_t lap)
+	{
+		m_starts.emplace_back(start);
+		m_laps.record(lap);
+	}
+
+	/// Stores @p lap, starting when the previous lap ended
+	constexpr void record(const duration_t lap)
+	{
+		record(m_starts.empty() ? duration_t{} : m_starts.back() + back(), lap);
+	}
+
+	/// Discards all laps
+	constexpr void clear() noexcept
+	{
+		m_laps.clear();
+		m_starts.clear();
+	}
+
+	/// @returns The number of recorded laps
+	[[nodiscard]] constexpr std::size_t size() const noexcept
+	{ return m_laps.size(); }
+
+	/// @returns The duration of lap number @p index
+	[[nodiscard]] constexpr duration_t at(const std::size_t index) const
+	{ return m_laps.at(index); }
+
+	/// @returns The start of lap number @p index, since the clock's epoch
+	[[nodiscard]] constexpr duration_t start_at(const std::size_t index) const
+	{ return m_starts.at(index); }
+
+	/// @returns The most recently recorded lap
+	[[nodiscard]] constexpr duration_t back() const
+	{ return m_laps.back(); }
+
+	/// @returns A <tt>const</tt> reference to the vector of laps
+	[[nodiscard]] constexpr const std::vector<duration_t>& laps() const noexcept
+	{ return m_laps.laps(); }
+
+	/// @returns A <tt>const</tt> reference to the vector of lap starts
+	[[nodiscard]] constexpr const std::vector<duration_t>& starts()
+	const noexcept
+	{ return m_starts; }
+
+	/// @returns The sum of laps [<tt>start_lap</tt>, <tt>end_lap</tt>)
+	[[nodiscard]] constexpr duration_t total_between(
+		const std::size_t start_lap,
+		const std::size_t end_lap) const
+	{ return m_laps.total_between(start_lap, end_lap); }
+
+	/// @returns The sum of all recorded laps
+	[[nodiscard]] constexpr duration_t total() const
+	{ return m_laps.total(); }
+
+	/**
+	@returns Exact statistics calculated by selection from a copy of the laps
+	@param percentiles Percentiles in the range <tt>[0, 100]</tt> to be
+		included in the statistics.
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles = {}) const
+	{ return m_laps.calculate_statistics(percentiles); }
+
+	/**
+	@returns Exact statistics calculated in a reusable @p scratch buffer
+	@see <tt>@ref vector_lap_record::calculate_statistics()</tt>
+	*/
+	[[nodiscard]] constexpr statistics_t calculate_statistics(
+		const std::span<const double> percentiles,
+		std::vector<duration_t>& scratch) const
+	{ return m_laps.calculate_statistics(percentiles, scratch); }
+};
+
+static_assert(
+	timestamped_lap_record<timeline_lap_record<std::chrono::nanoseconds>>
+);
+static_assert(
+	indexed_lap_record<timeline_lap_record<std::chrono::nanoseconds>>
+);
+
+///@}
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_STOPWATCH_TIMELINE_LAP_RECORD_HPP_INCLUDED
@@ -0,0 +1,354 @@
+#pragma once
+#ifndef FGL_DEBUG_TRACE_HPP_INCLUDED
+#define FGL_DEBUG_TRACE_HPP_INCLUDED
+#include "../environment/libfgl_compatibility_check.hpp"
+
+#include <cstddef> // size_t
+#include <cstring> // memcpy
+#include <algorithm> // max
+#include <charconv> // to_chars
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept> // runtime_error
+#include <string>
+#include <string_view>
+#include <system_error> // errc
+#include <utility> // move
+#include <vector>
+
+#include "../types/traits.hpp"
+#include "./constexpr_assert.hpp"
+#include "./stopwatch.hpp"
+#include "./profiler.hpp"
+
+namespace fgl::debug {
+
+/**
+@file
+
+@example example/fgl/debug/trace.cpp
+	An example for @ref group-debug-trace
+
+@defgroup group-debug-trace Trace Export
+
+@brief Exports stopwatch laps and profiling zones as a Chrome trace
+
+@details
+	<tt>@ref fgl::debug::trace_writer</tt> streams events to a file in the
+	Chrome trace-event JSON format, which can be opened by trace viewers such
+	as <tt>chrome://tracing</tt> or Perfetto to see how work overlaps across
+	threads.
+
+	Every event has an absolute start time, a duration, and the id of the
+	thread it occurred on. Laps are exported from stopwatches whose lap
+	record is a <tt>@ref fgl::debug::timestamped_lap_record</tt>, such as
+	<tt>@ref fgl::debug::timeline_stopwatch</tt>. Zones are exported from
+	profilers which have event capture enabled; see
+	<tt>@ref fgl::debug::generic_profiler::capture_events()</tt>.
+
+	Thread ids are the ordinals returned by
+	<tt>@ref fgl::debug::trace_thread_id()</tt>. Threads can be given
+	readable names with <tt>@ref fgl::debug::set_trace_thread_name()</tt>,
+	which are written when the trace is closed.
+
+	Events are formatted with <tt>std::to_chars</tt> into a fixed-size
+	buffer which is written to the file whenever it fills, so memory use is
+	bounded regardless of the number of events.
+
+	@see The example program @ref example/fgl/debug/trace.cpp
+@{
+*/
+
+///@cond FGL_INTERNAL_DOCS
+namespace internal {
+///@internal @brief The names given to threads for exported traces
+struct trace_thread_names final
+{
+	static inline std::mutex mutex{};
+	static inline std::map<std::size_t, std::string> names{};
+};
+} // namespace internal
+///@endcond
+
+/// @returns The id which identifies the calling thread in exported traces
+[[nodiscard]] inline std::size_t trace_thread_id() noexcept
+{ return internal::thread_ordinal(); }
+
+/// Names the calling thread in exported traces
+inline void set_trace_thread_name(std::string name)
+{
+	using registry = internal::trace_thread_names;
+	const std::size_t id{ trace_thread_id() };
+	const std::lock_guard lock(registry::mutex);
+	registry::names.insert_or_assign(id, std::move(name));
+}
+
+/**
+@brief A buffered writer of Chrome trace-event JSON files.
+@details The file is opened by the constructor and completed by
+	<tt>@ref close()</tt>, or the destructor if it wasn't closed.
+*/
+class trace_writer final
+{
+	std::ofstream m_file;
+	std::vector<char> m_buffer;
+	std::size_t m_used;
+	bool m_first_event;
+	bool m_closed;
+
+	void write_buffer()
+	{
+		m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_used));
+		m_used = 0;
+	}
+
+	void append(const std::string_view s)
+	{
+		if (s.size() > m_buffer.size() - m_used)
+		{
+			write_buffer();
+			if (s.size() > m_buffer.size())
+			{
+				m_file.write(s.data(), static_cast<std::streamsize>(s.size()));
+				return;
+			}
+		}
+		std::memcpy(m_buffer.data() + m_used, s.data(), s.size());
+		m_used += s.size();
+	}
+
+	void append(const char c)
+	{ append(std::string_view(&c, 1)); }
+
+	template <typename T>
+	void append_integer(const T value)
+	{
+		char digits[24];
+		const auto [end, ec]{ std::to_chars(digits, digits + 24, value) };
+		FGL_DEBUG_CONSTEXPR_ASSERT(ec == std::errc{});
+		const auto length{ static_cast<std::size_t>(end - digits) };
+		append(std::string_view(digits, length));
+	}
+
+	/// Appends @p ns in microseconds with three decimal places
+	void append_microseconds(const std::chrono::nanoseconds ns)
+	{
+		auto count{ ns.count() };
+		if (count < 0)
+		{
+			append('-');
+			count = -count;
+		}
+		append_integer(count / 1000);
+		const auto fraction{ count % 1000 };
+		append('.');
+		if (fraction < 100)
+			append('0');
+		if (fraction < 10)
+			append('0');
+		append_integer(fraction);
+	}
+
+	/// Appends @p s as a quoted, escaped JSON string
+	void append_string(const std::string_view s)
+	{
+		constexpr std::string_view hex{ "0123456789abcdef" };
+		append('"');
+		for (const char c : s)
+		{
+			const auto uc{ static_cast<unsigned char>(c) };
+			if (c == '"' || c == '\\')
+			{
+				append('\\');
+				append(c);
+			}
+			else if (uc < 0x20)
+			{
+				append("\\u00");
+				append(hex[uc >> 4]);
+				append(hex[uc & 0xF]);
+			}
+			else
+				append(c);
+		}
+		append('"');
+	}
+
+	void begin_event()
+	{
+		if (m_first_event)
+			m_first_event = false;
+		else
+			append(",\n");
+		append('{');
+	}
+
+	void write_registered_thread_names()
+	{
+		using registry = internal::trace_thread_names;
+		const std::lock_guard lock(registry::mutex);
+		for (const auto& [id, thread_name] : registry::names)
+			write_thread_name(id, thread_name);
+	}
+
+public:
+	/// The default size of the write buffer, in bytes
+	static constexpr std::size_t default_buffer_size{ 1 << 20 };
+
+	/**
+	@param path The path of the trace file, which is created or truncated
+	@param buffer_size The size of the write buffer, in bytes
+	@throws std::runtime_error if the file couldn't be opened
+	*/
+	[[nodiscard]] explicit trace_writer(
+		const std::filesystem::path& path,
+		const std::size_t buffer_size = default_buffer_size)
+	:
+		m_file(path, std::ios::binary | std::ios::trunc),
+		m_buffer(std::max(buffer_size, std::size_t{ 64 })),
+		m_used{ 0 },
+		m_first_event{ true },
+		m_closed{ false }
+	{
+		if (!m_file.is_open())
+			throw std::runtime_error("Failed to open trace file");
+		append("{\"traceEvents\":[\n");
+	}
+
+	trace_writer(const trace_writer&) = delete;
+	trace_writer& operator=(const trace_writer&) = delete;
+
+	/// Closes the trace if it hasn't been closed. Errors are discarded.
+	~trace_writer()
+	{
+		if (!m_closed)
+		{
+			try { close(); }
+			catch (...) {}
+		}
+	}
+
+	/**
+	@brief Writes a complete event, which represents a span of time.
+	@param name The name of the event
+	@param category The category of the event
+	@param start When the event started, as a duration since the clock's
+		epoch
+	@param duration The duration of the event
+	@param thread The id of the thread on which the event occurred
+	*/
+	void write_event(
+		const std::string_view name,
+		const std::string_view category,
+		const std::chrono::nanoseconds start,
+		const std::chrono::nanoseconds duration,
+		const std::size_t thread)
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(!m_closed);
+		begin_event();
+		append("\"name\":");
+		append_string(name);
+		append(",\"cat\":");
+		append_string(category);
+		append(",\"ph\":\"X\",\"ts\":");
+		append_microseconds(start);
+		append(",\"dur\":");
+		append_microseconds(duration);
+		append(",\"pid\":1,\"tid\":");
+		append_integer(thread);
+		append('}');
+	}
+
+	/// Writes a metadata event which names the thread @p thread
+	void write_thread_name(
+		const std::size_t thread,
+		const std::string_view name)
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(!m_closed);
+		begin_event();
+		append("\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+		append_integer(thread);
+		append(",\"args\":{\"name\":");
+		append_string(name);
+		append("}}");
+	}
+
+	/**
+	@brief Writes every lap of @p sw as an event named after the stopwatch.
+	@param sw A stopwatch whose record retains when each lap started
+	@param thread The id of the thread which recorded the laps
+	@param category The category of the events
+	*/
+	template <fgl::traits::steady_clock T_clock, indexed_lap_record T_record>
+	requires requires (const T_record& r, const std::size_t i)
+	{ { r.start_at(i) } -> std::same_as<typename T_record::duration_t>; }
+	void write_laps(
+		const generic_stopwatch<T_clock, T_record>& sw,
+		const std::size_t thread = trace_thread_id(),
+		const std::string_view category = "stopwatch")
+	{
+		using std::chrono::duration_cast;
+		using std::chrono::nanoseconds;
+		const T_record& record{ sw.get_record() };
+		for (std::size_t i{}; i < record.size(); ++i)
+		{
+			write_event(
+				sw.name,
+				category,
+				duration_cast<nanoseconds>(record.start_at(i)),
+				duration_cast<nanoseconds>(record.at(i)),
+				thread
+			);
+		}
+	}
+
+	/**
+	@brief Writes every captured zone event of @p p.
+	@param p A profiler with event capture enabled
+	@param category The category of the events
+	*/
+	template <fgl::traits::steady_clock T_clock>
+	void write_zones(
+		const generic_profiler<T_clock>& p,
+		const std::string_view category = "zone")
+	{
+		using std::chrono::duration_cast;
+		using std::chrono::nanoseconds;
+		const auto zones{ p.zones() };
+		for (const auto& event : p.events())
+		{
+			write_event(
+				zones[event.zone].stopwatch.name,
+				category,
+				duration_cast<nanoseconds>(event.start),
+				duration_cast<nanoseconds>(event.duration),
+				p.thread_id
+			);
+		}
+	}
+
+	/**
+	@brief Writes the names of registered threads, completes the JSON
+		document, and closes the file.
+	@throws std::runtime_error if the file couldn't be written
+	*/
+	void close()
+	{
+		FGL_DEBUG_CONSTEXPR_ASSERT(!m_closed);
+		write_registered_thread_names();
+		append("\n]}\n");
+		write_buffer();
+		m_closed = true;
+		m_file.close();
+		if (m_file.fail())
+			throw std::runtime_error("Failed to write trace file");
+	}
+};
+
+///@} group-debug-trace
+} // namespace fgl::debug
+
+#endif // FGL_DEBUG_TRACE_HPP_INCLUDED
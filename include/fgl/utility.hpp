@@ -16,6 +16,7 @@
 	- @ref group-utility-matrix
 	- @ref group-utility-random
 	- @ref group-utility-sleep
+	- @ref group-utility-tsc_clock
 	- @ref group-utility-zip
 */
 
@@ -27,6 +28,7 @@
 #include "./utility/matrix.hpp"
 #include "./utility/random.hpp"
 #include "./utility/sleep.hpp"
+#include "./utility/tsc_clock.hpp"
 #include "./utility/zip.hpp"
 
 #endif // FGL_UTILITY_HPP_INCLUDED
@@ -0,0 +1,231 @@
+#pragma once
+#ifndef FGL_UTILITY_TSC_CLOCK_HPP_INCLUDED
+#define FGL_UTILITY_TSC_CLOCK_HPP_INCLUDED
+#include "../environment/libfgl_compatibility_check.hpp"
+
+#include <cstdint> // uint64_t, int64_t
+#include <chrono>
+#include <limits> // numeric_limits
+#include <ratio> // nano
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h> // __rdtsc, _mm_lfence
+	#include <cpuid.h> // __get_cpuid
+#endif
+
+#include "../types/traits.hpp"
+
+namespace fgl {
+
+/**
+@file
+
+@defgroup group-utility-tsc_clock TSC Clock
+
+@brief A low-overhead steady clock which reads the CPU's time-stamp counter
+
+@details
+	Reading <tt>std::chrono::steady_clock</tt> typically costs tens of
+	nanoseconds, which can dominate the measurement of very short durations.
+	<tt>@ref fgl::tsc_clock</tt> reads the x86 time-stamp counter (TSC)
+	directly, which typically costs only a few nanoseconds, and converts the
+	counter ticks to nanoseconds using a ratio which is calibrated against
+	<tt>std::chrono::steady_clock</tt> the first time the clock is used.
+
+	The TSC is only a valid steady clock if it's <i>invariant</i>: ticking at
+	a constant rate regardless of power states and frequency scaling. If the
+	processor doesn't report an invariant TSC, or isn't an x86 processor, the
+	clock falls back to <tt>std::chrono::steady_clock</tt>.
+
+	<tt>@ref fgl::tsc_clock</tt> satisfies <tt>fgl::traits::steady_clock</tt>
+	and can be used anywhere a steady clock is expected, such as
+	<tt>fgl::debug::generic_stopwatch<fgl::tsc_clock></tt> or
+	<tt>fgl::nano_sleep<fgl::tsc_clock></tt>.
+
+	@note The first call to <tt>now()</tt> blocks for the calibration period
+		(see <tt>@ref fgl::tsc_clock::calibration_period</tt>). Call
+		<tt>@ref fgl::tsc_clock::calibration()</tt> ahead of time to avoid
+		this cost during a measurement.
+	@warning The calibrated ratio is only as accurate as
+		<tt>std::chrono::steady_clock</tt> over the calibration period;
+		typically within a few parts per million.
+@{
+*/
+
+/// <tt>true</tt> if the target architecture provides a time-stamp counter
+[[maybe_unused]] inline constexpr bool tsc_clock_architecture_support{
+#if defined(__x86_64__) || defined(__i386__)
+	true
+#else
+	false
+#endif
+};
+
+/**
+@brief A steady clock which reads the invariant time-stamp counter,
+	calibrated against <tt>std::chrono::steady_clock</tt>.
+@details The epoch of the clock is the moment of calibration.
+*/
+struct tsc_clock
+{
+	using rep = std::int64_t;
+	using period = std::nano;
+	using duration = std::chrono::duration<rep, period>;
+	using time_point = std::chrono::time_point<tsc_clock>;
+	static constexpr bool is_steady{ true };
+
+	/// The time spent comparing the TSC against the steady clock
+	static constexpr std::chrono::milliseconds calibration_period{ 10 };
+
+	/// The result of calibrating the TSC
+	struct calibration_data
+	{
+		/// The counter value at the epoch
+		std::uint64_t epoch_ticks;
+
+		/// The number of nanoseconds per counter tick
+		double nanoseconds_per_tick;
+
+		/// <tt>false</tt> if the clock falls back to the steady clock
+		bool uses_tsc;
+	};
+
+	/**
+	@returns <tt>true</tt> if the processor reports an invariant TSC
+		(<tt>CPUID.80000007H:EDX[8]</tt>).
+	*/
+	[[nodiscard]] static bool has_invariant_tsc() noexcept
+	{
+		#if defined(__x86_64__) || defined(__i386__)
+			unsigned int eax{}, ebx{}, ecx{}, edx{};
+			if (__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx) == 0)
+				return false;
+			return (edx & (1u << 8)) != 0;
+		#else
+			return false;
+		#endif
+	}
+
+	/**
+	@returns The raw time-stamp counter, read after all prior instructions
+		have completed and before any later instructions begin.
+	@note Zero if the architecture doesn't provide a time-stamp counter.
+	*/
+	[[nodiscard]] static std::uint64_t read_ticks() noexcept
+	{
+		#if defined(__x86_64__) || defined(__i386__)
+			_mm_lfence();
+			const std::uint64_t ticks{ __rdtsc() };
+			_mm_lfence();
+			return ticks;
+		#else
+			return 0;
+		#endif
+	}
+
+	/**
+	@returns The raw time-stamp counter without ordering the read relative to
+		surrounding instructions. Cheaper, but the processor may execute the
+		read earlier or later than it appears in program order.
+	@note Zero if the architecture doesn't provide a time-stamp counter.
+	*/
+	[[nodiscard]] static std::uint64_t read_ticks_unordered() noexcept
+	{
+		#if defined(__x86_64__) || defined(__i386__)
+			return __rdtsc();
+		#else
+			return 0;
+		#endif
+	}
+
+	/**
+	@returns The calibration data, which is measured once by the first call.
+	@note Blocks for <tt>@ref calibration_period</tt> on the first call if the
+		processor has an invariant TSC.
+	*/
+	[[nodiscard]] static const calibration_data& calibration() noexcept
+	{
+		static const calibration_data data{ calibrate() };
+		return data;
+	}
+
+	/// @returns The current time point
+	[[nodiscard]] static time_point now() noexcept
+	{
+		// calibrate before reading, so the read isn't before the epoch
+		const calibration_data& c{ calibration() };
+		return from_ticks(c, read_ticks());
+	}
+
+	/**
+	@returns The current time point, using
+		<tt>@ref read_ticks_unordered()</tt>
+	*/
+	[[nodiscard]] static time_point now_unordered() noexcept
+	{
+		const calibration_data& c{ calibration() };
+		return from_ticks(c, read_ticks_unordered());
+	}
+
+	private:
+	[[nodiscard]] static time_point from_ticks(
+		const calibration_data& c,
+		const std::uint64_t ticks) noexcept
+	{
+		if (!c.uses_tsc) [[unlikely]]
+			return time_point{ steady_duration() };
+		// an unordered read, or a read on a core whose counter is slightly
+		// behind, may precede the epoch
+		if (ticks <= c.epoch_ticks)
+			return time_point{};
+		const double elapsed{
+			static_cast<double>(ticks - c.epoch_ticks) * c.nanoseconds_per_tick
+		};
+		constexpr rep max{ std::numeric_limits<rep>::max() };
+		if (elapsed >= static_cast<double>(max)) [[unlikely]]
+			return time_point{ duration{ max } };
+		return time_point{ duration{ static_cast<rep>(elapsed) } };
+	}
+
+	[[nodiscard]] static duration steady_duration() noexcept
+	{
+		using std::chrono::steady_clock;
+		return std::chrono::duration_cast<duration>(
+			steady_clock::now().time_since_epoch()
+		);
+	}
+
+	[[nodiscard]] static calibration_data calibrate() noexcept
+	{
+		if (!tsc_clock_architecture_support || !has_invariant_tsc())
+			return { 0, 1.0, false };
+
+		using std::chrono::steady_clock;
+		const steady_clock::time_point start{ steady_clock::now() };
+		const std::uint64_t start_ticks{ read_ticks() };
+		steady_clock::time_point end{ start };
+		while (end - start < calibration_period)
+			end = steady_clock::now();
+		const std::uint64_t end_ticks{ read_ticks() };
+
+		const auto elapsed{
+			std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+		};
+		if (end_ticks <= start_ticks) // a broken counter
+			return { 0, 1.0, false };
+		return {
+			start_ticks,
+			static_cast<double>(elapsed.count())
+				/ static_cast<double>(end_ticks - start_ticks),
+			true
+		};
+	}
+};
+
+static_assert(fgl::traits::steady_clock<tsc_clock>);
+
+///@} group-utility-tsc_clock
+
+} // namespace fgl
+
+#endif // FGL_UTILITY_TSC_CLOCK_HPP_INCLUDED
@@ -0,0 +1,172 @@
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <cstdint> // int64_t
+#include <cassert>
+#include <array>
+#include <chrono>
+#include <ratio> // nano
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define FGL_SHORT_MACROS
+#include <fgl/debug/constexpr_assert.hpp>
+#include <fgl/bench/benchmark.hpp>
+
+#ifdef NDEBUG
+	#error NDEBUG must not be defined for tests because they rely on assertions
+#endif // NDEBUG
+
+using namespace std::chrono_literals;
+
+/// A steady clock whose time only advances when the test advances it
+struct manual_clock
+{
+	using rep = std::int64_t;
+	using period = std::nano;
+	using duration = std::chrono::duration<rep, period>;
+	using time_point = std::chrono::time_point<manual_clock>;
+	static constexpr bool is_steady{ true };
+
+	static inline time_point current{};
+
+	static time_point now() noexcept
+	{ return current; }
+
+	static void advance(const duration d) noexcept
+	{ current += d; }
+};
+
+/// Exact comparison, without -Wfloat-equal
+constexpr bool same(const double a, const double b)
+{ return !(a < b) && !(b < a); }
+
+constexpr bool test_quantile()
+{
+	constexpr std::array values{ 1.0, 2.0, 3.0, 4.0, 5.0 };
+	const std::span<const double> s(values);
+	constexpr_assert(same(fgl::bench::quantile(s, 0.0), 1.0));
+	constexpr_assert(same(fgl::bench::quantile(s, 0.5), 3.0));
+	constexpr_assert(same(fgl::bench::quantile(s, 0.625), 3.5));
+	constexpr_assert(same(fgl::bench::quantile(s, 1.0), 5.0));
+	return true;
+}
+
+constexpr bool test_reject_outliers()
+{
+	// quartiles are 11 and 14, so the fences are 6.5 and 18.5
+	std::vector<double> v{ 1.0, 10.0, 11.0, 12.0, 13.0, 14.0, 15.0, 100.0 };
+	constexpr_assert(fgl::bench::reject_outliers(v, 1.5) == 2);
+	constexpr_assert(v.size() == 6);
+	constexpr_assert(same(v.front(), 10.0));
+	constexpr_assert(same(v.back(), 15.0));
+
+	// disabled
+	std::vector<double> w{ 1.0, 10.0, 11.0, 12.0, 13.0, 14.0, 15.0, 100.0 };
+	constexpr_assert(fgl::bench::reject_outliers(w, 0.0) == 0);
+	constexpr_assert(w.size() == 8);
+	return true;
+}
+
+bool test_bootstrap()
+{
+	std::vector<double> v;
+	for (int i{}; i < 101; ++i)
+		v.push_back(static_cast<double>(i));
+	const std::span<const double> s(v);
+	const auto ci{ fgl::bench::bootstrap_median_interval(s, 1000, 0.95, 1) };
+	assert(ci.lower <= 50.0 && 50.0 <= ci.upper);
+	assert(ci.lower > 30.0 && ci.upper < 70.0);
+
+	// reproducible for the same seed
+	const auto again{ fgl::bench::bootstrap_median_interval(s, 1000, 0.95, 1) };
+	assert(same(again.lower, ci.lower) && same(again.upper, ci.upper));
+
+	const std::array<double, 1> one{ 7.0 };
+	const auto single{
+		fgl::bench::bootstrap_median_interval(
+			std::span<const double>(one), 1000, 0.95, 1
+		)
+	};
+	assert(same(single.lower, 7.0) && same(single.upper, 7.0));
+	return true;
+}
+
+bool test_harness()
+{
+	fgl::bench::config cfg;
+	cfg.target_duration = 50'000ns;
+	cfg.number_of_samples = 20;
+	cfg.warmup_iterations = 3;
+	fgl::bench::generic_harness<manual_clock> harness(cfg);
+
+	std::size_t calls{};
+	const auto& r{
+		harness.run("constant", [&calls]()
+		{
+			++calls;
+			manual_clock::advance(25ns);
+		})
+	};
+	// a sample of 100 calls reaches the 2500ns target per sample
+	assert(r.iterations_per_sample >= 100);
+	assert(r.statistics.number_of_laps == 20);
+	assert(r.number_of_outliers == 0);
+	assert(r.statistics.median.has_value());
+	assert(*r.statistics.median == 25ns);
+	assert(r.median_lower == 25ns && r.median_upper == 25ns);
+	assert(calls >= 3 + 20 * r.iterations_per_sample);
+
+	cfg.iterations_per_sample = 4;
+	fgl::bench::generic_harness<manual_clock> fixed(cfg);
+	std::size_t n{};
+	fixed.run("spike", [&n]()
+	{
+		// every 40th call of the 80 timed calls stalls for a long time
+		manual_clock::advance(++n % 40 == 0 ? 10'000ns : 10ns);
+	});
+	assert(fixed.results().size() == 1);
+	assert(fixed.results()[0].iterations_per_sample == 4);
+	assert(fixed.results()[0].number_of_outliers == 2);
+	assert(fixed.results()[0].statistics.max == 10ns);
+	return true;
+}
+
+bool test_output()
+{
+	fgl::bench::result r;
+	r.name = "a \"b\"";
+	r.iterations_per_sample = 8;
+	const std::vector<fgl::bench::result::duration_t> samples{ 1.5ns, 2.5ns };
+	r.statistics = fgl::debug::lap_statistics(samples);
+	r.median_lower = 1.5ns;
+	r.median_upper = 2.5ns;
+	r.confidence = 0.95;
+	const std::array results{ r };
+
+	std::ostringstream json;
+	fgl::bench::write_json(json, results);
+	assert(json.str() ==
+		"{\"benchmarks\":[\n{\"name\":\"a \\\"b\\\"\",\"unit\":\"ns\","
+		"\"iterations_per_sample\":8,\"number_of_samples\":2,"
+		"\"number_of_outliers\":0,\"median\":2,\"median_lower\":1.5,"
+		"\"median_upper\":2.5,\"confidence\":0.95,\"mean\":2,\"min\":1.5,"
+		"\"max\":2.5,\"standard_deviation\":0.5}\n]}\n"
+	);
+
+	std::ostringstream csv;
+	fgl::bench::write_csv(csv, results);
+	const std::string s{ csv.str() };
+	assert(s.find("\n\"a \"\"b\"\"\",ns,8,2,0,2,1.5,2.5,0.95,2,1.5,2.5,0.5\n")
+		!= std::string::npos);
+	return true;
+}
+
+int main()
+{
+	static_assert(test_quantile());
+	static_assert(test_reject_outliers());
+	assert(test_bootstrap());
+	assert(test_harness());
+	assert(test_output());
+	return EXIT_SUCCESS;
+}
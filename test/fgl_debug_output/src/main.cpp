@@ -1,7 +1,17 @@
 #include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
 #include <cassert>
+#include <algorithm> // count
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator> // istreambuf_iterator
+#include <memory> // make_shared
 #include <sstream>
+#include <stdexcept> // runtime_error
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <fgl/debug/output.hpp>
 
@@ -47,6 +57,36 @@ static_assert(
 
 using test_config = fgl::debug::output_config<my_struct>;
 
+/// Uses the generic output_config
+struct echo_tag
+{
+	friend std::ostream& operator<<(std::ostream& os, const echo_tag&)
+	{ return os << "echo"; }
+};
+
+template <>
+struct fgl::debug::deferred_formatter<my_struct>
+{
+	static void format(const my_struct& o, std::string& out)
+	{ out += test_config::format(o); }
+};
+
+/// Too large to be captured in an asynchronous output record
+struct large_struct
+{
+	std::array<long long, 16> values;
+};
+
+template <>
+struct fgl::debug::deferred_formatter<large_struct>
+{
+	static void format(const large_struct&, std::string& out)
+	{ out += "[large]"; }
+};
+
+static_assert(fgl::debug::deferred_formattable<my_struct>);
+static_assert(!fgl::debug::deferred_formattable<std::string>);
+
 /// GLOBAL OUTPUT TEST STREAM
 std::stringstream sstream;
 
@@ -100,6 +140,477 @@ bool test_priority_threshold()
 	return true;
 }
 
+/// A stateless formatter object
+struct angle_head
+{
+	std::string operator()(const std::string_view name) const
+	{ return '<' + std::string(name) + "> "; }
+};
+
+std::string colon_head(const std::string_view name)
+{ return std::string(name) + ": "; }
+
+bool test_configurable_formatters()
+{
+	const std::string message{ "configured" };
+	const std::string_view name{ output_config<std::string>::name() };
+	assert(output::format_head.is_default());
+	assert(output::format_head(name) == '[' + std::string(name) + "] ");
+
+	output::format_head = colon_head;
+	assert(!output::format_head.is_default());
+	assert(output::format_head.get() == &colon_head);
+	output(message);
+	assert(last_output() == std::string(name) + ": configured\n");
+
+	// the result of a lambda is converted to the formatter's result
+	output::format_head = [](std::string_view) { return "> "; };
+	output(message);
+	assert(last_output() == "> configured\n");
+
+	output::format_head = angle_head{};
+	output(message);
+	assert(last_output() == '<' + std::string(name) + "> configured\n");
+
+	output::format_head = output::default_fmt_head;
+	assert(output::format_head.is_default());
+	output::format_head = colon_head;
+	output::format_head.reset();
+	assert(output::format_head.is_default());
+
+	// the generic output_config's formatter
+	output_config<echo_tag>::format = [](const echo_tag&)
+	{ return std::string("replaced"); };
+	assert(output_config<echo_tag>::format({}) == "replaced");
+	output_config<echo_tag>::format.reset();
+	assert(output_config<echo_tag>::format({}) == "echo");
+	return true;
+}
+
+/// A channel of high priority, which counts how often it formats
+struct error_channel final
+: public simple_output_channel<true, priority::error, "error", error_channel>
+{
+	static inline int formatted{};
+
+	static std::string format(const int& i)
+	{
+		++formatted;
+		return "error " + std::to_string(i);
+	}
+};
+
+/// Prefixes each line with its priority
+void tag_priority(const output_record& record, std::string& out)
+{
+	out += std::to_string(static_cast<int>(record.level));
+	out += ' ';
+	out += record.line;
+}
+
+bool test_output_sinks()
+{
+	const auto send_info{
+		[](const int i) { output(std::to_string(i)); }
+	};
+	const auto send_error{
+		[](const int i)
+		{ output::custom<int, error_channel, error_channel>(i); }
+	};
+	const std::string info_head{
+		output::format_head(output_config<std::string>::name())
+	};
+	const std::string error_head{ output::format_head("error") };
+
+	// nothing is formatted if no sink would write it
+	output::sinks.add(
+		std::make_shared<memory_ring_sink>(4, priority::maximum)
+	);
+	send_error(0);
+	assert(error_channel::formatted == 0);
+	output::sinks.clear();
+
+	std::ostringstream console_stream;
+	std::ostringstream batched_stream;
+	const auto console{
+		std::make_shared<stream_sink>(console_stream, priority::warning)
+	};
+	const auto batched{
+		std::make_shared<stream_sink>(
+			batched_stream,
+			priority::minimum,
+			sink_policy{ 64, priority::error },
+			tag_priority
+		)
+	};
+	const auto ring{ std::make_shared<memory_ring_sink>(3) };
+	output::sinks.add(console);
+	output::sinks.add(batched);
+	output::sinks.add(ring);
+	assert(output::sinks.size() == 3);
+
+	// each sink's threshold, batching, and flush policy is independent
+	for (int i{}; i < 5; ++i)
+		send_info(i);
+	assert(last_output().empty()); // the stream isn't written
+	assert(console_stream.str().empty());
+	const std::string tagged_info{ std::to_string(static_cast<int>(
+		priority::info
+	)) + ' ' + info_head };
+	assert(batched_stream.str().size() >= 64);
+	assert(batched_stream.str().starts_with(tagged_info + "0\n"));
+	const std::vector<std::string> recent{ ring->lines() };
+	assert(recent.size() == 3);
+	assert(recent.front() == info_head + "2\n");
+	assert(recent.back() == info_head + "4\n");
+
+	send_info(5);
+	assert(!batched_stream.str().ends_with("5\n")); // batched
+	send_error(6);
+	assert(error_channel::formatted == 1);
+	assert(console_stream.str() == error_head + "error 6\n");
+	assert(batched_stream.str().ends_with(
+		tagged_info + "5\n" + std::to_string(static_cast<int>(
+			priority::error
+		)) + ' ' + error_head + "error 6\n"
+	));
+	assert(ring->lines().back() == error_head + "error 6\n");
+
+	// a sink's threshold can change while it's registered
+	console->threshold(priority::minimum);
+	send_info(7);
+	assert(console_stream.str().ends_with(info_head + "7\n"));
+
+	// the writer thread writes to the sinks in asynchronous mode
+	output.async.enable();
+	send_info(8);
+	output::deferred<test_config, "deferred {}">(9);
+	output::stream.flush();
+	output.async.disable();
+	assert(ring->lines().back() == output::format_head(test_config::name())
+		+ "deferred 9\n");
+	assert(console_stream.str().ends_with(info_head + "8\n"
+		+ output::format_head(test_config::name()) + "deferred 9\n"));
+
+	assert(output::sinks.remove(*ring));
+	assert(!output::sinks.remove(*ring));
+	ring->clear();
+	assert(ring->size() == 0);
+	output::sinks.clear();
+	assert(output::sinks.empty());
+	send_info(10);
+	assert(last_output() == info_head + "10\n");
+
+	// a file sink batches its output until it's flushed
+	const std::filesystem::path path{
+		std::filesystem::temp_directory_path() / "fgl_debug_output_sink.log"
+	};
+	const auto read_file{
+		[&path]()
+		{
+			std::ifstream file(path);
+			return std::string(
+				std::istreambuf_iterator<char>(file),
+				std::istreambuf_iterator<char>()
+			);
+		}
+	};
+	{
+		const auto file{ std::make_shared<file_sink>(path) };
+		output::sinks.add(file);
+		send_info(11);
+		assert(read_file().empty());
+		output::stream.flush();
+		assert(read_file() == info_head + "11\n");
+		send_info(12);
+		output::sinks.clear();
+	} // the last of the file's output is written when it's destroyed
+	assert(read_file() == info_head + "11\n" + info_head + "12\n");
+	std::filesystem::remove(path);
+
+	bool threw{ false };
+	try
+	{
+		file_sink bad(path / "not a directory" / "file.log");
+	}
+	catch (const std::runtime_error&)
+	{
+		threw = true;
+	}
+	assert(threw);
+	return true;
+}
+
+/// A string buffer which blocks writes until it's opened
+class gated_buffer final : public std::stringbuf
+{
+	std::atomic<bool> m_entered{ false };
+	std::atomic<bool> m_open{ false };
+
+	protected:
+	std::streamsize xsputn(const char* const s, const std::streamsize n)
+	override
+	{
+		m_entered = true;
+		m_entered.notify_all();
+		m_open.wait(false);
+		return std::stringbuf::xsputn(s, n);
+	}
+
+	public:
+	/// Waits until a write is blocked
+	void wait_until_entered() const
+	{ m_entered.wait(false); }
+
+	void open()
+	{
+		m_open = true;
+		m_open.notify_all();
+	}
+};
+
+/// Records every write to the stream as a whole
+class write_recorder final : public std::stringbuf
+{
+	std::vector<std::string> m_writes{};
+
+	protected:
+	std::streamsize xsputn(const char* const s, const std::streamsize n)
+	override
+	{
+		m_writes.emplace_back(s, static_cast<std::size_t>(n));
+		return n;
+	}
+
+	int_type overflow(const int_type c) override
+	{
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+			m_writes.emplace_back(1, traits_type::to_char_type(c));
+		return traits_type::not_eof(c);
+	}
+
+	public:
+	[[nodiscard]] const std::vector<std::string>& writes() const noexcept
+	{ return m_writes; }
+};
+
+/// Sends output of its own while it's being formatted
+struct nesting_tag
+{
+	friend std::ostream& operator<<(std::ostream& os, const nesting_tag&)
+	{
+		fgl::debug::output("inner");
+		return os << "outer";
+	}
+};
+
+/// A channel which is removed at compile-time
+struct removed_channel final
+: public simple_output_channel<true, priority::info, "removed", removed_channel>
+{
+	static std::string format(const int& i)
+	{ return std::to_string(i); }
+};
+
+template <>
+inline constexpr bool fgl::debug::channel_compiled_in<removed_channel>{
+	false
+};
+
+bool test_compile_time_removal()
+{
+	static_assert(output::compiled_in<test_config>());
+	static_assert(!output::compiled_in<removed_channel>());
+	assert(!output::can_send<removed_channel>());
+
+	// channels below the floor, if they declare a compile-time priority
+	using debug_channel = output_config<echo_tag>;
+	static_assert(debug_channel::compile_time_priority == priority::info);
+	static_assert(internal::compiled_in<debug_channel>(priority::info));
+	static_assert(!internal::compiled_in<debug_channel>(priority::warning));
+	static_assert(internal::compiled_in<test_config>(priority::maximum));
+
+	// arguments aren't evaluated unless the channel can send
+	int evaluated{};
+	const auto argument{ [&evaluated]() { return ++evaluated; } };
+	output::custom<int, removed_channel, removed_channel>(argument());
+	assert(evaluated == 1 && last_output().empty());
+	FGL_DEBUG_OUTPUT_ON(
+		removed_channel,
+		(output::custom<int, removed_channel, removed_channel>(argument()))
+	);
+	FGL_DEBUG_OUTPUT_DEFERRED(removed_channel, "{}", argument());
+	assert(evaluated == 1 && last_output().empty());
+
+	test_config::turn_off();
+	FGL_DEBUG_OUTPUT(my_struct{ argument(), 0, 0 });
+	FGL_DEBUG_OUTPUT_DEFERRED(test_config, "{}", argument());
+	assert(evaluated == 1 && last_output().empty());
+	test_config::turn_on();
+
+	FGL_DEBUG_OUTPUT(my_struct{ argument(), 0, 0 });
+	FGL_DEBUG_OUTPUT_DEFERRED(test_config, "{} {}", argument(), 'x');
+	const std::string head{ output::format_head(test_config::name()) };
+	assert(last_output() == head + "2 0 0\n" + head + "3 x\n");
+	return true;
+}
+
+bool test_deferred_output()
+{
+	enum class color { red, green };
+	const std::string head{ output::format_head(test_config::name()) };
+
+	output::deferred<test_config, "x={} y={} {{literal}}">(1, 2.5);
+	assert(last_output() == head + "x=1 y=2.5 {literal}\n");
+	output::deferred<test_config, "{}{}, {}, {}">(
+		'c', true, color::green, static_cast<int*>(nullptr)
+	);
+	assert(last_output() == head + "ctrue, 1, 0x0\n");
+	output::deferred<test_config, "no arguments">();
+	assert(last_output() == head + "no arguments\n");
+
+	test_config::turn_off();
+	output::deferred<test_config, "{}">(1);
+	assert(last_output().empty());
+	test_config::turn_on();
+
+	// formatted by the writer thread
+	output.async.enable();
+	for (int i{}; i < 3; ++i)
+		output::deferred<test_config, "{}: {}">(i, my_struct{ i, i, i });
+	// too large to capture, so formatted immediately
+	const large_struct large{};
+	output::deferred<test_config, "{}{}">(large.values[0], large);
+	output::stream.flush();
+	output.async.disable();
+	assert(
+		last_output() == head + "0: 0 0 0\n" + head + "1: 1 1 1\n"
+			+ head + "2: 2 2 2\n" + head + "0[large]\n"
+	);
+	return true;
+}
+
+bool test_concurrent_output()
+{
+	write_recorder recorder;
+	std::ostream recorded(&recorder);
+	output::stream = recorded;
+	const std::string head{
+		output::format_head(output_config<std::string>::name())
+	};
+
+	// every line is written whole, by a single write
+	constexpr int threads{ 4 };
+	constexpr int lines{ 200 };
+	std::vector<std::thread> senders;
+	for (int t{}; t < threads; ++t)
+		senders.emplace_back([t]() noexcept
+		{
+			for (int i{}; i < lines; ++i)
+			{
+				output(std::to_string(t * 1000 + i));
+				output::deferred<test_config, "{} {}">(t, i);
+			}
+		});
+	for (std::thread& t : senders)
+		t.join();
+	const std::vector<std::string>& writes{ recorder.writes() };
+	assert(writes.size() == std::size_t{ threads * lines * 2 });
+	const std::string deferred_head{ output::format_head(test_config::name()) };
+	for (int t{}; t < threads; ++t)
+	{
+		for (int i{}; i < lines; ++i)
+		{
+			const std::string line{
+				head + std::to_string(t * 1000 + i) + '\n'
+			};
+			const std::string deferred_line{
+				deferred_head + std::to_string(t) + ' ' + std::to_string(i)
+				+ '\n'
+			};
+			assert(std::ranges::count(writes, line) == 1);
+			assert(std::ranges::count(writes, deferred_line) == 1);
+		}
+	}
+
+	// output sent while formatting output is written first, and whole
+	output(nesting_tag{});
+	assert(writes.size() == std::size_t{ threads * lines * 2 + 2 });
+	assert(
+		writes[writes.size() - 2] ==
+			output::format_head(output_config<const char[6]>::name())
+			+ "inner\n"
+	);
+	assert(
+		writes.back() ==
+			output::format_head(output_config<nesting_tag>::name())
+			+ "outer\n"
+	);
+	output::stream = sstream;
+	return true;
+}
+
+bool test_async_output()
+{
+	// every line is written, and each thread's lines are in order
+	output.async.enable(4, backpressure::block);
+	assert(output.async.enabled());
+	std::vector<std::thread> threads;
+	for (int t{}; t < 4; ++t)
+		threads.emplace_back([t]() noexcept
+		{
+			for (int i{}; i < 100; ++i)
+				output(std::to_string(t * 1000 + i));
+		});
+	for (std::thread& t : threads)
+		t.join();
+	output::stream.flush();
+	const std::string s{ last_output() };
+	for (int t{}; t < 4; ++t)
+	{
+		std::size_t position{};
+		for (int i{}; i < 100; ++i)
+		{
+			const std::string line{ std::to_string(t * 1000 + i) + '\n' };
+			position = s.find(line, position);
+			assert(position != std::string::npos);
+		}
+	}
+	assert(output.async.dropped() == 0);
+
+	// backpressure while the writer thread is blocked by its stream
+	const auto blocked_output{
+		[](const backpressure policy) -> std::string
+		{
+			gated_buffer buffer;
+			std::ostream gated(&buffer);
+			output::stream = gated;
+			output.async.enable(4, policy);
+			output("0");
+			buffer.wait_until_entered(); // the writer is stuck on "0"
+			for (const char* const m : { "1", "2", "3", "4", "5", "6" })
+				output(m);
+			assert(output.async.dropped() == 2);
+			buffer.open();
+			output.async.disable();
+			assert(!output.async.enabled());
+			output::stream = sstream;
+			std::string lines;
+			for (const char c : buffer.str())
+				if (c >= '0' && c <= '9')
+					lines += c;
+			return lines;
+		}
+	};
+	assert(blocked_output(backpressure::drop) == "01234");
+	assert(blocked_output(backpressure::drop_oldest) == "03456");
+
+	// output sent by the program before exiting is written
+	output.async.enable();
+	output("written at exit");
+	return true;
+}
+
 int main()
 {
 	assert(test_config::format({ 1, 2, 3 }) == std::string("1 2 3"));
@@ -139,6 +650,13 @@ int main()
 
 	assert(test_output_channel_enable_status());
 	assert(test_priority_threshold());
+	output::priority_threshold = priority::minimum;
+	assert(test_configurable_formatters());
+	assert(test_compile_time_removal());
+	assert(test_deferred_output());
+	assert(test_concurrent_output());
+	assert(test_output_sinks());
+	assert(test_async_output());
 
 	return EXIT_SUCCESS;
 }
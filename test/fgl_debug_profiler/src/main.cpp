@@ -0,0 +1,168 @@
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <cstdint> // int64_t
+#include <cassert>
+#include <chrono>
+#include <ratio> // nano
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#define FGL_SHORT_MACROS
+#include <fgl/debug/profiler.hpp>
+
+#ifdef NDEBUG
+	#error NDEBUG must not be defined for tests because they rely on assertions
+#endif // NDEBUG
+
+using namespace std::chrono_literals;
+
+/// A steady clock whose time only advances when the test advances it
+struct manual_clock
+{
+	using rep = std::int64_t;
+	using period = std::nano;
+	using duration = std::chrono::duration<rep, period>;
+	using time_point = std::chrono::time_point<manual_clock>;
+	static constexpr bool is_steady{ true };
+
+	static inline time_point current{};
+
+	static time_point now() noexcept
+	{ return current; }
+
+	static void advance(const duration d) noexcept
+	{ current += d; }
+};
+
+using manual_profiler = fgl::debug::generic_profiler<manual_clock>;
+using manual_zone = fgl::debug::generic_profiler_zone<manual_clock>;
+
+void simulated_inner(manual_profiler& p)
+{
+	const manual_zone zone("inner", std::source_location::current(), p);
+	manual_clock::advance(5ns);
+}
+
+void simulated_outer(manual_profiler& p)
+{
+	const manual_zone zone("outer", std::source_location::current(), p);
+	manual_clock::advance(10ns);
+	simulated_inner(p);
+	manual_clock::advance(2ns);
+}
+
+void simulated_recursion(manual_profiler& p, const int depth)
+{
+	const manual_zone zone("recursion", std::source_location::current(), p);
+	manual_clock::advance(1ns);
+	if (depth > 1)
+		simulated_recursion(p, depth - 1);
+}
+
+bool test_call_tree()
+{
+	manual_profiler p("test", 16);
+	for (int i{}; i < 3; ++i)
+		simulated_outer(p);
+	simulated_inner(p);
+
+	const auto zones{ p.zones() };
+	assert(zones.size() == 4); // root, outer, outer/inner, inner
+	assert(p.current() == 0);
+
+	const auto& outer{ zones[1] };
+	assert(outer.stopwatch.name == "outer");
+	assert(outer.depth == 1);
+	assert(outer.calls() == 3);
+	assert(outer.inclusive() == 51ns);
+	assert(outer.exclusive() == 36ns);
+
+	const auto& nested_inner{ zones[2] };
+	assert(nested_inner.stopwatch.name == "inner");
+	assert(nested_inner.depth == 2);
+	assert(nested_inner.parent == 1);
+	assert(nested_inner.calls() == 3);
+	assert(nested_inner.inclusive() == 15ns);
+	assert(nested_inner.exclusive() == 15ns);
+
+	// the same call site reached by a different path is a different zone
+	const auto& inner{ zones[3] };
+	assert(inner.stopwatch.name == "inner");
+	assert(inner.depth == 1);
+	assert(inner.calls() == 1);
+	assert(inner.inclusive() == 5ns);
+
+	p.reset();
+	assert(p.zones().size() == 1);
+	return true;
+}
+
+bool test_recursion()
+{
+	manual_profiler p("test");
+	simulated_recursion(p, 3);
+	const auto zones{ p.zones() };
+	assert(zones.size() == 4);
+	for (std::size_t depth{ 1 }; depth <= 3; ++depth)
+	{
+		assert(zones[depth].depth == depth);
+		assert(zones[depth].calls() == 1);
+		assert(zones[depth].inclusive() == std::chrono::nanoseconds(4 - depth));
+		assert(zones[depth].exclusive() == 1ns);
+	}
+	return true;
+}
+
+bool test_output()
+{
+	manual_profiler p("test");
+	simulated_outer(p);
+
+	std::ostringstream oss;
+	fgl::debug::output::stream = oss;
+	fgl::debug::output(p);
+	fgl::debug::output::stream = std::cout;
+
+	const std::string s{ oss.str() };
+	assert(s.find("[PROFILER]") != std::string::npos);
+	assert(s.find("Profile: test") != std::string::npos);
+	assert(
+		s.find("\n\touter: 1 call, inclusive 17ns, exclusive 12ns")
+		!= std::string::npos
+	);
+	assert(
+		s.find("\n\t  \\_ inner: 1 call, inclusive 5ns, exclusive 5ns")
+		!= std::string::npos
+	);
+	return true;
+}
+
+void profiled_function()
+{
+	PROFILE_FUNCTION;
+	PROFILE_ZONE("labeled");
+}
+
+bool test_macros()
+{
+	profiled_function();
+	profiled_function();
+	const auto zones{ fgl::debug::profiler::this_thread().zones() };
+	assert(zones.size() == 3);
+	assert(zones[1].calls() == 2);
+	assert(
+		zones[1].stopwatch.name.find("profiled_function") != std::string::npos
+	);
+	assert(zones[2].stopwatch.name == "labeled");
+	assert(zones[2].parent == 1);
+	return true;
+}
+
+int main()
+{
+	assert(test_call_tree());
+	assert(test_recursion());
+	assert(test_output());
+	assert(test_macros());
+	return EXIT_SUCCESS;
+}
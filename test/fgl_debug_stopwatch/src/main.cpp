@@ -1,11 +1,33 @@
 #include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <cstdint> // int64_t
 #include <array>
+#include <charconv> // to_chars_result
+#include <cmath> // sqrt
+#include <algorithm> // ranges::equal
 #include <ranges> // subrange
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <iterator> // back_inserter
+#include <sstream>
+#include <stdexcept> // runtime_error
+#include <string>
+#include <string_view>
+#include <system_error> // errc
+#include <thread>
+#include <vector>
 
 #define FGL_SHORT_MACROS
 #include <fgl/debug/constexpr_assert.hpp>
 
 #include <fgl/debug/stopwatch.hpp>
+#include <fgl/debug/stopwatch/baseline.hpp>
+#include <fgl/debug/stopwatch/concurrent_stopwatch.hpp>
+#include <fgl/debug/stopwatch/interval_reporter.hpp>
+#include <fgl/debug/stopwatch/overhead.hpp>
+#include <fgl/debug/stopwatch/parallel_statistics.hpp>
+#include <fgl/debug/stopwatch/perf_counter_lap_record.hpp>
+#include <fgl/debug/stopwatch/registry.hpp>
 
 #ifdef NDEBUG
 	#error NDEBUG must not be defined for tests because they rely on assertions
@@ -19,6 +41,16 @@
 using namespace std::chrono_literals;
 using namespace std::chrono;
 using fgl::debug::stopwatch;
+using fgl::debug::streaming_stopwatch;
+using fgl::debug::histogram_stopwatch;
+using fgl::debug::concurrent_stopwatch;
+using fgl::debug::timeline_stopwatch;
+using fgl::debug::ring_stopwatch;
+using fgl::debug::compressed_stopwatch;
+using fgl::debug::sampled_stopwatch;
+using fgl::debug::reservoir_stopwatch;
+using fgl::debug::throughput_stopwatch;
+using fgl::debug::perf_stopwatch;
 
 // should use more datasets or a pseudo-random simulated clock. Meh. Hardcoded.
 static constexpr std::array passage_of_time{ 2ns, 46ns, 80ns, 82ns, 59ns, 65ns, 13ns, 90ns, 71ns, 96ns, 78ns, 55ns, 98ns, 60ns, 84ns, 57ns, 4ns, 11ns, 64ns, 43ns, 45ns, 61ns, 14ns, 63ns, 1ns, 51ns, 68ns, 47ns, 8ns, 87ns, 93ns, 7ns, 53ns, 48ns, 41ns, 81ns, 36ns, 5ns, 76ns, 6ns, 85ns, 69ns, 70ns, 9ns, 97ns, 38ns, 95ns, 66ns, 58ns, 56ns, 92ns, 72ns, 75ns, 42ns, 62ns, 3ns, 83ns, 77ns, 88ns, 12ns, 100ns, 86ns, 10ns, 49ns, 74ns, 37ns, 54ns, 94ns, 99ns, 35ns, 73ns, 89ns, 39ns, 91ns, 67ns, 50ns, 40ns, 44ns, 52ns, 79ns };
@@ -49,9 +81,10 @@ static constexpr std::array durations{
 	}()
 };
 
-constexpr stopwatch create_simulated_stopwatch()
+template <typename T_stopwatch = stopwatch>
+constexpr T_stopwatch create_simulated_stopwatch()
 {
-	stopwatch sw("tester");
+	T_stopwatch sw("tester");
 	sw.start(time_points.front());
 	using std::ranges::subrange;
 	for (const auto p : subrange(time_points.begin()+1, time_points.end()-1))
@@ -67,6 +100,22 @@ constexpr bool test_statistics(const stopwatch::statistics stats)
 	constexpr_assert(stats.median == 61ns);
 	constexpr_assert(stats.min == 1ns);
 	constexpr_assert(stats.max == 100ns);
+	constexpr_assert(stats.standard_deviation == 28ns);
+	constexpr_assert(
+		stats.total_elapsed == time_points.back() - time_points.front()
+	);
+	return true;
+}
+
+constexpr bool test_streaming_statistics(
+	const streaming_stopwatch::statistics stats)
+{
+	constexpr_assert(stats.number_of_laps == durations.size());
+	constexpr_assert(stats.mean == 57ns);
+	constexpr_assert(!stats.median.has_value());
+	constexpr_assert(stats.min == 1ns);
+	constexpr_assert(stats.max == 100ns);
+	constexpr_assert(stats.standard_deviation == 28ns);
 	constexpr_assert(
 		stats.total_elapsed == time_points.back() - time_points.front()
 	);
@@ -92,8 +141,1041 @@ constexpr bool test_stopwatch()
 	return true;
 }
 
+constexpr bool test_streaming_stopwatch()
+{
+	const auto sw{ create_simulated_stopwatch<streaming_stopwatch>() };
+	constexpr_assert(sw.number_of_laps() == durations.size());
+	constexpr_assert(sw.previous_lap() == durations.back());
+	constexpr_assert(sw.elapsed() == time_points.back() - time_points.front());
+	constexpr_assert(test_streaming_statistics(sw.calculate_statistics()));
+	return true;
+}
+
+constexpr bool test_streaming_merge()
+{
+	using record_t = streaming_stopwatch::record_t;
+	constexpr auto half{ durations.size() / 2 };
+	record_t first, second;
+	for (std::size_t i{}; i < durations.size(); ++i)
+		(i < half ? first : second).record(durations[i]);
+	first.merge(second);
+	constexpr_assert(test_streaming_statistics(first.calculate_statistics()));
+	first.clear();
+	constexpr_assert(first.size() == 0);
+	constexpr_assert(first.total() == 0ns);
+	return true;
+}
+
+constexpr std::array test_percentiles_list{ 0.0, 50.0, 90.0, 99.0, 100.0 };
+
+template <typename T_statistics>
+constexpr bool test_percentiles(const T_statistics& stats)
+{
+	constexpr std::array expected{ 1ns, 61ns, 93ns, 100ns, 100ns };
+	constexpr_assert(stats.percentiles.size() == expected.size());
+	for (std::size_t i{}; i < expected.size(); ++i)
+		constexpr_assert(stats.percentiles[i].value == expected[i]);
+	return true;
+}
+
+constexpr bool test_vector_percentiles()
+{
+	const stopwatch sw{ create_simulated_stopwatch() };
+	constexpr_assert(
+		test_percentiles(sw.calculate_statistics(test_percentiles_list))
+	);
+	return true;
+}
+
+// all simulated laps are below 2^precision, so they're counted exactly
+constexpr bool test_histogram_stopwatch()
+{
+	const auto sw{ create_simulated_stopwatch<histogram_stopwatch>() };
+	constexpr_assert(sw.number_of_laps() == durations.size());
+	constexpr_assert(sw.previous_lap() == durations.back());
+	constexpr_assert(sw.elapsed() == time_points.back() - time_points.front());
+	const auto stats{ sw.calculate_statistics(test_percentiles_list) };
+	constexpr_assert(test_statistics(stats));
+	constexpr_assert(test_percentiles(stats));
+	return true;
+}
+
+constexpr bool test_histogram_relative_error()
+{
+	using record_t = histogram_stopwatch::record_t;
+	record_t record;
+	for (std::int64_t i{ 1 }; i <= 1'000'000; i += 997)
+		record.record(nanoseconds{ i * 1'000 });
+	constexpr double max_error{ record_t::max_relative_error };
+	for (const double p : { 1.0, 25.0, 50.0, 99.0, 99.9 })
+	{
+		// the exact lap at the nearest rank of p
+		const auto rank{
+			record_t::statistics_t::percentile_rank(p, record.size())
+		};
+		const double exact{
+			static_cast<double>((1 + static_cast<std::int64_t>(rank - 1) * 997))
+			* 1'000.0
+		};
+		const double approx{
+			static_cast<double>(record.value_at_percentile(p).count())
+		};
+		const double error{ approx > exact ? approx - exact : exact - approx };
+		constexpr_assert(error <= exact * max_error);
+	}
+	return true;
+}
+
+constexpr bool test_histogram_merge()
+{
+	using record_t = histogram_stopwatch::record_t;
+	constexpr auto half{ durations.size() / 2 };
+	record_t whole, first, second;
+	for (std::size_t i{}; i < durations.size(); ++i)
+	{
+		whole.record(durations[i]);
+		(i < half ? first : second).record(durations[i]);
+	}
+	first.merge(second);
+	constexpr_assert(std::ranges::equal(first.buckets(), whole.buckets()));
+	constexpr_assert(
+		test_percentiles(first.calculate_statistics(test_percentiles_list))
+	);
+	first.clear();
+	constexpr_assert(first.size() == 0);
+	constexpr_assert(first.value_at_percentile(50.0) == 0ns);
+	return true;
+}
+
+constexpr bool test_overhead_measurement()
+{
+	std::vector<stopwatch::duration_t> sorted(
+		durations.begin(),
+		durations.end()
+	);
+	std::sort(sorted.begin(), sorted.end());
+	const fgl::debug::stopwatch_overhead overhead(sorted);
+	constexpr_assert(overhead.number_of_samples == durations.size());
+	constexpr_assert(overhead.overhead == 61ns);
+	constexpr_assert(overhead.resolution == 1ns);
+	constexpr_assert(overhead.noise_floor == 20ns); // median abs deviation
+	return true;
+}
+
+constexpr bool test_overhead_subtraction()
+{
+	const stopwatch sw{ create_simulated_stopwatch() };
+	fgl::debug::stopwatch_overhead<stopwatch::duration_t> overhead;
+	overhead.overhead = 10ns;
+	overhead.noise_floor = 2ns;
+	const auto corrected{
+		fgl::debug::subtract_overhead(
+			sw.calculate_statistics(test_percentiles_list),
+			overhead
+		)
+	};
+	constexpr_assert(corrected.number_of_laps == durations.size());
+	constexpr_assert(corrected.overhead == 10ns);
+	constexpr_assert(corrected.noise_floor == 2ns);
+	constexpr_assert(
+		corrected.total_elapsed
+		== time_points.back() - time_points.front() - 10ns * durations.size()
+	);
+	constexpr_assert(corrected.mean == 47ns);
+	constexpr_assert(corrected.median == 51ns);
+	constexpr_assert(corrected.min == 0ns); // clamped, not negative
+	constexpr_assert(corrected.max == 90ns);
+	constexpr_assert(corrected.standard_deviation == 28ns);
+	constexpr_assert(corrected.percentiles[2].value == 83ns);
+	return true;
+}
+
+constexpr bool test_timeline_stopwatch()
+{
+	const auto sw{ create_simulated_stopwatch<timeline_stopwatch>() };
+	test_statistics(sw.calculate_statistics());
+	const auto& record{ sw.get_record() };
+	for (std::size_t i{}; i < durations.size(); ++i)
+	{
+		constexpr_assert(record.at(i) == durations[i]);
+		const auto start{ time_points[i].time_since_epoch() };
+		constexpr_assert(record.start_at(i) == start);
+	}
+
+	// laps recorded without a start begin where the previous lap ended
+	fgl::debug::timeline_lap_record<nanoseconds> r;
+	r.record(10ns, 5ns);
+	r.record(3ns);
+	constexpr_assert(r.start_at(1) == 15ns);
+	constexpr_assert(r.total() == 8ns);
+	return true;
+}
+
+constexpr bool test_throughput_stopwatch()
+{
+	const auto near{
+		[](const double a, const double b) constexpr
+		{ return a - b < 1e-9 && b - a < 1e-9; }
+	};
+
+	throughput_stopwatch sw("tester");
+	const steady_clock::time_point begin{};
+	sw.start(begin);
+	sw.lap(100, begin + 1s); // 100 items/s
+	sw.lap(begin + 2s); // no work
+	sw.lap(400, begin + 4s); // 200 items/s
+	sw.stop(50, begin + 4500ms); // 100 items/s
+	constexpr_assert(sw.number_of_laps() == 4);
+
+	constexpr std::array percentiles{ 50.0, 100.0 };
+	const auto stats{ sw.calculate_throughput_statistics(percentiles) };
+	constexpr_assert(stats.number_of_laps == 4);
+	constexpr_assert(stats.total_quantity == 550);
+	constexpr_assert(near(stats.overall, 550.0 / 4.5));
+	constexpr_assert(near(stats.mean, 100.0));
+	constexpr_assert(near(stats.median, 100.0));
+	constexpr_assert(near(stats.min, 0.0));
+	constexpr_assert(near(stats.max, 200.0));
+	constexpr_assert(near(stats.standard_deviation, std::sqrt(5000.0)));
+	constexpr_assert(near(stats.percentiles[0].value, 100.0));
+	constexpr_assert(near(stats.percentiles[1].value, 200.0));
+
+	// zero-duration laps have no throughput
+	fgl::debug::throughput_lap_record<nanoseconds, fgl::units::bytes> bytes;
+	bytes.record(0ns, fgl::units::bytes{ 10 });
+	bytes.record(2s, fgl::units::bytes{ 4'000'000 });
+	const auto rates{ bytes.calculate_throughput_statistics() };
+	constexpr_assert(rates.number_of_laps == 1);
+	constexpr_assert(rates.total_quantity.count() == 4'000'010);
+	constexpr_assert(near(rates.median.count(), 2'000'000.0));
+	using mb_per_s =
+		fgl::units::data_rate<double, fgl::units::megabytes, seconds>;
+	const auto mb{ fgl::units::data_rate_cast<mb_per_s>(rates.median) };
+	constexpr_assert(near(mb.count(), 2.0));
+	return true;
+}
+
+bool test_perf_counter_statistics()
+{
+	using fgl::debug::perf_counter;
+	using fgl::debug::perf_counter_values;
+	const auto make_deltas{
+		[](const std::uint64_t cycles, const std::uint64_t instructions)
+		{
+			perf_counter_values deltas;
+			deltas[perf_counter::cycles] = cycles;
+			deltas[perf_counter::instructions] = instructions;
+			deltas.available.set(
+				static_cast<std::size_t>(perf_counter::cycles)
+			);
+			deltas.available.set(
+				static_cast<std::size_t>(perf_counter::instructions)
+			);
+			return deltas;
+		}
+	};
+
+	fgl::debug::perf_counter_lap_record<nanoseconds> record;
+	record.record(10ns, make_deltas(100, 300));
+	record.record(20ns, make_deltas(200, 200));
+	record.record(30ns, make_deltas(300, 100));
+	const auto stats{ record.calculate_counter_statistics() };
+	constexpr_assert(stats.number_of_laps == 3);
+	constexpr_assert(record.total() == 60ns);
+	const auto& cycles{ stats[perf_counter::cycles] };
+	constexpr_assert(cycles.has_value());
+	constexpr_assert(cycles->total == 600);
+	constexpr_assert(cycles->min == 100 && cycles->max == 300);
+	constexpr_assert(cycles->mean > 199.9 && cycles->mean < 200.1);
+	constexpr_assert(cycles->median > 199.9 && cycles->median < 200.1);
+	constexpr_assert(stats.instructions_per_cycle.has_value());
+	constexpr_assert(
+		*stats.instructions_per_cycle > 0.99
+		&& *stats.instructions_per_cycle < 1.01
+	);
+	constexpr_assert(!stats[perf_counter::cache_misses].has_value());
+
+	// a counter which is unavailable for any lap has no summary
+	perf_counter_values partial{ make_deltas(1, 1) };
+	partial.available.reset(static_cast<std::size_t>(perf_counter::cycles));
+	record.record(1ns, partial);
+	const auto partial_stats{ record.calculate_counter_statistics() };
+	constexpr_assert(!partial_stats[perf_counter::cycles].has_value());
+	constexpr_assert(!partial_stats.instructions_per_cycle.has_value());
+	constexpr_assert(partial_stats[perf_counter::instructions]->total == 601);
+	return true;
+}
+
+bool test_perf_stopwatch()
+{
+	using fgl::debug::perf_counter;
+	const auto& counters{ fgl::debug::this_thread_perf_counters() };
+	perf_stopwatch sw("tester");
+	volatile std::uint64_t sink{};
+	for (int lap{}; lap < 3; ++lap)
+	{
+		sw.start();
+		for (std::uint64_t i{}; i < 1'000'000; ++i)
+			sink = sink + i;
+		sw.stop();
+	}
+	const auto stats{ sw.calculate_counter_statistics() };
+	constexpr_assert(stats.number_of_laps == 3);
+	for (std::size_t c{}; c < fgl::debug::number_of_perf_counters; ++c)
+	{
+		const auto counter{ static_cast<perf_counter>(c) };
+		// counters which couldn't be opened are never reported
+		constexpr_assert(
+			counters.is_available(counter) == stats[counter].has_value()
+		);
+	}
+	if (counters.is_available(perf_counter::task_clock))
+	{
+		constexpr_assert(stats[perf_counter::task_clock]->min > 0);
+	}
+	if (counters.is_available(perf_counter::instructions))
+	{
+		constexpr_assert(stats[perf_counter::instructions]->min > 1'000'000);
+	}
+	return true;
+}
+
+constexpr bool test_ring_stopwatch()
+{
+	// a ring large enough for every lap behaves like the default record
+	const auto all{ create_simulated_stopwatch<ring_stopwatch>() };
+	constexpr_assert(test_statistics(all.calculate_statistics()));
+
+	ring_stopwatch sw("tester", 4);
+	constexpr_assert(sw.get_record().capacity() == 4);
+	auto now{ ring_stopwatch::time_point_t{} };
+	sw.start(now);
+	for (int i{ 1 }; i <= 6; ++i)
+	{
+		now += nanoseconds{ i };
+		sw.lap(now);
+	}
+	sw.stop_without_record();
+
+	// only laps 3, 4, 5, and 6 are retained, oldest first
+	const auto& record{ sw.get_record() };
+	constexpr_assert(sw.number_of_laps() == 4);
+	constexpr_assert(record.overwritten() == 2);
+	constexpr_assert(sw.get_lap(0) == 3ns);
+	constexpr_assert(sw.get_lap(3) == 6ns);
+	constexpr_assert(sw.previous_lap() == 6ns);
+	constexpr_assert(sw.elapsed() == 18ns);
+	constexpr_assert(sw.elapsed_between_laps(1, 3) == 9ns);
+	constexpr_assert(std::ranges::equal(
+		sw.get_all_laps(),
+		std::array{ 3ns, 4ns, 5ns, 6ns }
+	));
+	const auto stats{ sw.calculate_statistics() };
+	constexpr_assert(stats.number_of_laps == 4);
+	constexpr_assert(stats.min == 3ns && stats.max == 6ns);
+
+	// shrinking keeps the most recent laps
+	fgl::debug::ring_lap_record<nanoseconds> r(3);
+	r.record(1ns);
+	r.record(2ns);
+	r.record(3ns);
+	r.record(4ns);
+	r.reserve(2);
+	constexpr_assert(r.size() == 2 && r.at(0) == 3ns && r.total() == 7ns);
+	r.record(5ns);
+	constexpr_assert(r.at(0) == 4ns && r.back() == 5ns && r.total() == 9ns);
+	constexpr_assert(r.overwritten() == 3);
+	r.clear();
+	constexpr_assert(r.size() == 0 && r.total() == 0ns && r.capacity() == 2);
+
+	// a capacity of zero retains the most recent lap
+	fgl::debug::ring_lap_record<nanoseconds> zero(0);
+	constexpr_assert(zero.capacity() == 1);
+	zero.record(1ns);
+	zero.record(2ns);
+	constexpr_assert(zero.size() == 1 && zero.back() == 2ns);
+	constexpr_assert(zero.total() == 2ns && zero.overwritten() == 1);
+	fgl::debug::ring_lap_record<nanoseconds> unreserved;
+	unreserved.record(3ns);
+	constexpr_assert(unreserved.size() == 1 && unreserved.back() == 3ns);
+	return true;
+}
+
+constexpr bool test_compressed_stopwatch()
+{
+	const auto sw{ create_simulated_stopwatch<compressed_stopwatch>() };
+	constexpr_assert(test_statistics(sw.calculate_statistics()));
+	constexpr_assert(std::ranges::equal(sw.get_all_laps(), durations));
+	constexpr_assert(sw.get_lap(7) == durations[7]);
+	constexpr_assert(sw.previous_lap() == durations.back());
+	constexpr_assert(sw.elapsed() == time_points.back() - time_points.front());
+	// every difference between these laps fits in two bytes
+	const auto& record{ sw.get_record() };
+	constexpr_assert(record.compressed_size() <= 2 * durations.size());
+
+	// small chunks, so that laps are split across several of them
+	fgl::debug::compressed_lap_record<nanoseconds, 16> r;
+	constexpr std::array laps{
+		nanoseconds::max(), nanoseconds::min(), 5ns, 7ns, 3ns,
+		1'000'000'000ns, 4ns, -6ns, 0ns, 300ns, 299ns, 301ns, 8ns, 9ns
+	};
+	for (const nanoseconds lap : laps)
+		r.record(lap);
+	constexpr_assert(r.size() == laps.size());
+	constexpr_assert(r.allocated_size() > 16);
+	for (std::size_t i{}; i < laps.size(); ++i)
+		constexpr_assert(r.at(i) == laps[i]);
+	constexpr_assert(std::ranges::equal(r.laps(), laps));
+	constexpr_assert(r.back() == 9ns);
+	constexpr_assert(r.total_between(0, 2) == -1ns);
+	constexpr_assert(r.total_between(2, 11) == 1'000'000'612ns);
+	constexpr_assert(r.total_between(5, 7) == 1'000'000'004ns);
+	constexpr_assert(r.total_between(12, 14) == 17ns);
+	constexpr_assert(r.total_between(6, 6) == 0ns);
+	r.clear();
+	constexpr_assert(r.size() == 0 && r.compressed_size() == 0);
+	r.record(1ns);
+	constexpr_assert(r.at(0) == 1ns && r.total() == 1ns);
+	return true;
+}
+
+constexpr bool test_sampled_stopwatch()
+{
+	using record_t = sampled_stopwatch::record_t;
+	sampled_stopwatch sw("tester", record_t(3));
+	auto now{ sampled_stopwatch::time_point_t{} };
+	for (int i{ 1 }; i <= 7; ++i)
+	{
+		sw.start(now);
+		now += nanoseconds{ i };
+		sw.stop(now);
+	}
+	// laps 0, 3, and 6 are sampled
+	constexpr_assert(sw.number_of_laps() == 3);
+	constexpr_assert(std::ranges::equal(
+		sw.get_all_laps(),
+		std::array{ 1ns, 4ns, 7ns }
+	));
+	constexpr_assert(sw.elapsed() == 12ns);
+	const auto sampling{ sw.calculate_sampling_statistics() };
+	constexpr_assert(sampling.observed_laps == 7);
+	constexpr_assert(sampling.sampled_laps == 3);
+	constexpr_assert(sampling.rate() > 0.42 && sampling.rate() < 0.43);
+
+	// consecutive laps are sampled the same way, and reset restarts it
+	sw.reset();
+	sw.start(now);
+	for (int i{ 1 }; i <= 7; ++i)
+	{
+		now += nanoseconds{ i };
+		sw.lap(now);
+	}
+	sw.stop_without_record();
+	constexpr_assert(std::ranges::equal(
+		sw.get_all_laps(),
+		std::array{ 1ns, 4ns, 7ns }
+	));
+
+	// a period of one samples every lap
+	const auto all{ [&]()
+	{
+		fgl::debug::generic_stopwatch<steady_clock, record_t> every(
+			"tester",
+			record_t(1)
+		);
+		every.start(time_points.front());
+		using std::ranges::subrange;
+		for (const auto p : subrange(time_points.begin()+1, time_points.end()))
+			every.lap(p);
+		every.stop_without_record();
+		return every;
+	}() };
+	constexpr_assert(test_statistics(all.calculate_statistics()));
+	return true;
+}
+
+/// A steady clock which counts how many times it's read
+struct counting_clock
+{
+	using rep = std::int64_t;
+	using period = std::nano;
+	using duration = std::chrono::duration<rep, period>;
+	using time_point = std::chrono::time_point<counting_clock>;
+	static constexpr bool is_steady{ true };
+	static inline rep reads{};
+
+	[[nodiscard]] static time_point now() noexcept
+	{ return time_point{ duration{ ++reads } }; }
+};
+
+bool test_sampled_clock_reads()
+{
+	using record_t = fgl::debug::sampled_lap_record<
+		fgl::debug::vector_lap_record<counting_clock::duration>
+	>;
+	fgl::debug::generic_stopwatch<counting_clock, record_t> sw(
+		"tester",
+		record_t(10)
+	);
+	for (int i{}; i < 100; ++i)
+	{
+		sw.start();
+		sw.stop();
+	}
+	// only the sampled laps are timed
+	constexpr_assert(counting_clock::reads == 20);
+	constexpr_assert(sw.number_of_laps() == 10);
+	constexpr_assert(sw.calculate_statistics().min == 1ns);
+
+	sw.reset();
+	counting_clock::reads = 0;
+	sw.start();
+	for (int i{}; i < 99; ++i)
+		sw.lap();
+	sw.stop();
+	// the clock is read at the start and the end of every sampled lap
+	constexpr_assert(counting_clock::reads == 20);
+	constexpr_assert(sw.number_of_laps() == 10);
+	constexpr_assert(sw.calculate_sampling_statistics().observed_laps == 100);
+	return true;
+}
+
+constexpr bool test_reservoir_stopwatch()
+{
+	// a reservoir large enough for every lap retains them all
+	const auto all{ create_simulated_stopwatch<reservoir_stopwatch>() };
+	constexpr_assert(test_statistics(all.calculate_statistics()));
+
+	reservoir_stopwatch sw("tester", 100);
+	auto now{ reservoir_stopwatch::time_point_t{} };
+	sw.start(now);
+	for (int i{ 1 }; i <= 10'000; ++i)
+	{
+		now += nanoseconds{ i };
+		sw.lap(now);
+	}
+	sw.stop_without_record();
+	const auto& record{ sw.get_record() };
+	constexpr_assert(record.capacity() == 100);
+	constexpr_assert(sw.number_of_laps() == 100);
+	constexpr_assert(sw.elapsed() == record.total_between(0, 100));
+	const auto sampling{ sw.calculate_sampling_statistics() };
+	constexpr_assert(sampling.observed_laps == 10'000);
+	constexpr_assert(sampling.sampled_laps == 100);
+
+	// a uniform sample of 1..10000 has a mean of about 5000; this is more
+	// than three standard errors (~290) either way
+	const auto stats{ sw.calculate_statistics() };
+	constexpr_assert(stats.mean > 4'000ns && stats.mean < 6'000ns);
+	constexpr_assert(stats.min >= 1ns && stats.max <= 10'000ns);
+
+	// the same seed draws the same sample
+	fgl::debug::reservoir_lap_record<nanoseconds> a(8, 42), b(8, 42);
+	for (int i{ 1 }; i <= 1'000; ++i)
+	{
+		a.record(nanoseconds{ i });
+		b.record(nanoseconds{ i });
+	}
+	constexpr_assert(std::ranges::equal(a.laps(), b.laps()));
+	a.clear();
+	constexpr_assert(a.size() == 0 && a.observed() == 0 && a.capacity() == 8);
+	return true;
+}
+
+constexpr bool test_selection_statistics()
+{
+	using statistics = stopwatch::statistics;
+	// out of order, and with a duplicate, which is selected only once
+	constexpr std::array percentiles{ 90.0, 0.0, 99.9, 50.0, 1.0, 100.0, 90.0 };
+
+	// selection produces exactly the same statistics as sorting
+	constexpr std::array<std::size_t, 5> sizes{ 1, 2, 7, 10, durations.size() };
+	for (const std::size_t n : sizes)
+	{
+		std::vector<nanoseconds> unsorted(
+			durations.cbegin(),
+			durations.cbegin() + static_cast<std::ptrdiff_t>(n)
+		);
+		std::vector<nanoseconds> sorted(unsorted);
+		std::ranges::sort(sorted);
+		const statistics expected(sorted, percentiles);
+		const auto actual{ statistics::from_unsorted(unsorted, percentiles) };
+		constexpr_assert(actual.number_of_laps == expected.number_of_laps);
+		constexpr_assert(actual.total_elapsed == expected.total_elapsed);
+		constexpr_assert(actual.mean == expected.mean);
+		constexpr_assert(actual.median == expected.median);
+		constexpr_assert(actual.min == expected.min);
+		constexpr_assert(actual.max == expected.max);
+		constexpr_assert(
+			actual.standard_deviation == expected.standard_deviation
+		);
+		for (std::size_t i{}; i < percentiles.size(); ++i)
+			constexpr_assert(
+				actual.percentiles[i].value == expected.percentiles[i].value
+			);
+	}
+	constexpr_assert(statistics::from_unsorted({}).number_of_laps == 0);
+
+	// the scratch buffer is reused rather than reallocated
+	const auto sw{ create_simulated_stopwatch() };
+	std::vector<nanoseconds> scratch;
+	constexpr_assert(test_statistics(sw.calculate_statistics({}, scratch)));
+	const auto* const buffer{ scratch.data() };
+	const auto stats{ sw.calculate_statistics(percentiles, scratch) };
+	constexpr_assert(scratch.data() == buffer);
+	constexpr_assert(test_statistics(stats));
+	return true;
+}
+
+bool test_parallel_statistics()
+{
+	using statistics = stopwatch::statistics;
+	constexpr std::array percentiles{ 0.0, 1.0, 50.0, 90.0, 99.9, 100.0 };
+	const auto matches{
+		[&](const std::vector<nanoseconds>& laps, const std::size_t threads)
+		{
+			std::vector<nanoseconds> copy(laps);
+			const auto expected{ statistics::from_unsorted(copy, percentiles) };
+			const auto actual{ fgl::debug::calculate_parallel_statistics(
+				laps, percentiles, threads
+			) };
+			const auto stddev_difference{
+				actual.standard_deviation - expected.standard_deviation
+			};
+			bool same{
+				actual.number_of_laps == expected.number_of_laps
+				&& actual.total_elapsed == expected.total_elapsed
+				&& actual.mean == expected.mean
+				&& actual.median == expected.median
+				&& actual.min == expected.min
+				&& actual.max == expected.max
+				&& stddev_difference <= 1ns && stddev_difference >= -1ns
+			};
+			for (std::size_t i{}; i < percentiles.size(); ++i)
+				same = same && actual.percentiles[i].value
+					== expected.percentiles[i].value;
+			return same;
+		}
+	};
+
+	// a long tail of rare, slow laps, and many identical laps
+	std::vector<nanoseconds> laps;
+	std::uint64_t state{ 12345 };
+	for (int i{}; i < 300'001; ++i)
+	{
+		state = state * 6364136223846793005 + 1442695040888963407;
+		const auto r{ static_cast<std::int64_t>(state >> 40) };
+		laps.push_back(nanoseconds{
+			(r % 1000 == 0) ? r * 1000 : (r % 3 == 0) ? 50 : 40 + r % 200
+		});
+	}
+	constexpr std::array<std::size_t, 3> thread_counts{ 1, 3, 0 };
+	for (const std::size_t threads : thread_counts)
+		constexpr_assert(matches(laps, threads));
+	laps.pop_back(); // an even number of laps
+	constexpr_assert(matches(laps, 4));
+	laps.assign(200'000, 7ns);
+	constexpr_assert(matches(laps, 2));
+	laps.assign(1, 7ns);
+	constexpr_assert(matches(laps, 2));
+	constexpr_assert(
+		fgl::debug::calculate_parallel_statistics(std::vector<nanoseconds>{})
+			.number_of_laps == 0
+	);
+
+	const auto sw{ create_simulated_stopwatch() };
+	constexpr_assert(
+		test_statistics(fgl::debug::calculate_parallel_statistics(sw))
+	);
+	return true;
+}
+
+constexpr bool test_baseline_encoding()
+{
+	const auto encoded{
+		fgl::debug::encode_baseline(
+			std::span<const stopwatch::duration_t>(durations)
+		)
+	};
+	// signature, period, count, and at most two bytes for each lap <= 100ns
+	constexpr_assert(encoded.size() <= 32 + durations.size());
+	const auto decoded{
+		fgl::debug::decode_baseline<stopwatch::duration_t>(encoded)
+	};
+	auto sorted{ durations };
+	std::ranges::sort(sorted);
+	constexpr_assert(std::ranges::equal(decoded, sorted));
+	return true;
+}
+
+bool test_baseline_file()
+{
+	const auto path{
+		std::filesystem::temp_directory_path() / "fgl_debug_stopwatch.baseline"
+	};
+	const stopwatch baseline_sw{ create_simulated_stopwatch() };
+	fgl::debug::write_baseline(path, baseline_sw);
+
+	// the same laps aren't a regression
+	const auto same{ fgl::debug::compare_to_baseline(path, baseline_sw) };
+	constexpr_assert(same.passed());
+	constexpr_assert(same.name == "tester");
+	constexpr_assert(same.baseline_laps == durations.size());
+	constexpr_assert(same.effect_size > 0.49 && same.effect_size < 0.51);
+	constexpr_assert(same.p_value > 0.4);
+
+	// every lap 30% slower is a significant and large regression
+	stopwatch slower_sw("slower");
+	slower_sw.start(stopwatch::time_point_t{});
+	nanoseconds t{};
+	for (const auto lap : durations)
+		slower_sw.lap(stopwatch::time_point_t(t += lap * 13 / 10));
+	slower_sw.stop(stopwatch::time_point_t(t));
+	const auto slower{ fgl::debug::compare_to_baseline(path, slower_sw) };
+	constexpr_assert(!slower.passed());
+	constexpr_assert(slower.p_value < 0.01);
+	constexpr_assert(slower.effect_size > 0.6);
+	constexpr_assert(slower.candidate_median > slower.baseline_median);
+
+	// faster laps aren't a regression
+	const auto faster{
+		fgl::debug::compare_to_baseline(
+			std::span<const nanoseconds>(slower_sw.get_all_laps()),
+			std::span<const nanoseconds>(baseline_sw.get_all_laps())
+		)
+	};
+	constexpr_assert(faster.passed());
+	constexpr_assert(faster.effect_size < 0.4);
+
+	// baselines of a different period are rejected
+	bool threw{ false };
+	try
+	{
+		(void)fgl::debug::read_baseline<microseconds>(path);
+	}
+	catch (const std::runtime_error&)
+	{ threw = true; }
+	constexpr_assert(threw);
+	std::filesystem::remove(path);
+	return true;
+}
+
+bool test_calibrate_overhead()
+{
+	const auto overhead{ fgl::debug::calibrate_overhead(1000, 100) };
+	constexpr_assert(overhead.number_of_samples == 1000);
+	constexpr_assert(overhead.overhead >= 0ns);
+	constexpr_assert(overhead.noise_floor >= overhead.resolution);
+	return true;
+}
+
+bool test_concurrent_stopwatch()
+{
+	constexpr std::size_t number_of_threads{ 4 };
+	concurrent_stopwatch sw("concurrent", number_of_threads);
+	constexpr_assert(sw.number_of_shards() == number_of_threads);
+	constexpr_assert(sw.number_of_laps() == 0);
+
+	std::atomic<bool> done{ false };
+	std::jthread reader(
+		[&sw, &done]() noexcept
+		{
+			// snapshots must always be consistent while writers are recording
+			std::size_t previous{};
+			while (!done.load())
+			{
+				const auto stats{ sw.calculate_statistics() };
+				constexpr_assert(stats.number_of_laps >= previous);
+				if (stats.number_of_laps != 0)
+				{
+					constexpr_assert(stats.min >= 1ns && stats.max <= 100ns);
+					constexpr_assert(stats.mean >= 1ns && stats.mean <= 100ns);
+				}
+				previous = stats.number_of_laps;
+			}
+		}
+	);
+
+	{
+		std::vector<std::jthread> writers;
+		for (std::size_t t{}; t < number_of_threads; ++t)
+			writers.emplace_back(
+				[&sw]() noexcept
+				{
+					for (std::size_t i{}; i + 1 < time_points.size(); ++i)
+					{
+						const auto start{ sw.start(time_points[i]) };
+						sw.stop(start, time_points[i + 1]);
+					}
+				}
+			);
+	}
+	done.store(true);
+	reader.join();
+
+	const auto stats{ sw.calculate_statistics() };
+	constexpr_assert(
+		stats.number_of_laps == durations.size() * number_of_threads
+	);
+	constexpr_assert(test_streaming_statistics(
+		[&stats]()
+		{ // the same laps recorded by every thread have the same statistics
+			auto single{ stats };
+			single.number_of_laps /= number_of_threads;
+			single.total_elapsed /= number_of_threads;
+			return single;
+		}()
+	));
+
+	sw.reset();
+	constexpr_assert(sw.number_of_laps() == 0);
+	constexpr_assert(sw.elapsed() == 0ns);
+	return true;
+}
+
+bool test_concurrent_intervals()
+{
+	constexpr std::size_t number_of_threads{ 4 };
+	constexpr std::size_t laps_per_thread{ 20'000 };
+	concurrent_stopwatch sw("intervals", number_of_threads);
+
+	// every lap belongs to exactly one interval, even while recording
+	std::atomic<bool> done{ false };
+	std::size_t collected{};
+	std::jthread collector(
+		[&sw, &done, &collected]() noexcept
+		{
+			while (!done.load())
+			{
+				const auto interval{ sw.take_interval() };
+				if (interval.size() != 0)
+				{
+					const auto stats{ interval.calculate_statistics() };
+					constexpr_assert(stats.min >= 1ns && stats.max <= 3ns);
+				}
+				collected += interval.size();
+			}
+		}
+	);
+	{
+		std::vector<std::jthread> writers;
+		for (std::size_t t{}; t < number_of_threads; ++t)
+			writers.emplace_back(
+				[&sw]() noexcept
+				{
+					for (std::size_t i{}; i < laps_per_thread; ++i)
+						sw.record(nanoseconds{ 1 + i % 3 });
+				}
+			);
+	}
+	done.store(true);
+	collector.join();
+	collected += sw.take_interval().size();
+	constexpr_assert(collected == number_of_threads * laps_per_thread);
+	constexpr_assert(sw.number_of_laps() == collected);
+
+	// intervals aren't cumulative
+	sw.record(5ns);
+	sw.record(7ns);
+	const auto interval{ sw.take_interval() };
+	constexpr_assert(interval.size() == 2);
+	constexpr_assert(interval.total() == 12ns);
+	constexpr_assert(sw.take_interval().size() == 0);
+	return true;
+}
+
+bool test_interval_reporter()
+{
+	std::ostringstream oss;
+	fgl::debug::output::stream = oss;
+	concurrent_stopwatch sw("reported", 2);
+	{
+		fgl::debug::interval_reporter reporter(sw, 1h);
+		sw.record(10ns);
+		sw.record(20ns);
+	} // the final interval is reported when the reporter is destroyed
+	{
+		// empty intervals aren't reported
+		fgl::debug::interval_reporter reporter(sw, 1ms);
+		std::this_thread::sleep_for(5ms);
+	}
+	fgl::debug::disable_stopwatch_output_channels = true;
+	{
+		fgl::debug::interval_reporter reporter(sw, 1h);
+		sw.record(30ns);
+	} // suppressed along with every other stopwatch channel
+	fgl::debug::disable_stopwatch_output_channels = false;
+	{
+		// a report which throws doesn't terminate the reporting thread
+		using config = fgl::debug::output_config<
+			fgl::debug::stopwatch_interval<steady_clock>
+		>::stopwatch_config_t;
+		config::duration_formatter =
+			[](const auto) -> std::string
+			{ throw std::runtime_error("unformattable"); };
+		{
+			fgl::debug::interval_reporter reporter(sw, 1ms);
+			sw.record(40ns);
+			std::this_thread::sleep_for(5ms);
+			sw.record(50ns);
+		}
+		config::duration_formatter.reset();
+	}
+	fgl::debug::output::stream = std::cout;
+
+	const std::string s{ oss.str() };
+	constexpr_assert(s.find("Interval: reported #0") != std::string::npos);
+	constexpr_assert(s.find("#1") == std::string::npos);
+	constexpr_assert(s.find("Number of laps: 2") != std::string::npos);
+	constexpr_assert(s.find("Mean lap:       15ns") != std::string::npos);
+	constexpr_assert(s.find("Number of laps: 1") == std::string::npos);
+	return true;
+}
+
+bool test_stopwatch_registry()
+{
+	using fgl::debug::named_stopwatch;
+	auto& registry{ fgl::debug::stopwatch_registry::instance() };
+	registry.report_at_exit(false);
+
+	// the same name is the same stopwatch
+	auto& parse{ named_stopwatch<"parse">() };
+	constexpr_assert(&parse == &named_stopwatch<"parse">());
+	constexpr_assert(parse.name == "parse");
+	auto& load{ named_stopwatch<"load">() };
+	constexpr_assert(&load != &parse);
+	[[maybe_unused]] const auto& idle{ named_stopwatch<"idle">() };
+
+	parse.start(stopwatch::time_point_t{});
+	parse.stop(stopwatch::time_point_t{ 30ns });
+	load.start(stopwatch::time_point_t{});
+	load.lap(stopwatch::time_point_t{ 40ns });
+	load.stop(stopwatch::time_point_t{ 70ns });
+
+	// sorted by total time, longest first
+	const auto report{ registry.report() };
+	constexpr_assert(report.stopwatches.size() == 3);
+	constexpr_assert(report.total == 100ns);
+	constexpr_assert(report.stopwatches[0].name == "load");
+	constexpr_assert(report.stopwatches[0].number_of_laps == 2);
+	constexpr_assert(report.stopwatches[0].mean == 35ns);
+	constexpr_assert(report.stopwatches[1].name == "parse");
+	constexpr_assert(report.stopwatches[2].name == "idle");
+	constexpr_assert(report.stopwatches[2].total == 0ns);
+
+	std::ostringstream oss;
+	fgl::debug::output::stream = oss;
+	fgl::debug::output(report);
+	fgl::debug::output::stream = std::cout;
+	const std::string s{ oss.str() };
+	constexpr auto npos{ std::string::npos };
+	constexpr_assert(s.find("Report: 3 stopwatches, 100ns") != npos);
+	constexpr_assert(s.find("load: 70ns (70%), 2 laps, mean 35ns") != npos);
+	constexpr_assert(s.find("idle: 0ns (0%), 0 laps") != npos);
+	return true;
+}
+
+bool test_duration_formatting()
+{
+	using fgl::debug::duration_format;
+	using fgl::debug::format_duration;
+	using config = fgl::debug::output_config<stopwatch>;
+	constexpr auto npos{ std::string::npos };
+
+	std::array<char, 32> buffer;
+	char* const first{ buffer.data() };
+	char* const last{ first + buffer.size() };
+	const auto view{
+		[first](const std::to_chars_result r)
+		{ return std::string_view(first, r.ptr); }
+	};
+	const std::chrono::nanoseconds d{ 1ms + 20us + 5ns };
+	constexpr_assert(view(format_duration(first, last, d)) == "1ms 20µs 5ns");
+	constexpr_assert(view(format_duration(first, last, 0ns)) == "0ns");
+	constexpr_assert(
+		view(format_duration(first, last, d, duration_format::fixed))
+		== "1020005ns"
+	);
+	constexpr_assert(
+		view(format_duration(first, last, 3ms, duration_format::fixed))
+		== "3ms"
+	);
+	constexpr_assert(
+		format_duration(first, first + 4, d).ec == std::errc::value_too_large
+	);
+
+	// the default formatter is unchanged, including its trailing space
+	constexpr_assert(config::default_duration_formatter(d) == "1ms 20µs 5ns ");
+	// the longest durations still fit, along with the trailing space
+	const std::string longest{
+		config::default_duration_formatter(nanoseconds::min())
+	};
+	constexpr_assert(longest.size() > 1 && longest.ends_with("ns "));
+
+	const auto sw{ create_simulated_stopwatch<stopwatch>() };
+	constexpr std::array percentiles{ 99.9 };
+	const auto stats{ sw.calculate_statistics(percentiles) };
+	std::string human;
+	fgl::debug::format_statistics(std::back_inserter(human), stats);
+	constexpr_assert(human == config::default_statistics_formatter(stats));
+	constexpr_assert(human.find("\tMean lap:       ") != npos);
+	constexpr_assert(human.find("\tP99.9 lap:      ") != npos);
+	std::string fixed;
+	fgl::debug::format_statistics(
+		std::back_inserter(fixed),
+		stats,
+		duration_format::fixed
+	);
+	constexpr_assert(fixed.starts_with("laps="));
+	constexpr_assert(fixed.find(" p99.9=") != npos);
+	constexpr_assert(fixed.find('\n') == npos);
+
+	// a replaced duration formatter formats every duration of the statistics
+	config::duration_formatter =
+		[](const stopwatch::duration_t) { return std::string("<d>"); };
+	const std::string replaced{ config::default_statistics_formatter(stats) };
+	config::duration_formatter.reset();
+	constexpr_assert(replaced.find("\tMean lap:       <d>") != npos);
+	constexpr_assert(replaced.find("\tP99.9 lap:      <d>") != npos);
+	constexpr_assert(replaced.find("ns") == npos);
+
+	// matches the configurable formatters' output
+	constexpr_assert(
+		fgl::debug::to_string_full(sw, duration_format::human)
+		== fgl::debug::to_string_full(sw)
+	);
+	return true;
+}
+
 int main()
 {
 	static_assert(test_stopwatch()); // also tests stopwatch::statistics
+	static_assert(test_streaming_stopwatch());
+	static_assert(test_streaming_merge());
+	static_assert(test_vector_percentiles());
+	static_assert(test_histogram_stopwatch());
+	static_assert(test_histogram_relative_error());
+	static_assert(test_histogram_merge());
+	static_assert(test_overhead_measurement());
+	static_assert(test_overhead_subtraction());
+	static_assert(test_timeline_stopwatch());
+	static_assert(test_ring_stopwatch());
+	static_assert(test_compressed_stopwatch());
+	static_assert(test_sampled_stopwatch());
+	constexpr_assert(test_sampled_clock_reads());
+	static_assert(test_reservoir_stopwatch());
+	static_assert(test_selection_statistics());
+	constexpr_assert(test_parallel_statistics());
+	constexpr_assert(test_throughput_stopwatch());
+	constexpr_assert(test_perf_counter_statistics());
+	constexpr_assert(test_perf_stopwatch());
+	static_assert(test_baseline_encoding());
+	constexpr_assert(test_baseline_file());
+	constexpr_assert(test_calibrate_overhead());
+	constexpr_assert(test_concurrent_stopwatch());
+	constexpr_assert(test_concurrent_intervals());
+	constexpr_assert(test_interval_reporter());
+	constexpr_assert(test_stopwatch_registry());
+	constexpr_assert(test_duration_formatting());
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,143 @@
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <cstdint> // int64_t
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator> // istreambuf_iterator
+#include <ratio> // nano
+#include <string>
+#include <thread>
+
+#include <fgl/debug/trace.hpp>
+
+#ifdef NDEBUG
+	#error NDEBUG must not be defined for tests because they rely on assertions
+#endif // NDEBUG
+
+using namespace std::chrono_literals;
+
+/// A steady clock whose time only advances when the test advances it
+struct manual_clock
+{
+	using rep = std::int64_t;
+	using period = std::nano;
+	using duration = std::chrono::duration<rep, period>;
+	using time_point = std::chrono::time_point<manual_clock>;
+	static constexpr bool is_steady{ true };
+
+	static inline time_point current{};
+
+	static time_point now() noexcept
+	{ return current; }
+
+	static void advance(const duration d) noexcept
+	{ current += d; }
+};
+
+using manual_profiler = fgl::debug::generic_profiler<manual_clock>;
+using manual_zone = fgl::debug::generic_profiler_zone<manual_clock>;
+
+std::filesystem::path temporary_trace_path()
+{ return std::filesystem::temp_directory_path() / "fgl_debug_trace.json"; }
+
+std::string read_file(const std::filesystem::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	return { std::istreambuf_iterator<char>(file), {} };
+}
+
+bool contains(const std::string& s, const std::string_view what)
+{ return s.find(what) != std::string::npos; }
+
+bool test_laps()
+{
+	const auto path{ temporary_trace_path() };
+	using manual_stopwatch = fgl::debug::generic_stopwatch<
+		manual_clock,
+		fgl::debug::timeline_lap_record<manual_clock::duration>
+	>;
+	manual_stopwatch sw("laps \"quoted\"\n");
+	manual_clock::current = manual_clock::time_point(1'500ns);
+	sw.start();
+	manual_clock::advance(2'250ns);
+	sw.lap();
+	manual_clock::advance(7ns);
+	sw.stop();
+	{
+		fgl::debug::trace_writer trace(path, 64); // tiny buffer forces flushes
+		trace.write_laps(sw, 3);
+		trace.close();
+	}
+
+	const std::string s{ read_file(path) };
+	assert(s.starts_with("{\"traceEvents\":["));
+	assert(s.ends_with("\n]}\n"));
+	assert(contains(s,
+		"{\"name\":\"laps \\\"quoted\\\"\\u000a\",\"cat\":\"stopwatch\","
+		"\"ph\":\"X\",\"ts\":1.500,\"dur\":2.250,\"pid\":1,\"tid\":3}"
+	));
+	assert(contains(s, "\"ts\":3.750,\"dur\":0.007,\"pid\":1,\"tid\":3}"));
+	std::filesystem::remove(path);
+	return true;
+}
+
+bool test_zones()
+{
+	const auto path{ temporary_trace_path() };
+	manual_profiler p("test");
+	p.capture_events(true);
+	manual_clock::current = manual_clock::time_point(0ns);
+	{
+		const manual_zone outer("outer", std::source_location::current(), p);
+		manual_clock::advance(10ns);
+		{
+			const auto here{ std::source_location::current() };
+			const manual_zone inner("inner", here, p);
+			manual_clock::advance(5ns);
+		}
+	}
+	assert(p.events().size() == 2);
+
+	std::thread([]() noexcept { fgl::debug::set_trace_thread_name("worker"); })
+		.join();
+	fgl::debug::set_trace_thread_name("main");
+	{
+		fgl::debug::trace_writer trace(path);
+		trace.write_zones(p);
+		// the destructor closes the trace
+	}
+
+	const std::string s{ read_file(path) };
+	const std::string tid{ std::to_string(p.thread_id) };
+	// events are written in the order that zones are left
+	const auto inner_pos{ s.find(
+		"{\"name\":\"inner\",\"cat\":\"zone\",\"ph\":\"X\",\"ts\":0.010,"
+		"\"dur\":0.005,\"pid\":1,\"tid\":" + tid + "}"
+	) };
+	const auto outer_pos{ s.find(
+		"{\"name\":\"outer\",\"cat\":\"zone\",\"ph\":\"X\",\"ts\":0.000,"
+		"\"dur\":0.015,\"pid\":1,\"tid\":" + tid + "}"
+	) };
+	assert(inner_pos != std::string::npos);
+	assert(outer_pos != std::string::npos);
+	assert(inner_pos < outer_pos);
+	assert(contains(s,
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+		+ std::to_string(fgl::debug::trace_thread_id())
+		+ ",\"args\":{\"name\":\"main\"}}"
+	));
+	assert(contains(s, "\"args\":{\"name\":\"worker\"}}"));
+	std::filesystem::remove(path);
+
+	p.reset();
+	assert(p.events().empty());
+	return true;
+}
+
+int main()
+{
+	assert(test_laps());
+	assert(test_zones());
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include <cstdlib> // EXIT_SUCCESS, EXIT_FAILURE
+#include <cassert>
+#include <chrono>
+#include <thread>
+
+#define FGL_SHORT_MACROS
+#include <fgl/debug/stopwatch.hpp>
+
+#include <fgl/utility/sleep.hpp>
+#include <fgl/utility/tsc_clock.hpp>
+
+#ifdef NDEBUG
+	#error NDEBUG must not be defined for tests because they rely on assertions
+#endif // NDEBUG
+
+using namespace std::chrono;
+using fgl::tsc_clock;
+
+constexpr unsigned int test_iterations{ 100 };
+
+/// Must run before anything else uses the clock
+bool test_uncalibrated_now()
+{
+	const tsc_clock::time_point a{ tsc_clock::now() };
+	const tsc_clock::time_point b{ tsc_clock::now() };
+	assert(b >= a);
+	assert(b - a < seconds(1));
+	const tsc_clock::time_point c{ tsc_clock::now_unordered() };
+	assert(c.time_since_epoch() < seconds(10));
+	return true;
+}
+
+bool test_calibration()
+{
+	const tsc_clock::calibration_data& c{ tsc_clock::calibration() };
+	assert(c.uses_tsc == (
+		fgl::tsc_clock_architecture_support && tsc_clock::has_invariant_tsc()
+	));
+	assert(c.nanoseconds_per_tick > 0.0);
+	return true;
+}
+
+bool test_monotonic()
+{
+	tsc_clock::time_point previous{ tsc_clock::now() };
+	for (unsigned int i{}; i < test_iterations * 100; ++i)
+	{
+		const tsc_clock::time_point current{ tsc_clock::now() };
+		assert(current >= previous);
+		previous = current;
+	}
+	return true;
+}
+
+bool test_agrees_with_steady_clock()
+{
+	const auto steady_start{ steady_clock::now() };
+	const auto tsc_start{ tsc_clock::now() };
+	std::this_thread::sleep_for(milliseconds(50));
+	const auto tsc_end{ tsc_clock::now() };
+	const auto steady_end{ steady_clock::now() };
+
+	const auto steady_elapsed{ steady_end - steady_start };
+	const auto tsc_elapsed{ tsc_end - tsc_start };
+	// the tsc interval is nested within the steady interval
+	assert(tsc_elapsed <= steady_elapsed + microseconds(50));
+	assert(tsc_elapsed >= steady_elapsed * 99 / 100 - microseconds(50));
+	return true;
+}
+
+bool test_stopwatch_and_sleep()
+{
+	fgl::debug::generic_stopwatch<tsc_clock> sw;
+	constexpr auto target{ nanoseconds(100) };
+	for (unsigned int i{}; i < test_iterations; ++i)
+	{
+		sw.start();
+		fgl::nano_sleep<tsc_clock>(target);
+		sw.stop();
+		std::this_thread::yield();
+	}
+	const auto stats{ sw.calculate_statistics() };
+	assert(stats.number_of_laps == test_iterations);
+	assert(stats.total_elapsed >= target * test_iterations);
+	assert(stats.min >= target);
+
+	sw.reset();
+	sw.start();
+	fgl::micro_sleep<tsc_clock>(microseconds(1));
+	sw.stop();
+	assert(sw.elapsed() >= microseconds(1));
+	return true;
+}
+
+int main()
+{
+	assert(test_uncalibrated_now());
+	assert(test_calibration());
+	assert(test_monotonic());
+	assert(test_agrees_with_steady_clock());
+	assert(test_stopwatch_and_sleep());
+	return EXIT_SUCCESS;
+}